@@ -0,0 +1,260 @@
+/**
+ * @file codec.cpp
+ * @author your name (you@domain.com)
+ * @brief Decode the trace batches and benchmark the DeltaCodec
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * --trace: the batches of system/tracebatch (collected with mosquitto_sub -N) as trace CSV for host/replay
+ * --benchmark: round trip, size and throughput with the records of a history dump (or generated ones)
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude host/codec/codec.cpp src/DeltaCodec.cpp src/HistoryFormat.cpp src/ControlTrace.cpp -o codec
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ControlTrace.h"
+#include "DeltaCodec.h"
+#include "HistoryFormat.h"
+
+#define DEFAULT_RECORDS     100000  /**< Generated records, without a dump */
+#define DEFAULT_ROUNDS      20
+#define RTC_SLOW_MEMORY     8192    /**< bytes */
+
+typedef std::chrono::steady_clock Clock;
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " --trace batches.bin [--csv trace.csv]" << std::endl
+              << "       " << name << " --benchmark [--rounds n] [history.bin]" << std::endl
+              << "  collect the batches with: mosquitto_sub -N -t \"homie/device-id/system/tracebatch\" > batches.bin" << std::endl;
+}
+
+static bool readFile(const char* path, std::vector<uint8_t>& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "cannot read " << path << std::endl;
+        return false;
+    }
+    data.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return true;
+}
+
+/**
+ * @return 0 on success, 1 if a batch is broken
+ */
+static int decodeTrace(const std::vector<uint8_t>& data, std::ostream& out) {
+    out << TRACE_HEADER << std::endl;
+    size_t position = 0;
+    unsigned long batches = 0;
+    unsigned long records = 0;
+    while (position < data.size()) {
+        uint32_t length;
+        size_t used = (data[position] == TRACE_BATCH_MAGIC) ?
+                      deltaGetVarint(&data[position + 1], data.size() - position - 1, length) : 0;
+        if ((used == 0) || ((position + 1 + used + length) > data.size())) {
+            std::cerr << "broken batch at byte " << position << std::endl;
+            return 1;
+        }
+        position += 1 + used;
+        size_t end = position + length;
+        DeltaState_t state;
+        deltaReset(state);
+        while (position < end) {
+            uint32_t time;
+            int32_t values[TRACE_CHANNELS];
+            size_t read = deltaDecode(state, TRACE_CHANNELS, &data[position], end - position, time, values);
+            if (read == 0) {
+                std::cerr << "broken record at byte " << position << std::endl;
+                return 1;
+            }
+            position += read;
+            TraceRecord_t record;
+            traceFromChannels(record, time, values);
+            char line[TRACE_LINE_SIZE];
+            traceFormat(line, sizeof(line), record);
+            out << line << std::endl;
+            records++;
+        }
+        batches++;
+    }
+    std::cerr << batches << " batches, " << records << " records" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Records of a dump, ordered by the page sequence
+ */
+static void readHistory(const std::vector<uint8_t>& dump, std::vector<HistoryRecord_t>& records) {
+    std::vector<std::pair<uint32_t, size_t> > pages;
+    for (size_t offset = 0; (offset + HISTORY_PAGE_SIZE) <= dump.size(); offset += HISTORY_PAGE_SIZE) {
+        HistoryPageHeader_t header;
+        memcpy(&header, &dump[offset], sizeof(header));
+        if (historyPageIsValid(header)) {
+            pages.push_back(std::make_pair((uint32_t) header.sequence, offset));
+        }
+    }
+    std::sort(pages.begin(), pages.end());
+    for (size_t i = 0; i < pages.size(); i++) {
+        HistoryPageHeader_t header;
+        memcpy(&header, &dump[pages[i].second], sizeof(header));
+        for (int slot = 0; slot < header.count; slot++) {
+            HistoryRecord_t record;
+            memcpy(&record, &dump[pages[i].second + sizeof(header) + (slot * sizeof(record))], sizeof(record));
+            if (historyIsValid(record)) {
+                records.push_back(record);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Wakes every 5 minutes with slowly drifting, noisy ADC values
+ */
+static void generateHistory(size_t count, std::vector<HistoryRecord_t>& records) {
+    srand(1);
+    HistoryRecord_t record;
+    historyClear(record);
+    int moisture[MAX_PLANTS];
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        moisture[i] = 1500 + (i * 200);
+    }
+    for (size_t n = 0; n < count; n++) {
+        record.time = 1790000000UL + (n * 300) + ((rand() % 8) == 0 ? 1 : 0);
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            moisture[i] += (rand() % 3) - 1;
+            record.moisture[i] = moisture[i] + (rand() % 5) - 2;
+        }
+        record.temperature[0] = 1800 + ((n % 288) * 2) + (rand() % 3);
+        record.temperature[1] = ((n % 12) == 0) ? (2000 + (rand() % 50)) : HISTORY_TEMP_UNKNOWN;
+        record.water = 400 + (n / 1000);
+        record.lipo = 3500 - ((n % 288) / 4);
+        record.solar = ((n % 288) < 144) ? (1000 + (n % 144) * 10) : 0;
+        record.pumps = ((n % 97) == 0) ? 1 : 0;
+        record.wake = ((n % 12) == 0) ? HISTORY_WAKE_HOMIE : HISTORY_WAKE_FASTPATH;
+        record.awake = ((n % 12) == 0) ? 53 : 18;
+        historySeal(record);
+        records.push_back(record);
+    }
+}
+
+static int benchmark(const std::vector<HistoryRecord_t>& records, int rounds) {
+    if (records.empty()) {
+        std::cerr << "no records" << std::endl;
+        return 2;
+    }
+    std::vector<uint8_t> encoded(records.size() * DELTA_MAX_RECORD(HISTORY_CHANNELS));
+    size_t used = 0;
+    Clock::time_point start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        DeltaState_t state;
+        deltaReset(state);
+        used = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            int32_t values[HISTORY_CHANNELS];
+            historyToChannels(records[i], values);
+            used += deltaEncode(state, HISTORY_CHANNELS, records[i].time, values, &encoded[used], encoded.size() - used);
+        }
+    }
+    double encodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    std::vector<HistoryRecord_t> decoded(records.size());
+    start = Clock::now();
+    for (int round = 0; round < rounds; round++) {
+        DeltaState_t state;
+        deltaReset(state);
+        size_t position = 0;
+        for (size_t i = 0; i < records.size(); i++) {
+            uint32_t time;
+            int32_t values[HISTORY_CHANNELS];
+            position += deltaDecode(state, HISTORY_CHANNELS, &encoded[position], used - position, time, values);
+            historyFromChannels(decoded[i], time, values);
+        }
+    }
+    double decodeSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    size_t mismatches = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (memcmp(&records[i], &decoded[i], sizeof(HistoryRecord_t)) != 0) {
+            mismatches++;
+        }
+    }
+
+    size_t raw = records.size() * sizeof(HistoryRecord_t);
+    double perRecord = (double) used / records.size();
+    double total = (double) records.size() * rounds;
+    std::cout << "records        " << records.size() << std::endl
+              << "raw            " << raw << " bytes (" << sizeof(HistoryRecord_t) << " per record)" << std::endl
+              << "encoded        " << used << " bytes (" << perRecord << " per record, ratio " << ((double) raw / used) << ")" << std::endl
+              << "8 KB RTC       " << (RTC_SLOW_MEMORY / sizeof(HistoryRecord_t)) << " raw, "
+              << (size_t) (RTC_SLOW_MEMORY / perRecord) << " encoded records" << std::endl
+              << "encode         " << (total / encodeSeconds / 1e6) << " M records/s" << std::endl
+              << "decode         " << (total / decodeSeconds / 1e6) << " M records/s" << std::endl
+              << "round trip     " << (mismatches == 0 ? "ok" : "FAILED") << std::endl;
+    return (mismatches == 0) ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    const char* tracePath = NULL;
+    const char* csvPath = NULL;
+    const char* historyPath = NULL;
+    bool runBenchmark = false;
+    int rounds = DEFAULT_ROUNDS;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "--trace") && hasValue) {
+            tracePath = argv[++i];
+        } else if ((argument == "--csv") && hasValue) {
+            csvPath = argv[++i];
+        } else if (argument == "--benchmark") {
+            runBenchmark = true;
+        } else if ((argument == "--rounds") && hasValue) {
+            rounds = atoi(argv[++i]);
+        } else if (runBenchmark && (argument[0] != '-') && (historyPath == NULL)) {
+            historyPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    if (tracePath != NULL) {
+        std::vector<uint8_t> data;
+        if (!readFile(tracePath, data)) {
+            return 2;
+        }
+        if (csvPath != NULL) {
+            std::ofstream csv(csvPath);
+            if (!csv) {
+                std::cerr << "cannot write " << csvPath << std::endl;
+                return 2;
+            }
+            return decodeTrace(data, csv);
+        }
+        return decodeTrace(data, std::cout);
+    }
+    if (runBenchmark && (rounds > 0)) {
+        std::vector<HistoryRecord_t> records;
+        if (historyPath != NULL) {
+            std::vector<uint8_t> dump;
+            if (!readFile(historyPath, dump)) {
+                return 2;
+            }
+            readHistory(dump, records);
+        } else {
+            generateHistory(DEFAULT_RECORDS, records);
+        }
+        return benchmark(records, rounds);
+    }
+    usage(argv[0]);
+    return 2;
+}
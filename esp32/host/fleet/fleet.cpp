@@ -0,0 +1,1016 @@
+/**
+ * @file fleet.cpp
+ * @author your name (you@domain.com)
+ * @brief MQTT load of a fleet of simulated controllers against a broker
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Every device runs the wake sequence of the simulator (SimController with ControlLogic.cpp)
+ * against its own greenhouse; all of them share one virtual clock. A wake with WiFi opens
+ * an MQTT session with the Homie device id, like the firmware: mode2 publishes the Homie
+ * attributes ($state, $fw, nodes and properties) and the values, the fast path only the values.
+ * A monitor subscribes to the base topic and measures the delivery through the broker.
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude -Ihost/sim host/fleet/fleet.cpp host/sim/Environment.cpp \
+ *      host/sim/SimController.cpp host/sim/HostSettings.cpp src/ControlLogic.cpp src/TelemetryMemory.cpp \
+ *      src/MoistureCalibration.cpp -o fleet
+ */
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Environment.h"
+#include "HostSettings.h"
+#include "SimController.h"
+#include "Simulation.h"
+
+#define DEFAULT_DEVICES     200
+#define DEFAULT_PORT        1883
+#define DEFAULT_DURATION    300     /**< s (real time), new wakes are started */
+#define DEFAULT_INTERVAL    10      /**< s between two reports */
+#define DEFAULT_START_HOUR  8       /**< Virtual time of day at the start */
+#define SESSION_TIMEOUT     10      /**< s (real time), a session without progress is dropped */
+#define DRAIN_TIME          2       /**< s, the monitor waits for the last deliveries */
+#define KEEP_ALIVE          15      /**< s, the Homie default */
+#define RECEIVE_SIZE        4096
+
+#define MQTT_CONNECT        0x10
+#define MQTT_CONNACK        0x20
+#define MQTT_PUBLISH        0x30
+#define MQTT_PUBACK         0x40
+#define MQTT_SUBSCRIBE      0x82
+#define MQTT_SUBACK         0x90
+#define MQTT_DISCONNECT     0xE0
+#define MQTT_QOS1           0x02
+#define MQTT_RETAIN         0x01
+
+typedef std::chrono::steady_clock Clock;
+
+/**
+ * @brief Nodes of HomieConfiguration.h, in the order of $nodes
+ */
+typedef struct NodeAdvert_t {
+    const char* id;
+    const char* name;
+    const char* type;
+} NodeAdvert_t;
+
+static const NodeAdvert_t NODES[] = {
+    { "plant0", "Plant 0", "Plant" }, { "plant1", "Plant 1", "Plant" }, { "plant2", "Plant 2", "Plant" },
+    { "plant3", "Plant 3", "Plant" }, { "plant4", "Plant 4", "Plant" }, { "plant5", "Plant 5", "Plant" },
+    { "plant6", "Plant 6", "Plant" }, { "lipo", "Battery Status", "Lipo" }, { "solar", "Solar Status", "Solarpanel" },
+    { "water", "WaterSensor", "Water" }, { "temperature", "Temperature", "temperature" },
+    { "stay", "alive", "alive" }, { "system", "System", "Statistics" }
+};
+
+/**
+ * @brief Properties, as advertised in systemInit() of main.cpp
+ */
+typedef struct PropertyAdvert_t {
+    const char* node;
+    const char* id;
+    const char* name;       /**< NULL, if not set */
+    const char* datatype;
+    const char* unit;       /**< NULL, if not set */
+    bool settable;
+} PropertyAdvert_t;
+
+static const PropertyAdvert_t PROPERTIES[] = {
+    { "plant0", "moist", "Percent", "number", "%", false },
+    { "plant1", "switch", "Pump 1", "boolean", NULL, true },
+    { "plant1", "moist", "Percent", "number", "%", false },
+    { "plant2", "switch", "Pump 2", "boolean", NULL, true },
+    { "plant2", "moist", "Percent", "number", "%", false },
+    { "plant3", "switch", "Pump 3", "boolean", NULL, true },
+    { "plant3", "moist", "Percent", "number", "%", false },
+    { "plant4", "moist", "Percent", "number", "%", false },
+    { "plant5", "moist", "Percent", "number", "%", false },
+    { "plant6", "moist", "Percent", "number", "%", false },
+    { "temperature", "control", "Temperature", "number", "°C", false },
+    { "temperature", "temp", "Temperature", "number", "°C", false },
+    { "lipo", "percent", "Percent", "number", "%", false },
+    { "lipo", "volt", "Volt", "number", "V", false },
+    { "solar", "percent", "Percent", "number", "%", false },
+    { "solar", "volt", "Volt", "number", "V", false },
+    { "water", "remaining", NULL, "number", "%", false },
+    { "water", "volume", "Estimated water", "integer", "ml", false },
+    { "water", "warning", "Below waterlevelwarn", "boolean", NULL, false },
+    { "system", "latencyhomie", "Wake to publish (Homie)", "integer", "ms", false },
+    { "system", "latencyfast", "Wake to publish (fast path)", "integer", "ms", false },
+    { "stay", "alive", "Alive", "number", NULL, true },
+    { "stay", "calibrate", "Capture moisture calibration", "string", NULL, true },
+    { "system", "minheap", "Minimum free heap", "integer", "B", false },
+    { "system", "maxblock", "Largest free block", "integer", "B", false },
+    { "system", "stackloop", "Unused stack loopTask", "integer", "B", false },
+    { "system", "stackwifi", "Unused stack WiFi", "integer", "B", false },
+    { "system", "stackmqtt", "Unused stack MQTT", "integer", "B", false },
+    { "system", "rtcused", "Used RTC memory", "integer", "B", false },
+    { "system", "settle0", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle1", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle2", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle3", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle4", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle5", "Sensor settle time", "integer", "ms", false },
+    { "system", "settle6", "Sensor settle time", "integer", "ms", false },
+    { "system", "settletemp", "Sensor settle time", "integer", "ms", false },
+    { "system", "overrunsense", "Deadline overruns", "integer", NULL, false },
+    { "system", "overrunwifi", "Deadline overruns", "integer", NULL, false },
+    { "system", "overrunmqtt", "Deadline overruns", "integer", NULL, false },
+    { "system", "overrunpublish", "Deadline overruns", "integer", NULL, false },
+    { "system", "overrunwater", "Deadline overruns", "integer", NULL, false }
+};
+
+#define NODE_COUNT      (sizeof(NODES) / sizeof(NODES[0]))
+#define PROPERTY_COUNT  (sizeof(PROPERTIES) / sizeof(PROPERTIES[0]))
+
+typedef struct Message_t {
+    std::string topic;      /**< below <base topic><device id>/ */
+    std::string payload;
+    bool retained;
+} Message_t;
+
+typedef enum SessionPhase_t {
+    SESSION_IDLE = 0,       /**< sleeping, no connection */
+    SESSION_CONNECTING,     /**< waiting for CONNACK */
+    SESSION_PUBLISHING,     /**< waiting for the PUBACKs of the wake */
+    SESSION_AWAKE,          /**< everything acknowledged, the controller is still awake (pump) */
+    SESSION_CLOSING         /**< waiting for the PUBACKs of the last messages */
+} SessionPhase_t;
+
+struct Device {
+    std::string id;
+    EnvironmentConfig_t config;
+    Environment environment;
+    SimController controller;
+    double nextWake;                        /**< s, virtual */
+    WakeReport_t report;
+    SessionPhase_t phase = SESSION_IDLE;
+    int fd = -1;
+    std::string received;
+    std::map<uint16_t, double> unacked;     /**< packet id to send time (s, real) */
+    uint16_t packetId = 0;
+    double started = 0;                     /**< s, real */
+    double progress = 0;                    /**< s, real, last packet of the broker */
+    double awakeUntil = 0;                  /**< s, real */
+
+    Device(const std::string& deviceId, const EnvironmentConfig_t& environmentConfig, unsigned int seed,
+           const HostSettings_t& settings, const PowerProfile_t& profile)
+        : id(deviceId), config(environmentConfig), environment(environmentConfig, seed), controller(settings, profile) {
+        nextWake = 0;
+        memset(&report, 0, sizeof(report));
+    }
+};
+
+/**
+ * @brief Latency samples (ms) of the whole run and of the current report interval
+ */
+struct Latency {
+    std::vector<double> all;
+    std::vector<double> interval;
+
+    void add(double milliseconds) {
+        all.push_back(milliseconds);
+        interval.push_back(milliseconds);
+    }
+};
+
+typedef struct FleetOptions_t {
+    std::string host;
+    int port;
+    std::string baseTopic;
+    std::string prefix;
+    int devices;
+    double speed;           /**< virtual seconds per real second */
+    double duration;        /**< s, real */
+    double startHour;
+    double interval;        /**< s, real */
+    unsigned int seed;
+} FleetOptions_t;
+
+static Clock::time_point gStart;
+
+static double realNow(void) {
+    return std::chrono::duration<double>(Clock::now() - gStart).count();
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--host host] [--port n] [--devices n] [--speed factor] [--duration s]" << std::endl
+              << "       [--interval s] [--start-hour h] [--base homie/] [--prefix plantctrl-] [--seed n]" << std::endl
+              << "       [-c config.json] [-p profile.json]" << std::endl;
+}
+
+/**
+ ******************************* MQTT 3.1.1 packets ******************************
+ */
+
+static void putLength(std::string& packet, size_t length) {
+    do {
+        uint8_t byte = length % 128;
+        length /= 128;
+        packet.push_back((char) ((length > 0) ? (byte | 0x80) : byte));
+    } while (length > 0);
+}
+
+static void putShort(std::string& body, uint16_t value) {
+    body.push_back((char) (value >> 8));
+    body.push_back((char) (value & 0xFF));
+}
+
+static void putString(std::string& body, const std::string& text) {
+    putShort(body, (uint16_t) text.size());
+    body += text;
+}
+
+static std::string mqttPacket(uint8_t header, const std::string& body) {
+    std::string packet(1, (char) header);
+    putLength(packet, body.size());
+    return packet + body;
+}
+
+/**
+ * @param willTopic  empty for a connection without will (fast path)
+ */
+static std::string mqttConnect(const std::string& clientId, uint16_t keepAlive,
+                               const std::string& willTopic, const std::string& willPayload) {
+    std::string body;
+    putString(body, "MQTT");
+    body.push_back(4);                      /* protocol level 3.1.1 */
+    uint8_t flags = 0x02;                   /* clean session */
+    if (!willTopic.empty()) {
+        flags |= 0x04 | (1 << 3) | 0x20;    /* will, QoS 1, retained */
+    }
+    body.push_back((char) flags);
+    putShort(body, keepAlive);
+    putString(body, clientId);
+    if (!willTopic.empty()) {
+        putString(body, willTopic);
+        putString(body, willPayload);
+    }
+    return mqttPacket(MQTT_CONNECT, body);
+}
+
+static std::string mqttPublish(const std::string& topic, const std::string& payload, bool retained, uint16_t packetId) {
+    std::string body;
+    putString(body, topic);
+    putShort(body, packetId);
+    body += payload;
+    return mqttPacket(MQTT_PUBLISH | MQTT_QOS1 | (retained ? MQTT_RETAIN : 0), body);
+}
+
+static std::string mqttSubscribe(uint16_t packetId, const std::string& filter) {
+    std::string body;
+    putShort(body, packetId);
+    putString(body, filter);
+    body.push_back(0);                      /* QoS 0 */
+    return mqttPacket(MQTT_SUBSCRIBE, body);
+}
+
+/**
+ * @brief Take the next complete packet from the receive buffer
+ * @return false, if the packet is not complete yet
+ */
+static bool mqttNext(std::string& buffer, uint8_t& header, std::string& body) {
+    size_t length = 0;
+    size_t used = 1;
+    for (int shift = 0; ; shift += 7) {
+        if ((used >= buffer.size()) || (shift > 21)) {
+            return false;
+        }
+        uint8_t byte = (uint8_t) buffer[used++];
+        length |= (size_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if ((used + length) > buffer.size()) {
+        return false;
+    }
+    header = (uint8_t) buffer[0];
+    body = buffer.substr(used, length);
+    buffer.erase(0, used + length);
+    return true;
+}
+
+static int openSocket(const sockaddr_in& address) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (connect(fd, (const sockaddr*) &address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+/**
+ * @return false, if the connection is closed
+ */
+static bool receive(int fd, std::string& buffer) {
+    char data[RECEIVE_SIZE];
+    ssize_t length = recv(fd, data, sizeof(data), 0);
+    if (length <= 0) {
+        return false;
+    }
+    buffer.append(data, length);
+    return true;
+}
+
+static double percentile(std::vector<double> samples, double fraction) {
+    if (samples.empty()) {
+        return 0;
+    }
+    std::sort(samples.begin(), samples.end());
+    size_t index = (size_t) ceil(fraction * samples.size());
+    return samples[(index > 0) ? (index - 1) : 0];
+}
+
+static std::string fixed(double value, int decimals) {
+    char text[32];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return text;
+}
+
+/**
+ ******************************* Fleet ******************************
+ */
+
+class Fleet {
+    private:
+        FleetOptions_t mOptions;
+        HostSettings_t mSettings;
+        PowerProfile_t mProfile;
+        sockaddr_in mAddress;
+        std::vector<Device*> mDevices;
+        std::mt19937 mRandom;
+
+        int mMonitor = -1;
+        std::string mMonitorReceived;
+        std::map<std::string, std::deque<double> > mExpected;  /**< full topic to send times (s, real) */
+
+        /* statistics */
+        unsigned long mWakes[WAKE_HOMIE + 1] = { 0 };
+        unsigned long mPumpRuns = 0;
+        unsigned long mSessions = 0;
+        unsigned long mFailed = 0;
+        unsigned long mTimeouts = 0;
+        unsigned long mPublished = 0;
+        unsigned long mPublishedInterval = 0;
+        unsigned long mDelivered = 0;
+        unsigned long mDeliveredInterval = 0;
+        unsigned long mForeign = 0;
+        unsigned long mWakesInterval = 0;
+        unsigned long long mBytes = 0;
+        int mActive = 0;
+        int mPeakActive = 0;
+        double mMaxLag = 0;                 /**< s (real), a wake started after its time */
+        Latency mConnack;
+        Latency mPuback;
+        Latency mDelivery;
+        Latency mSession;
+
+        std::string topic(const Device& device, const std::string& suffix) {
+            return mOptions.baseTopic + device.id + "/" + suffix;
+        }
+
+        void homieAttributes(Device& device, std::vector<Message_t>& messages);
+        void values(Device& device, double connackMs, std::vector<Message_t>& messages);
+        void startWake(Device& device, double now);
+        void send(Device& device, const std::vector<Message_t>& messages, double now);
+        void handle(Device& device, uint8_t header, const std::string& body, double now);
+        void finish(Device& device, double now);
+        void closeSession(Device& device, bool completed, double now);
+        void monitorPacket(uint8_t header, const std::string& body, double now);
+
+    public:
+        Fleet(const FleetOptions_t& options, const HostSettings_t& settings, const PowerProfile_t& profile);
+        ~Fleet();
+
+        bool connectMonitor(void);
+        void run(void);
+        void report(double now, bool header);
+        void summary(void);
+};
+
+Fleet::Fleet(const FleetOptions_t& options, const HostSettings_t& settings, const PowerProfile_t& profile)
+    : mOptions(options), mSettings(settings), mProfile(profile), mRandom(options.seed) {
+    memset(&mAddress, 0, sizeof(mAddress));
+    std::uniform_real_distribution<double> spread(0.7, 1.3);
+    std::uniform_real_distribution<double> fraction(0, 1);
+    double start = mOptions.startHour * 3600;
+    for (int i = 0; i < mOptions.devices; i++) {
+        char id[64];
+        snprintf(id, sizeof(id), "%s%03d", mOptions.prefix.c_str(), i);
+        /* each greenhouse dries a bit differently, so the pump wakes are not in sync */
+        EnvironmentConfig_t config;
+        environmentDefaults(config);
+        config.evaporation *= spread(mRandom);
+        config.initialMoisture = 0.4 + 0.5 * fraction(mRandom);
+        config.initialCharge = 0.5 + 0.5 * fraction(mRandom);
+        Device* device = new Device(id, config, mOptions.seed + i, mSettings, mProfile);
+        /* the devices were powered on at different times, so their wakes are spread over one sleep */
+        double until = start + fraction(mRandom) * mSettings.deepSleep / 1000.0;
+        while (device->environment.getTime() < until) {
+            double step = until - device->environment.getTime();
+            device->environment.advance((step > SIM_STEP) ? SIM_STEP : step);
+        }
+        device->nextWake = until;
+        mDevices.push_back(device);
+    }
+}
+
+Fleet::~Fleet() {
+    for (size_t i = 0; i < mDevices.size(); i++) {
+        if (mDevices[i]->fd >= 0) {
+            close(mDevices[i]->fd);
+        }
+        delete mDevices[i];
+    }
+    if (mMonitor >= 0) {
+        close(mMonitor);
+    }
+}
+
+/**
+ * @brief Attributes of the Homie bootstrap, between $state init and ready
+ */
+void Fleet::homieAttributes(Device& device, std::vector<Message_t>& messages) {
+    char address[32];
+    unsigned int number = (unsigned int) strtoul(device.id.c_str() + mOptions.prefix.size(), NULL, 10);
+    snprintf(address, sizeof(address), "10.0.%u.%u", (number / 250) % 256, (number % 250) + 2);
+    char mac[32];
+    snprintf(mac, sizeof(mac), "24:0A:C4:00:%02X:%02X", (number >> 8) & 0xFF, number & 0xFF);
+
+    std::string nodes;
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        nodes += (i > 0) ? "," : "";
+        nodes += NODES[i].id;
+    }
+    messages.push_back({ "$state", "init", true });
+    messages.push_back({ "$homie", "3.0.1", true });
+    messages.push_back({ "$name", device.id, true });
+    messages.push_back({ "$localip", address, true });
+    messages.push_back({ "$mac", mac, true });
+    messages.push_back({ "$fw/name", "PlantControl", true });
+    messages.push_back({ "$fw/version", FIRMWARE_VERSION, true });
+    messages.push_back({ "$nodes", nodes, true });
+    messages.push_back({ "$implementation", "esp32", true });
+    messages.push_back({ "$stats/interval", "0", true });
+    for (size_t i = 0; i < NODE_COUNT; i++) {
+        std::string node = NODES[i].id;
+        std::string properties;
+        for (size_t j = 0; j < PROPERTY_COUNT; j++) {
+            const PropertyAdvert_t& property = PROPERTIES[j];
+            if (node != property.node) {
+                continue;
+            }
+            properties += properties.empty() ? "" : ",";
+            properties += property.id;
+            std::string prefix = node + "/" + property.id + "/";
+            if (property.name != NULL) {
+                messages.push_back({ prefix + "$name", property.name, true });
+            }
+            messages.push_back({ prefix + "$datatype", property.datatype, true });
+            if (property.unit != NULL) {
+                messages.push_back({ prefix + "$unit", property.unit, true });
+            }
+            if (property.settable) {
+                messages.push_back({ prefix + "$settable", "true", true });
+            }
+        }
+        messages.push_back({ node + "/$name", NODES[i].name, true });
+        messages.push_back({ node + "/$type", NODES[i].type, true });
+        messages.push_back({ node + "/$properties", properties, true });
+    }
+    messages.push_back({ "$stats/uptime", fixed(mProfile.mode1Time / 1000.0, 0), true });
+    messages.push_back({ "$stats/signal", fixed(40 + (number % 50), 0), true });
+    messages.push_back({ "$state", "ready", true });
+}
+
+/**
+ * @brief Values of publishSensorValues(), publishMemoryStats() and the started pump
+ * All of them are sent; the deadbands of the firmware only make the traffic smaller.
+ */
+void Fleet::values(Device& device, double connackMs, std::vector<Message_t>& messages) {
+    Environment& environment = device.environment;
+    const EnvironmentConfig_t& config = device.config;
+    bool homie = (device.report.type == WAKE_HOMIE);
+    std::uniform_int_distribution<int> jitter(0, 40);
+
+    messages.push_back({ homie ? "system/latencyhomie" : "system/latencyfast",
+                         fixed(mProfile.mode1Time + connackMs + (homie ? mProfile.homieTime / 2 : 0), 0), true });
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        double percent = 100.0 * (environment.readMoisture(i) - config.adcDry) / (config.adcWet - config.adcDry);
+        percent = (percent < 0) ? 0 : ((percent > 100) ? 100 : percent);
+        messages.push_back({ std::string("plant") + (char) ('0' + i) + "/moist", fixed(percent, 0), true });
+    }
+    double temperature = environment.getTemperature();
+    messages.push_back({ "temperature/temp", fixed(temperature, 2), true });
+    messages.push_back({ "temperature/control", fixed(temperature + 3, 2), true });
+
+    double distance = environment.getWaterDistance();
+    double tank = environment.getTank();
+    messages.push_back({ "water/remaining", fixed(1000 - distance, 0), true });
+    messages.push_back({ "water/volume", fixed(tank, 0), true });
+    messages.push_back({ "water/warning", (tank < config.tankVolume / 4) ? "true" : "false", true });
+
+    int lipo = environment.readLipo();
+    int solar = environment.readSolar();
+    messages.push_back({ "lipo/percent", fixed((100 * lipo) / 4095, 0), true });
+    messages.push_back({ "lipo/volt", fixed(ADC_5V_TO_3V3(lipo), 2), true });
+    messages.push_back({ "solar/percent", fixed((100 * solar) / 4095, 0), true });
+    messages.push_back({ "solar/volt", fixed(SOLAR_VOLT(solar), 2), true });
+
+    static const char* const SETTLE[] = { "settle0", "settle1", "settle2", "settle3", "settle4", "settle5", "settle6", "settletemp" };
+    for (size_t i = 0; i < sizeof(SETTLE) / sizeof(SETTLE[0]); i++) {
+        messages.push_back({ std::string("system/") + SETTLE[i], fixed(60 + jitter(mRandom), 0), true });
+    }
+    messages.push_back({ "system/minheap", fixed(180000 + 100 * jitter(mRandom), 0), true });
+    messages.push_back({ "system/maxblock", fixed(110000, 0), true });
+    messages.push_back({ "system/stackloop", fixed(4800 + jitter(mRandom), 0), true });
+    messages.push_back({ "system/stackwifi", fixed(1900 + jitter(mRandom), 0), true });
+    messages.push_back({ "system/stackmqtt", fixed(2600 + jitter(mRandom), 0), true });
+    messages.push_back({ "system/rtcused", "3916", true });
+
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        if (device.report.pumps & (1UL << i)) {
+            messages.push_back({ std::string("plant") + (char) ('0' + i) + "/switch", "ON", true });
+        }
+    }
+}
+
+void Fleet::send(Device& device, const std::vector<Message_t>& messages, double now) {
+    std::string data;
+    for (size_t i = 0; i < messages.size(); i++) {
+        if (++device.packetId == 0) {
+            device.packetId = 1;
+        }
+        std::string fullTopic = topic(device, messages[i].topic);
+        data += mqttPublish(fullTopic, messages[i].payload, messages[i].retained, device.packetId);
+        device.unacked[device.packetId] = now;
+        mExpected[fullTopic].push_back(now);
+    }
+    mPublished += messages.size();
+    mPublishedInterval += messages.size();
+    mBytes += data.size();
+    if (!sendAll(device.fd, data)) {
+        mFailed++;
+        closeSession(device, false, now);
+    }
+}
+
+/**
+ * @brief Run the control logic of one wake and connect, if the wake uses WiFi
+ * The sleep is applied right away, so the time of the next wake is known.
+ */
+void Fleet::startWake(Device& device, double now) {
+    double virtualNow = mOptions.startHour * 3600 + now * mOptions.speed;
+    double lag = (virtualNow - device.nextWake) / mOptions.speed;
+    mMaxLag = (lag > mMaxLag) ? lag : mMaxLag;
+
+    device.report = device.controller.wake(device.environment);
+    mWakes[device.report.type]++;
+    mWakesInterval++;
+    mPumpRuns += __builtin_popcount(device.report.pumps);
+    long sleep = (device.report.sleep < SIM_MIN_SLEEP) ? SIM_MIN_SLEEP : device.report.sleep;
+    device.controller.sleep(device.environment, sleep);
+    double remaining = (device.report.awake + sleep) / 1000.0;
+    device.nextWake += remaining;
+
+    if (device.report.type != WAKE_NOP) {
+        device.fd = openSocket(mAddress);
+        if (device.fd < 0) {
+            mFailed++;
+        } else {
+            bool homie = (device.report.type == WAKE_HOMIE);
+            /* the fast path connects without a will, like MqttFastPath */
+            std::string connect = mqttConnect(device.id, KEEP_ALIVE, homie ? topic(device, "$state") : "", "lost");
+            device.phase = SESSION_CONNECTING;
+            device.started = now;
+            device.progress = now;
+            device.awakeUntil = now + (device.report.awake / 1000.0) / mOptions.speed;
+            device.received.clear();
+            device.unacked.clear();
+            mActive++;
+            mPeakActive = (mActive > mPeakActive) ? mActive : mPeakActive;
+            mBytes += connect.size();
+            if (!sendAll(device.fd, connect)) {
+                mFailed++;
+                closeSession(device, false, now);
+            }
+        }
+    }
+
+    /* the environment keeps running, while the controller sleeps */
+    while (remaining > 0) {
+        double step = (remaining > SIM_STEP) ? SIM_STEP : remaining;
+        device.environment.advance(step);
+        remaining -= step;
+    }
+}
+
+void Fleet::handle(Device& device, uint8_t header, const std::string& body, double now) {
+    device.progress = now;
+    switch (header & 0xF0) {
+        case MQTT_CONNACK: {
+            if ((device.phase != SESSION_CONNECTING) || (body.size() < 2) || (body[1] != 0)) {
+                mFailed++;
+                closeSession(device, false, now);
+                return;
+            }
+            double connackMs = (now - device.started) * 1000;
+            mConnack.add(connackMs);
+            std::vector<Message_t> messages;
+            if (device.report.type == WAKE_HOMIE) {
+                homieAttributes(device, messages);
+            }
+            values(device, connackMs, messages);
+            device.phase = SESSION_PUBLISHING;
+            send(device, messages, now);
+            break;
+        }
+        case MQTT_PUBACK: {
+            if (body.size() < 2) {
+                return;
+            }
+            uint16_t packetId = ((uint8_t) body[0] << 8) | (uint8_t) body[1];
+            std::map<uint16_t, double>::iterator sent = device.unacked.find(packetId);
+            if (sent != device.unacked.end()) {
+                mPuback.add((now - sent->second) * 1000);
+                device.unacked.erase(sent);
+            }
+            if (device.unacked.empty()) {
+                if (device.phase == SESSION_PUBLISHING) {
+                    device.phase = SESSION_AWAKE;
+                } else if (device.phase == SESSION_CLOSING) {
+                    closeSession(device, true, now);
+                }
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief The awake time is over: switch the pumps off, Homie reports sleeping
+ */
+void Fleet::finish(Device& device, double now) {
+    std::vector<Message_t> messages;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        if (device.report.pumps & (1UL << i)) {
+            messages.push_back({ std::string("plant") + (char) ('0' + i) + "/switch", "OFF", true });
+        }
+    }
+    if (device.report.type == WAKE_HOMIE) {
+        messages.push_back({ "$state", "sleeping", true });
+    }
+    if (messages.empty()) {
+        closeSession(device, true, now);
+        return;
+    }
+    device.phase = SESSION_CLOSING;
+    send(device, messages, now);
+}
+
+void Fleet::closeSession(Device& device, bool completed, double now) {
+    if (device.fd < 0) {
+        return;
+    }
+    if (completed) {
+        std::string disconnect = mqttPacket(MQTT_DISCONNECT, "");
+        sendAll(device.fd, disconnect);
+        mBytes += disconnect.size();
+        mSessions++;
+        mSession.add((now - device.started) * 1000);
+    }
+    close(device.fd);
+    device.fd = -1;
+    device.phase = SESSION_IDLE;
+    mActive--;
+}
+
+bool Fleet::connectMonitor(void) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* result = NULL;
+    if ((getaddrinfo(mOptions.host.c_str(), NULL, &hints, &result) != 0) || (result == NULL)) {
+        std::cerr << "cannot resolve " << mOptions.host << std::endl;
+        return false;
+    }
+    mAddress = *(const sockaddr_in*) result->ai_addr;
+    mAddress.sin_port = htons(mOptions.port);
+    freeaddrinfo(result);
+
+    mMonitor = openSocket(mAddress);
+    if (mMonitor < 0) {
+        std::cerr << "cannot connect to " << mOptions.host << ":" << mOptions.port << std::endl;
+        return false;
+    }
+    char clientId[32];
+    snprintf(clientId, sizeof(clientId), "fleet-monitor-%d", (int) getpid());
+    if (!sendAll(mMonitor, mqttConnect(clientId, 0, "", "")) ||
+        !sendAll(mMonitor, mqttSubscribe(1, mOptions.baseTopic + "#"))) {
+        return false;
+    }
+    /* wait for the SUBACK, so no message of the devices is missed */
+    double deadline = realNow() + SESSION_TIMEOUT;
+    while (realNow() < deadline) {
+        pollfd entry = { mMonitor, POLLIN, 0 };
+        if ((poll(&entry, 1, 100) > 0) && !receive(mMonitor, mMonitorReceived)) {
+            break;
+        }
+        uint8_t header;
+        std::string body;
+        while (mqttNext(mMonitorReceived, header, body)) {
+            if ((header == MQTT_CONNACK) && ((body.size() < 2) || (body[1] != 0))) {
+                std::cerr << "broker refused the monitor (" << (body.size() < 2 ? -1 : (int) body[1]) << ")" << std::endl;
+                return false;
+            }
+            if (header == MQTT_SUBACK) {
+                return true;
+            }
+        }
+    }
+    std::cerr << "no SUBACK from the broker" << std::endl;
+    return false;
+}
+
+void Fleet::monitorPacket(uint8_t header, const std::string& body, double now) {
+    if (((header & 0xF0) != MQTT_PUBLISH) || (body.size() < 2)) {
+        return;
+    }
+    if (header & MQTT_RETAIN) {
+        /* stored by the broker before the subscription */
+        return;
+    }
+    size_t length = ((uint8_t) body[0] << 8) | (uint8_t) body[1];
+    std::map<std::string, std::deque<double> >::iterator expected = mExpected.find(body.substr(2, length));
+    if ((expected == mExpected.end()) || expected->second.empty()) {
+        mForeign++;
+        return;
+    }
+    mDelivery.add((now - expected->second.front()) * 1000);
+    expected->second.pop_front();
+    mDelivered++;
+    mDeliveredInterval++;
+}
+
+void Fleet::report(double now, bool header) {
+    static double last = 0;
+    if (header) {
+        printf("%8s %8s %6s %8s %8s %8s %16s %16s\n", "real s", "virt h", "active", "wakes/s", "sent/s", "recv/s",
+               "puback p50/p99", "deliver p50/p99");
+        last = 0;
+        return;
+    }
+    double seconds = now - last;
+    if (seconds <= 0) {
+        return;
+    }
+    char puback[32];
+    char delivery[32];
+    snprintf(puback, sizeof(puback), "%.1f/%.1f", percentile(mPuback.interval, 0.5), percentile(mPuback.interval, 0.99));
+    snprintf(delivery, sizeof(delivery), "%.1f/%.1f", percentile(mDelivery.interval, 0.5), percentile(mDelivery.interval, 0.99));
+    printf("%8.0f %8.2f %6d %8.1f %8.1f %8.1f %16s %16s\n", now, mOptions.startHour + (now * mOptions.speed) / 3600,
+           mActive, mWakesInterval / seconds, mPublishedInterval / seconds, mDeliveredInterval / seconds, puback, delivery);
+    fflush(stdout);
+    mWakesInterval = 0;
+    mPublishedInterval = 0;
+    mDeliveredInterval = 0;
+    mPuback.interval.clear();
+    mDelivery.interval.clear();
+    last = now;
+}
+
+void Fleet::run(void) {
+    report(0, true);
+    double nextReport = mOptions.interval;
+    double drainUntil = -1;
+    std::vector<pollfd> entries;
+    std::vector<Device*> owners;
+
+    while (true) {
+        double now = realNow();
+        bool starting = (now < mOptions.duration);
+        double virtualNow = mOptions.startHour * 3600 + now * mOptions.speed;
+
+        for (size_t i = 0; i < mDevices.size(); i++) {
+            Device& device = *mDevices[i];
+            if (starting && (device.phase == SESSION_IDLE) && (device.nextWake <= virtualNow)) {
+                startWake(device, now);
+            }
+            if (device.phase == SESSION_IDLE) {
+                continue;
+            }
+            if ((now - device.progress) > SESSION_TIMEOUT) {
+                mTimeouts++;
+                closeSession(device, false, now);
+            } else if ((device.phase == SESSION_AWAKE) && (now >= device.awakeUntil)) {
+                finish(device, now);
+            }
+        }
+
+        if (now >= nextReport) {
+            report(now, false);
+            nextReport += mOptions.interval;
+        }
+        if (!starting && (mActive == 0)) {
+            if (drainUntil < 0) {
+                drainUntil = now + DRAIN_TIME;
+            } else if (now >= drainUntil) {
+                break;
+            }
+        }
+
+        entries.clear();
+        owners.clear();
+        entries.push_back({ mMonitor, POLLIN, 0 });
+        owners.push_back(NULL);
+        for (size_t i = 0; i < mDevices.size(); i++) {
+            if (mDevices[i]->fd >= 0) {
+                entries.push_back({ mDevices[i]->fd, POLLIN, 0 });
+                owners.push_back(mDevices[i]);
+            }
+        }
+        if (poll(&entries[0], entries.size(), 5) <= 0) {
+            continue;
+        }
+        now = realNow();
+        for (size_t i = 0; i < entries.size(); i++) {
+            if ((entries[i].revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            uint8_t header;
+            std::string body;
+            if (owners[i] == NULL) {
+                if (!receive(mMonitor, mMonitorReceived)) {
+                    std::cerr << "monitor connection lost" << std::endl;
+                    return;
+                }
+                while (mqttNext(mMonitorReceived, header, body)) {
+                    monitorPacket(header, body, now);
+                }
+                continue;
+            }
+            Device& device = *owners[i];
+            if ((device.fd != entries[i].fd) || !receive(device.fd, device.received)) {
+                if (device.fd == entries[i].fd) {
+                    mFailed++;
+                    closeSession(device, false, now);
+                }
+                continue;
+            }
+            while ((device.fd >= 0) && mqttNext(device.received, header, body)) {
+                handle(device, header, body, now);
+            }
+        }
+    }
+    report(realNow(), false);
+}
+
+void Fleet::summary(void) {
+    double seconds = realNow();
+    double published = (mOptions.duration < seconds) ? mOptions.duration : seconds;
+    unsigned long missing = 0;
+    for (std::map<std::string, std::deque<double> >::const_iterator i = mExpected.begin(); i != mExpected.end(); i++) {
+        missing += i->second.size();
+    }
+    unsigned long wakes = mWakes[WAKE_NOP] + mWakes[WAKE_FASTPATH] + mWakes[WAKE_HOMIE];
+    printf("\n");
+    printf("devices %d, %.0f s at speed %.0f (%.1f h simulated)\n", mOptions.devices, published, mOptions.speed,
+           published * mOptions.speed / 3600);
+    printf("wakes %lu (nop %lu, fastpath %lu, homie %lu), pumpruns %lu\n", wakes,
+           mWakes[WAKE_NOP], mWakes[WAKE_FASTPATH], mWakes[WAKE_HOMIE], mPumpRuns);
+    printf("sessions %lu, failed %lu, timeouts %lu, peak connections %d, max wake lag %.2f s\n",
+           mSessions, mFailed, mTimeouts, mPeakActive, mMaxLag);
+    printf("published %lu messages (%.1f/s), %.1f kB (%.1f kB/s)\n", mPublished, mPublished / published,
+           mBytes / 1000.0, mBytes / 1000.0 / published);
+    printf("delivered %lu (%.1f/s), missing %lu, foreign %lu\n", mDelivered, mDelivered / published, missing, mForeign);
+    printf("%-10s %8s %8s %8s %8s %8s\n", "latency ms", "count", "p50", "p95", "p99", "max");
+    const Latency* latencies[] = { &mConnack, &mPuback, &mDelivery, &mSession };
+    const char* names[] = { "connack", "puback", "delivery", "session" };
+    for (int i = 0; i < 4; i++) {
+        const std::vector<double>& all = latencies[i]->all;
+        printf("%-10s %8lu %8.1f %8.1f %8.1f %8.1f\n", names[i], (unsigned long) all.size(), percentile(all, 0.5),
+               percentile(all, 0.95), percentile(all, 0.99), percentile(all, 1.0));
+    }
+}
+
+int main(int argc, char** argv) {
+    const char* configPath = NULL;
+    const char* profilePath = NULL;
+    FleetOptions_t options;
+    options.host = "127.0.0.1";
+    options.port = DEFAULT_PORT;
+    options.baseTopic = "homie/";
+    options.prefix = "plantctrl-";
+    options.devices = DEFAULT_DEVICES;
+    options.speed = 1;
+    options.duration = DEFAULT_DURATION;
+    options.startHour = DEFAULT_START_HOUR;
+    options.interval = DEFAULT_INTERVAL;
+    options.seed = 1;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "--host") && hasValue) {
+            options.host = argv[++i];
+        } else if ((argument == "--port") && hasValue) {
+            options.port = atoi(argv[++i]);
+        } else if ((argument == "--devices") && hasValue) {
+            options.devices = atoi(argv[++i]);
+        } else if ((argument == "--speed") && hasValue) {
+            options.speed = atof(argv[++i]);
+        } else if ((argument == "--duration") && hasValue) {
+            options.duration = atof(argv[++i]);
+        } else if ((argument == "--interval") && hasValue) {
+            options.interval = atof(argv[++i]);
+        } else if ((argument == "--start-hour") && hasValue) {
+            options.startHour = atof(argv[++i]);
+        } else if ((argument == "--base") && hasValue) {
+            options.baseTopic = argv[++i];
+        } else if ((argument == "--prefix") && hasValue) {
+            options.prefix = argv[++i];
+        } else if ((argument == "--seed") && hasValue) {
+            options.seed = atoi(argv[++i]);
+        } else if ((argument == "-c") && hasValue) {
+            configPath = argv[++i];
+        } else if ((argument == "-p") && hasValue) {
+            profilePath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if ((options.devices <= 0) || (options.speed <= 0) || (options.interval <= 0) ||
+        options.baseTopic.empty() || (options.baseTopic[options.baseTopic.size() - 1] != '/')) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string json;
+    if ((configPath != NULL) && !hostReadFile(configPath, json)) {
+        std::cerr << "cannot read " << configPath << std::endl;
+        return 2;
+    }
+    HostSettings_t settings;
+    hostLoadSettings(json, settings);
+    PowerProfile_t profile;
+    powerProfileDefaults(profile);
+    if (profilePath != NULL) {
+        if (!hostReadFile(profilePath, json)) {
+            std::cerr << "cannot read " << profilePath << std::endl;
+            return 2;
+        }
+        powerProfileLoad(json, profile);
+    }
+
+    gStart = Clock::now();
+    Fleet fleet(options, settings, profile);
+    if (!fleet.connectMonitor()) {
+        return 1;
+    }
+    /* the virtual clock starts with the first wake */
+    gStart = Clock::now();
+    fleet.run();
+    fleet.summary();
+    return 0;
+}
@@ -0,0 +1,172 @@
+/**
+ * @file decoder.cpp
+ * @author your name (you@domain.com)
+ * @brief Decode a dump of the history partition
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude host/history/decoder.cpp src/HistoryFormat.cpp -o history-decoder
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HistoryFormat.h"
+
+typedef struct Page_t {
+    uint32_t sequence;
+    size_t offset;
+} Page_t;
+
+typedef struct Column_t {
+    const char* name;
+    const char* type;       /**< Type of the values in the column file */
+    size_t size;            /**< Bytes per value */
+} Column_t;
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--csv file] [--columns directory] history.bin" << std::endl
+              << "  dump the partition with: esptool.py read_flash 0x317000 0xE9000 history.bin" << std::endl;
+}
+
+static bool comparePages(const Page_t& first, const Page_t& second) {
+    return first.sequence < second.sequence;
+}
+
+static void writeCsv(std::ostream& out, const std::vector<HistoryRecord_t>& records) {
+    char line[HISTORY_LINE_SIZE];
+    historyFormatHeader(line, sizeof(line), HISTORY_ALL_PLANTS);
+    out << line << std::endl;
+    for (size_t i = 0; i < records.size(); i++) {
+        historyFormat(line, sizeof(line), records[i], HISTORY_ALL_PLANTS);
+        out << line << std::endl;
+    }
+}
+
+/**
+ * @brief One little endian file per column and schema.csv (name,type,rows)
+ * Unknown values keep their marker (HISTORY_UNKNOWN, HISTORY_TEMP_UNKNOWN).
+ */
+static bool writeColumns(const std::string& directory, const std::vector<HistoryRecord_t>& records) {
+    static const Column_t columns[] = {
+        { "time", "uint32", 4 },
+        { "moist0", "uint16", 2 }, { "moist1", "uint16", 2 }, { "moist2", "uint16", 2 }, { "moist3", "uint16", 2 },
+        { "moist4", "uint16", 2 }, { "moist5", "uint16", 2 }, { "moist6", "uint16", 2 },
+        { "tempair", "int16", 2 }, { "tempcontrol", "int16", 2 },
+        { "water", "uint16", 2 }, { "lipo", "uint16", 2 }, { "solar", "uint16", 2 },
+        { "pumps", "uint8", 1 }, { "wake", "uint8", 1 }, { "awake", "uint8", 1 }
+    };
+    /* the columns follow the record layout, so each value is a slice of the record */
+    static_assert(MAX_PLANTS == 7, "columns of the moisture sensors");
+    size_t columnCount = sizeof(columns) / sizeof(columns[0]);
+
+    std::ofstream schema((directory + "/schema.csv").c_str());
+    if (!schema) {
+        std::cerr << "cannot write " << directory << "/schema.csv" << std::endl;
+        return false;
+    }
+    schema << "name,type,rows" << std::endl;
+    size_t position = 0;
+    for (size_t column = 0; column < columnCount; column++) {
+        std::string path = directory + "/" + columns[column].name + ".bin";
+        std::ofstream file(path.c_str(), std::ios::binary);
+        if (!file) {
+            std::cerr << "cannot write " << path << std::endl;
+            return false;
+        }
+        for (size_t i = 0; i < records.size(); i++) {
+            file.write(((const char*) &records[i]) + position, columns[column].size);
+        }
+        schema << columns[column].name << "," << columns[column].type << "," << records.size() << std::endl;
+        position += columns[column].size;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    const char* csvPath = NULL;
+    const char* columnsPath = NULL;
+    const char* dumpPath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "--csv") && hasValue) {
+            csvPath = argv[++i];
+        } else if ((argument == "--columns") && hasValue) {
+            columnsPath = argv[++i];
+        } else if ((argument[0] != '-') && (dumpPath == NULL)) {
+            dumpPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (dumpPath == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream dumpFile(dumpPath, std::ios::binary);
+    if (!dumpFile) {
+        std::cerr << "cannot read " << dumpPath << std::endl;
+        return 2;
+    }
+    std::vector<uint8_t> dump((std::istreambuf_iterator<char>(dumpFile)), std::istreambuf_iterator<char>());
+
+    /* the ring is ordered by the sequence of the pages */
+    std::vector<Page_t> pages;
+    for (size_t offset = 0; (offset + HISTORY_PAGE_SIZE) <= dump.size(); offset += HISTORY_PAGE_SIZE) {
+        HistoryPageHeader_t header;
+        memcpy(&header, &dump[offset], sizeof(header));
+        if (historyPageIsValid(header)) {
+            Page_t page = { header.sequence, offset };
+            pages.push_back(page);
+        }
+    }
+    std::sort(pages.begin(), pages.end(), comparePages);
+
+    std::vector<HistoryRecord_t> records;
+    unsigned long corrupt = 0;
+    for (size_t i = 0; i < pages.size(); i++) {
+        HistoryPageHeader_t header;
+        memcpy(&header, &dump[pages[i].offset], sizeof(header));
+        for (int slot = 0; slot < header.count; slot++) {
+            HistoryRecord_t record;
+            memcpy(&record, &dump[pages[i].offset + sizeof(header) + (slot * sizeof(record))], sizeof(record));
+            if (historyIsValid(record)) {
+                records.push_back(record);
+            } else {
+                corrupt++;
+            }
+        }
+    }
+
+    if (csvPath != NULL) {
+        std::ofstream csv(csvPath);
+        if (!csv) {
+            std::cerr << "cannot write " << csvPath << std::endl;
+            return 2;
+        }
+        writeCsv(csv, records);
+    } else if (columnsPath == NULL) {
+        writeCsv(std::cout, records);
+    }
+    if ((columnsPath != NULL) && !writeColumns(columnsPath, records)) {
+        return 2;
+    }
+
+    std::cerr << pages.size() << " pages, " << records.size() << " records, " << corrupt << " corrupt";
+    if (!pages.empty()) {
+        std::cerr << ", sequence " << pages.front().sequence << ".." << pages.back().sequence;
+    }
+    std::cerr << std::endl;
+    return (corrupt > 0) ? 1 : 0;
+}
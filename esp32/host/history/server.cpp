@@ -0,0 +1,225 @@
+/**
+ * @file server.cpp
+ * @author your name (you@domain.com)
+ * @brief Serve a history dump like the controller in mode3 (GET /history)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Uses the same HistoryStream as the firmware, so the endpoint can be tested with curl
+ * against a dump of the controller or the output of the simulator (--history).
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude host/history/server.cpp src/HistoryStream.cpp src/HistoryFormat.cpp src/DeltaCodec.cpp -o history-server
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "HistoryStream.h"
+
+#define DEFAULT_PORT        8080
+#define CHUNK_SIZE          512     /**< Like one TCP segment of the AsyncWebServer */
+#define REQUEST_SIZE        1024
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--port n] [--once] history.bin" << std::endl
+              << "  curl \"http://localhost:8080/history?from=0&to=86400&plant=2\"" << std::endl;
+}
+
+static bool readDump(void* context, uint32_t offset, void* data, size_t length) {
+    const std::vector<uint8_t>* dump = (const std::vector<uint8_t>*) context;
+    if ((offset + length) > dump->size()) {
+        return false;
+    }
+    memcpy(data, &(*dump)[offset], length);
+    return true;
+}
+
+/**
+ * @brief Offset behind the newest page, as HistoryLog finds it after a power on
+ */
+static uint32_t findHead(const std::vector<uint8_t>& dump) {
+    bool found = false;
+    uint32_t newest = 0;
+    uint32_t head = 0;
+    for (size_t offset = 0; (offset + HISTORY_PAGE_SIZE) <= dump.size(); offset += HISTORY_PAGE_SIZE) {
+        HistoryPageHeader_t header;
+        memcpy(&header, &dump[offset], sizeof(header));
+        if (historyPageIsValid(header) && (!found || (header.sequence > newest))) {
+            found = true;
+            newest = header.sequence;
+            head = offset + HISTORY_PAGE_SIZE;
+        }
+    }
+    return head;
+}
+
+/**
+ * @brief Value of a query parameter
+ * @return false, if the parameter is missing
+ */
+static bool queryValue(const std::string& query, const std::string& name, long& value) {
+    std::string::size_type position = 0;
+    while (position < query.size()) {
+        std::string::size_type end = query.find('&', position);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+        std::string pair = query.substr(position, end - position);
+        if (pair.compare(0, name.size() + 1, name + "=") == 0) {
+            value = atol(pair.c_str() + name.size() + 1);
+            return true;
+        }
+        position = end + 1;
+    }
+    return false;
+}
+
+static bool sendAll(int client, const char* data, size_t length) {
+    while (length > 0) {
+        ssize_t sent = send(client, data, length, 0);
+        if (sent <= 0) {
+            return false;
+        }
+        data += sent;
+        length -= sent;
+    }
+    return true;
+}
+
+static void sendStatus(int client, const char* status, const char* text) {
+    char response[256];
+    int length = snprintf(response, sizeof(response),
+                          "HTTP/1.1 %s\r\nContent-Type: text/plain\r\nContent-Length: %zu\r\nConnection: close\r\n\r\n%s",
+                          status, strlen(text), text);
+    sendAll(client, response, length);
+}
+
+static void serve(int client, std::vector<uint8_t>& dump) {
+    char request[REQUEST_SIZE];
+    ssize_t received = recv(client, request, sizeof(request) - 1, 0);
+    if (received <= 0) {
+        return;
+    }
+    request[received] = '\0';
+
+    char method[8];
+    char target[REQUEST_SIZE];
+    if ((sscanf(request, "%7s %1023s", method, target) != 2) || (strcmp(method, "GET") != 0)) {
+        sendStatus(client, "405 Method Not Allowed", "GET only");
+        return;
+    }
+    std::string path = target;
+    std::string query;
+    std::string::size_type separator = path.find('?');
+    if (separator != std::string::npos) {
+        query = path.substr(separator + 1);
+        path = path.substr(0, separator);
+    }
+    if (path != "/history") {
+        sendStatus(client, "404 Not Found", "not found");
+        return;
+    }
+
+    HistoryFilter_t filter;
+    historyFilterClear(filter);
+    long value;
+    if (queryValue(query, "from", value)) {
+        filter.from = value;
+    }
+    if (queryValue(query, "to", value)) {
+        filter.to = value;
+    }
+    if (queryValue(query, "plant", value)) {
+        if ((value < 0) || (value >= MAX_PLANTS)) {
+            sendStatus(client, "400 Bad Request", "plant 0..6");
+            return;
+        }
+        filter.plant = value;
+    }
+
+    const char* header = "HTTP/1.1 200 OK\r\nContent-Type: text/csv\r\nTransfer-Encoding: chunked\r\nConnection: close\r\n\r\n";
+    if (!sendAll(client, header, strlen(header))) {
+        return;
+    }
+    HistoryStream stream;
+    stream.begin(readDump, &dump, dump.size(), findHead(dump), NULL, 0, filter);
+    uint8_t chunk[CHUNK_SIZE];
+    size_t length;
+    while ((length = stream.fill(chunk, sizeof(chunk))) > 0) {
+        char size[16];
+        int sizeLength = snprintf(size, sizeof(size), "%zx\r\n", length);
+        if (!sendAll(client, size, sizeLength) || !sendAll(client, (const char*) chunk, length) ||
+            !sendAll(client, "\r\n", 2)) {
+            return;
+        }
+    }
+    sendAll(client, "0\r\n\r\n", 5);
+}
+
+int main(int argc, char** argv) {
+    const char* dumpPath = NULL;
+    int port = DEFAULT_PORT;
+    bool once = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "--port") && hasValue) {
+            port = atoi(argv[++i]);
+        } else if (argument == "--once") {
+            once = true;
+        } else if ((argument[0] != '-') && (dumpPath == NULL)) {
+            dumpPath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (dumpPath == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::ifstream dumpFile(dumpPath, std::ios::binary);
+    if (!dumpFile) {
+        std::cerr << "cannot read " << dumpPath << std::endl;
+        return 2;
+    }
+    std::vector<uint8_t> dump((std::istreambuf_iterator<char>(dumpFile)), std::istreambuf_iterator<char>());
+
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    int reuse = 1;
+    setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = htons(port);
+    if ((listener < 0) || (bind(listener, (sockaddr*) &address, sizeof(address)) != 0) || (listen(listener, 4) != 0)) {
+        std::cerr << "cannot listen on port " << port << std::endl;
+        return 2;
+    }
+    std::cerr << "serving " << dumpPath << " on http://localhost:" << port << "/history" << std::endl;
+
+    do {
+        int client = accept(listener, NULL, NULL);
+        if (client < 0) {
+            continue;
+        }
+        serve(client, dump);
+        close(client);
+    } while (!once);
+    close(listener);
+    return 0;
+}
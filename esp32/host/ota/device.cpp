@@ -0,0 +1,463 @@
+/**
+ * @file device.cpp
+ * @author your name (you@domain.com)
+ * @brief Device side of the resumable firmware update on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Plays the controller against ota_chunked.py over an MQTT broker: the manifest and the
+ * chunks are checked and inflated by ChunkDecoder.cpp, the same code as on the controller,
+ * and written into an image in memory. The progress survives the lost connections
+ * (--drop), like the RTC memory survives the deep sleep, so every new connection
+ * continues with the next missing chunk.
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude host/ota/device.cpp src/ChunkDecoder.cpp -lz -lcrypto -o ota-device
+ */
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <openssl/evp.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ChunkDecoder.h"
+
+#define DEFAULT_PORT        1883
+#define CHUNK_TIMEOUT       10000   /**< ms, CHUNKOTA_TIMEOUT of the firmware */
+#define CHUNK_RETRIES       3       /**< CHUNKOTA_RETRIES of the firmware */
+#define STATUS_INTERVAL     16      /**< CHUNKOTA_PERSIST_INTERVAL of the firmware */
+#define MAX_WAKES           1000    /**< Stop, if the update does not finish */
+#define KEEP_ALIVE          15      /**< s, the Homie default */
+#define RECEIVE_SIZE        4096
+
+#define MQTT_CONNECT        0x10
+#define MQTT_CONNACK        0x20
+#define MQTT_PUBLISH        0x30
+#define MQTT_PUBACK         0x40
+#define MQTT_SUBSCRIBE      0x82
+#define MQTT_DISCONNECT     0xE0
+#define MQTT_QOS1           0x02
+
+typedef enum WakeResult_t {
+    WAKE_CONTINUE = 0,      /**< The update continues, in this or (after a lost connection) in the next wake */
+    WAKE_UPDATED,           /**< The image is complete and has the checksum of the manifest */
+    WAKE_FAILED
+} WakeResult_t;
+
+typedef struct DeviceOptions_t {
+    std::string host;
+    int port;
+    std::string baseTopic;
+    std::string deviceId;
+    int drop;               /**< Drop the connection after so many chunks, 0 never */
+    long corrupt;           /**< Damage this chunk once, -1 never */
+    const char* imagePath;
+} DeviceOptions_t;
+
+/**
+ * @brief Kept between the wakes, like the RTC memory of the controller
+ */
+typedef struct Progress_t {
+    char md5[CHUNKOTA_MD5_SIZE];
+    uint32_t nextChunk;
+    std::vector<uint8_t> image;
+} Progress_t;
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " -i device-id [--host host] [--port port] [--base homie/]" << std::endl
+              << "       [--drop chunks] [--corrupt index] [-o image.bin]" << std::endl;
+}
+
+/**
+ ******************************* MQTT 3.1.1 packets ******************************
+ */
+
+static void putLength(std::string& packet, size_t length) {
+    do {
+        uint8_t byte = length % 128;
+        length /= 128;
+        packet.push_back((char) ((length > 0) ? (byte | 0x80) : byte));
+    } while (length > 0);
+}
+
+static void putShort(std::string& body, uint16_t value) {
+    body.push_back((char) (value >> 8));
+    body.push_back((char) (value & 0xFF));
+}
+
+static void putString(std::string& body, const std::string& text) {
+    putShort(body, (uint16_t) text.size());
+    body += text;
+}
+
+static std::string mqttPacket(uint8_t header, const std::string& body) {
+    std::string packet(1, (char) header);
+    putLength(packet, body.size());
+    return packet + body;
+}
+
+static std::string mqttConnect(const std::string& clientId) {
+    std::string body;
+    putString(body, "MQTT");
+    body.push_back(4);                      /* protocol level 3.1.1 */
+    body.push_back(0x02);                   /* clean session */
+    putShort(body, KEEP_ALIVE);
+    putString(body, clientId);
+    return mqttPacket(MQTT_CONNECT, body);
+}
+
+static std::string mqttPublish(const std::string& topic, const std::string& payload, uint16_t packetId) {
+    std::string body;
+    putString(body, topic);
+    putShort(body, packetId);
+    body += payload;
+    return mqttPacket(MQTT_PUBLISH | MQTT_QOS1, body);
+}
+
+static std::string mqttSubscribe(uint16_t packetId, const std::string& filter) {
+    std::string body;
+    putShort(body, packetId);
+    putString(body, filter);
+    body.push_back(1);                      /* QoS 1, like ChunkedOta::begin() */
+    return mqttPacket(MQTT_SUBSCRIBE, body);
+}
+
+/**
+ * @brief Take the next complete packet from the receive buffer
+ * @return false, if the packet is not complete yet
+ */
+static bool mqttNext(std::string& buffer, uint8_t& header, std::string& body) {
+    size_t length = 0;
+    size_t used = 1;
+    for (int shift = 0; ; shift += 7) {
+        if ((used >= buffer.size()) || (shift > 21)) {
+            return false;
+        }
+        uint8_t byte = (uint8_t) buffer[used++];
+        length |= (size_t) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            break;
+        }
+    }
+    if ((used + length) > buffer.size()) {
+        return false;
+    }
+    header = (uint8_t) buffer[0];
+    body = buffer.substr(used, length);
+    buffer.erase(0, used + length);
+    return true;
+}
+
+static int openSocket(const std::string& host, int port) {
+    addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* address = NULL;
+    if (getaddrinfo(host.c_str(), std::to_string(port).c_str(), &hints, &address) != 0) {
+        return -1;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        if (connect(fd, address->ai_addr, address->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(address);
+    return fd;
+}
+
+static bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t written = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (written <= 0) {
+            return false;
+        }
+        sent += written;
+    }
+    return true;
+}
+
+static std::string md5Hex(const std::vector<uint8_t>& data) {
+    unsigned char digest[EVP_MAX_MD_SIZE];
+    unsigned int length = 0;
+    EVP_Digest(data.data(), data.size(), digest, &length, EVP_md5(), NULL);
+    char hex[CHUNKOTA_MD5_SIZE] = { 0 };
+    for (unsigned int i = 0; (i < length) && (i < 16); i++) {
+        snprintf(hex + 2 * i, 3, "%02x", digest[i]);
+    }
+    return hex;
+}
+
+/**
+ ******************************* Device ******************************
+ */
+
+class Device {
+    private:
+        DeviceOptions_t mOptions;
+        Progress_t& mProgress;
+        std::string mPrefix;
+        ChunkManifest_t mManifest;
+        bool mActive = false;
+        int mFd = -1;
+        uint16_t mPacketId = 0;
+        int mChunks = 0;                /**< Written in this wake */
+        bool mCorrupted = false;
+
+        bool publish(const std::string& name, const std::string& payload);
+        bool requestChunk(void);
+        WakeResult_t startUpdate(const std::string& text);
+        WakeResult_t processChunk(std::string& message);
+        WakeResult_t finishUpdate(void);
+
+    public:
+        Device(const DeviceOptions_t& options, Progress_t& progress)
+            : mOptions(options), mProgress(progress) {
+            this->mPrefix = options.baseTopic + options.deviceId + "/$implementation/chunkota/";
+        }
+
+        /**
+         * @brief One wake: connect, continue the update until it is done or the connection is dropped
+         */
+        WakeResult_t wake(int number);
+};
+
+bool Device::publish(const std::string& name, const std::string& payload) {
+    if (++this->mPacketId == 0) {
+        this->mPacketId = 1;
+    }
+    return sendAll(this->mFd, mqttPublish(this->mPrefix + name, payload, this->mPacketId));
+}
+
+bool Device::requestChunk(void) {
+    char request[64];
+    int length = chunkRequest(this->mManifest, this->mProgress.nextChunk, request, sizeof(request));
+    return publish("request", std::string(request, length));
+}
+
+WakeResult_t Device::startUpdate(const std::string& text) {
+    if (text.empty()) {
+        /* the retained manifest was removed */
+        return WAKE_CONTINUE;
+    }
+    if (!chunkParseManifest(text.c_str(), this->mManifest)) {
+        publish("status", "400 manifest");
+        return WAKE_FAILED;
+    }
+    if (strcmp(this->mProgress.md5, this->mManifest.md5) != 0) {
+        strcpy(this->mProgress.md5, this->mManifest.md5);
+        this->mProgress.nextChunk = 0;
+        this->mProgress.image.assign(this->mManifest.imageSize, 0xFF);
+    }
+    this->mActive = true;
+    std::cout << "manifest " << text << ", from chunk " << this->mProgress.nextChunk << std::endl;
+    if (this->mProgress.nextChunk == this->mManifest.chunkCount) {
+        return finishUpdate();
+    }
+    return requestChunk() ? WAKE_CONTINUE : WAKE_FAILED;
+}
+
+WakeResult_t Device::processChunk(std::string& message) {
+    uint32_t index = this->mProgress.nextChunk;
+    if ((this->mOptions.corrupt == (long) index) && !this->mCorrupted && (message.size() > CHUNKOTA_HEADER_SIZE)) {
+        /* a damaged chunk is requested again */
+        message[message.size() - 1] ^= 0x55;
+        this->mCorrupted = true;
+    }
+    uint8_t chunk[CHUNKOTA_MAX_CHUNK_SIZE];
+    std::vector<uint8_t> inflator(chunkInflatorSize());
+    ChunkResult_t result = chunkDecode(this->mManifest, index, (const uint8_t*) message.data(), message.size(),
+                                       inflator.data(), chunk);
+    if (result == CHUNK_UNEXPECTED) {
+        return WAKE_CONTINUE;
+    }
+    if (result == CHUNK_CORRUPT) {
+        std::cout << "chunk " << index << " corrupt" << std::endl;
+        publish("status", "400 crc " + std::to_string(index));
+        return requestChunk() ? WAKE_CONTINUE : WAKE_FAILED;
+    }
+
+    uint32_t offset = index * this->mManifest.chunkSize;
+    uint32_t length = chunkLength(this->mManifest, index);
+    memcpy(this->mProgress.image.data() + offset, chunk, length);
+    this->mProgress.nextChunk++;
+    this->mChunks++;
+    if ((this->mProgress.nextChunk % STATUS_INTERVAL) == 0) {
+        publish("status", "206 " + std::to_string(offset + length) + "/" + std::to_string(this->mManifest.imageSize));
+    }
+    if (this->mProgress.nextChunk == this->mManifest.chunkCount) {
+        return finishUpdate();
+    }
+    if ((this->mOptions.drop > 0) && (this->mChunks >= this->mOptions.drop)) {
+        /* lost connection or deep sleep: no DISCONNECT, the next wake continues */
+        std::cout << "connection dropped after chunk " << index << std::endl;
+        close(this->mFd);
+        this->mFd = -1;
+        return WAKE_CONTINUE;
+    }
+    return requestChunk() ? WAKE_CONTINUE : WAKE_FAILED;
+}
+
+WakeResult_t Device::finishUpdate(void) {
+    this->mActive = false;
+    std::string checksum = md5Hex(this->mProgress.image);
+    if (checksum != this->mManifest.md5) {
+        std::cout << "image checksum " << checksum << " differs" << std::endl;
+        publish("status", "400 md5");
+        return WAKE_FAILED;
+    }
+    std::cout << "image complete, " << this->mManifest.imageSize << " bytes" << std::endl;
+    publish("status", "200");
+    return WAKE_UPDATED;
+}
+
+WakeResult_t Device::wake(int number) {
+    this->mFd = openSocket(this->mOptions.host, this->mOptions.port);
+    if (this->mFd < 0) {
+        std::cerr << "cannot connect to " << this->mOptions.host << ":" << this->mOptions.port << std::endl;
+        return WAKE_FAILED;
+    }
+    std::cout << "wake " << number << std::endl;
+    this->mActive = false;
+    this->mChunks = 0;
+    if (!sendAll(this->mFd, mqttConnect(this->mOptions.deviceId)) ||
+        !sendAll(this->mFd, mqttSubscribe(1, this->mPrefix + "manifest")) ||
+        !sendAll(this->mFd, mqttSubscribe(2, this->mPrefix + "chunk"))) {
+        close(this->mFd);
+        return WAKE_FAILED;
+    }
+
+    std::string buffer;
+    int retries = 0;
+    WakeResult_t result = WAKE_CONTINUE;
+    while (this->mFd >= 0) {
+        pollfd descriptor = { this->mFd, POLLIN, 0 };
+        int ready = poll(&descriptor, 1, CHUNK_TIMEOUT);
+        if (ready == 0) {
+            if (!this->mActive) {
+                std::cerr << "no manifest" << std::endl;
+                result = WAKE_FAILED;
+                break;
+            }
+            if (++retries > CHUNK_RETRIES) {
+                publish("status", "408 timeout");
+                result = WAKE_FAILED;
+                break;
+            }
+            requestChunk();
+            continue;
+        }
+        char data[RECEIVE_SIZE];
+        ssize_t length = recv(this->mFd, data, sizeof(data), 0);
+        if (length <= 0) {
+            std::cerr << "connection closed by the broker" << std::endl;
+            result = WAKE_FAILED;
+            break;
+        }
+        buffer.append(data, length);
+
+        uint8_t header;
+        std::string body;
+        while ((this->mFd >= 0) && mqttNext(buffer, header, body)) {
+            if ((header & 0xF0) != MQTT_PUBLISH) {
+                continue;
+            }
+            size_t topicLength = (((uint8_t) body[0]) << 8) | (uint8_t) body[1];
+            std::string topic = body.substr(2, topicLength);
+            size_t payload = 2 + topicLength;
+            if (header & 0x06) {
+                std::string acknowledge;
+                acknowledge += body.substr(payload, 2);
+                sendAll(this->mFd, mqttPacket(MQTT_PUBACK, acknowledge));
+                payload += 2;
+            }
+            std::string message = body.substr(payload);
+            if ((topic == this->mPrefix + "manifest") && !this->mActive) {
+                result = startUpdate(message);
+            } else if ((topic == this->mPrefix + "chunk") && this->mActive) {
+                retries = 0;
+                result = processChunk(message);
+            }
+            if (result != WAKE_CONTINUE) {
+                break;
+            }
+        }
+        if (result != WAKE_CONTINUE) {
+            break;
+        }
+    }
+    if (this->mFd >= 0) {
+        sendAll(this->mFd, mqttPacket(MQTT_DISCONNECT, ""));
+        close(this->mFd);
+        this->mFd = -1;
+    }
+    return result;
+}
+
+int main(int argc, char** argv) {
+    DeviceOptions_t options;
+    options.host = "127.0.0.1";
+    options.port = DEFAULT_PORT;
+    options.baseTopic = "homie/";
+    options.drop = 0;
+    options.corrupt = -1;
+    options.imagePath = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "--host") && hasValue) {
+            options.host = argv[++i];
+        } else if ((argument == "--port") && hasValue) {
+            options.port = atoi(argv[++i]);
+        } else if ((argument == "--base") && hasValue) {
+            options.baseTopic = argv[++i];
+        } else if ((argument == "-i") && hasValue) {
+            options.deviceId = argv[++i];
+        } else if ((argument == "--drop") && hasValue) {
+            options.drop = atoi(argv[++i]);
+        } else if ((argument == "--corrupt") && hasValue) {
+            options.corrupt = atol(argv[++i]);
+        } else if ((argument == "-o") && hasValue) {
+            options.imagePath = argv[++i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.deviceId.empty() || options.baseTopic.empty() || (options.baseTopic[options.baseTopic.size() - 1] != '/')) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    Progress_t progress;
+    progress.md5[0] = '\0';
+    progress.nextChunk = 0;
+    Device device(options, progress);
+    WakeResult_t result = WAKE_CONTINUE;
+    for (int wake = 1; (wake <= MAX_WAKES) && (result == WAKE_CONTINUE); wake++) {
+        result = device.wake(wake);
+    }
+    if ((result == WAKE_UPDATED) && (options.imagePath != NULL)) {
+        std::ofstream image(options.imagePath, std::ios::binary);
+        image.write((const char*) progress.image.data(), progress.image.size());
+    }
+    return (result == WAKE_UPDATED) ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#!/usr/bin/env python
+
+from __future__ import division, print_function
+import paho.mqtt.client as mqtt
+import struct, sys, zlib
+from hashlib import md5
+
+CHUNK_SIZE = 4096  # one flash sector, the device erases and writes chunk by chunk
+
+
+def build_chunks(firmware, chunk_size, level):
+    """ Compress every chunk on its own, so the device can continue at any chunk """
+    chunks = []
+    for index, offset in enumerate(range(0, len(firmware), chunk_size)):
+        raw = bytes(firmware[offset:offset + chunk_size])
+        header = struct.pack('<III', index, len(raw), zlib.crc32(raw) & 0xffffffff)
+        chunks.append(header + zlib.compress(raw, level))
+    return chunks
+
+
+def topic(userdata, name):
+    return "{base_topic}{device_id}/$implementation/chunkota/{name}".format(name=name, **userdata)
+
+
+# The callback for when the client receives a CONNACK response from the server.
+def on_connect(client, userdata, flags, rc):
+    if rc != 0:
+        print("Connection Failed with result code {}".format(rc))
+        client.disconnect()
+        return
+    print("Connected with result code {}".format(rc))
+
+    client.subscribe(topic(userdata, "request"))
+    client.subscribe(topic(userdata, "status"))
+
+    # retained, so the device finds the update on its next wake
+    manifest = "{md5} {size} {chunk_size} {count}".format(count=len(userdata['chunks']), **userdata)
+    client.publish(topic(userdata, "manifest"), manifest, qos=1, retain=True)
+    print("Published manifest {}, waiting for the device to wake up...".format(manifest))
+
+
+def finish(client, userdata):
+    # remove the retained manifest
+    client.publish(topic(userdata, "manifest"), "", qos=1, retain=True)
+    client.disconnect()
+
+
+# The callback for when a PUBLISH message is received from the server.
+def on_message(client, userdata, msg):
+    payload = msg.payload.decode()
+
+    if msg.topic.endswith('/request'):
+        checksum, index = payload.split()
+        index = int(index)
+        if checksum != userdata['md5'] or index >= len(userdata['chunks']):
+            print("\nUnexpected request {}".format(payload))
+            return
+        if index == 0 or index != userdata.get('last_index', -1) + 1:
+            print("\nDevice continues with chunk {}".format(index))
+        userdata['last_index'] = index
+        chunk = userdata['chunks'][index]
+        userdata['sent'] = userdata.get('sent', 0) + len(chunk)
+        client.publish(topic(userdata, "chunk"), chunk, qos=1)
+
+        bar_width = 30
+        bar = int(bar_width * (index + 1) / len(userdata['chunks']))
+        print("\r[", '+' * bar, ' ' * (bar_width - bar), "] ", index + 1, '/', len(userdata['chunks']), end='', sep='')
+        sys.stdout.flush()
+
+    elif msg.topic.endswith('/status'):
+        status = int(payload.split()[0])
+        if status == 200:
+            print("\nUpdate successful, {} bytes sent for a {} bytes image".format(userdata.get('sent', 0), userdata['size']))
+            finish(client, userdata)
+        elif status == 304:
+            print("\nDevice firmware already up to date with md5 checksum: {}".format(userdata['md5']))
+            finish(client, userdata)
+        elif status == 206:
+            pass
+        elif status == 408:
+            print("\nDevice stopped the transfer, it continues on the next wake")
+        else:
+            print("\nDevice reported: {}".format(payload))
+            if status in (400, 413, 500) and not payload.endswith('crc') and ' crc ' not in payload:
+                finish(client, userdata)
+
+
+def main(broker_host, broker_port, broker_username, broker_password, broker_ca_cert, base_topic, device_id, firmware, chunk_size, level):
+    chunks = build_chunks(firmware, chunk_size, level)
+    compressed = sum(len(chunk) for chunk in chunks)
+    print("{} bytes in {} chunks, {} bytes compressed ({:.0f}%)".format(
+        len(firmware), len(chunks), compressed, 100.0 * compressed / len(firmware)))
+
+    # initialise mqtt client and register callbacks
+    client = mqtt.Client()
+    client.on_connect = on_connect
+    client.on_message = on_message
+
+    # set username and password if given
+    if broker_username and broker_password:
+        client.username_pw_set(broker_username, broker_password)
+
+    if broker_ca_cert is not None:
+        client.tls_set(
+            ca_certs=broker_ca_cert
+        )
+
+    # save data to be used in the callbacks
+    client.user_data_set({
+            "base_topic": base_topic,
+            "device_id": device_id,
+            "md5": md5(firmware).hexdigest(),
+            "size": len(firmware),
+            "chunk_size": chunk_size,
+            "chunks": chunks
+        })
+
+    # start connection
+    print("Connecting to mqtt broker {} on port {}".format(broker_host, broker_port))
+    client.connect(broker_host, broker_port, 60)
+
+    # Blocking call that processes network traffic, dispatches callbacks and handles reconnecting.
+    client.loop_forever()
+
+
+if __name__ == '__main__':
+    import argparse
+
+    parser = argparse.ArgumentParser(
+        description='resumable ota firmware update with compressed chunks for the PlantControl.')
+
+    # ensure base topic always ends with a '/'
+    def base_topic_arg(s):
+        s = str(s)
+        if not s.endswith('/'):
+            s = s + '/'
+        return s
+
+    # specify arguments
+    parser.add_argument('-l', '--broker-host',     type=str,            required=False,
+                        help='host name or ip address of the mqtt broker', default="127.0.0.1")
+    parser.add_argument('-p', '--broker-port',     type=int,            required=False,
+                        help='port of the mqtt broker', default=1883)
+    parser.add_argument('-u', '--broker-username', type=str,            required=False,
+                        help='username used to authenticate with the mqtt broker')
+    parser.add_argument('-d', '--broker-password', type=str,            required=False,
+                        help='password used to authenticate with the mqtt broker')
+    parser.add_argument('-t', '--base-topic',      type=base_topic_arg, required=False,
+                        help='base topic of the homie devices on the broker', default="homie/")
+    parser.add_argument('-i', '--device-id',       type=str,            required=True,
+                        help='homie device id')
+    parser.add_argument('-z', '--level',           type=int,            required=False,
+                        help='zlib compression level', default=9)
+    parser.add_argument('firmware', type=argparse.FileType('rb'),
+                        help='path to the firmware to be sent to the device')
+
+    parser.add_argument("--broker-tls-cacert", default=None, required=False,
+                        help="CA certificate bundle used to validate TLS connections. If set, TLS will be enabled on the broker conncetion"
+    )
+
+    # workaround for http://bugs.python.org/issue9694
+    parser._optionals.title = "arguments"
+
+    # get and validate arguments
+    args = parser.parse_args()
+
+    # read the contents of firmware into buffer
+    firmware = bytearray(args.firmware.read())
+    args.firmware.close()
+
+    # Invoke the business logic
+    main(args.broker_host, args.broker_port, args.broker_username,
+         args.broker_password, args.broker_tls_cacert, args.base_topic, args.device_id, firmware,
+         CHUNK_SIZE, args.level)
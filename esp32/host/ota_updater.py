@@ -2,7 +2,7 @@
 
 from __future__ import division, print_function
 import paho.mqtt.client as mqtt
-import base64, sys, math
+import base64, sys, math, threading, time
 from hashlib import md5
 
 # The callback for when the client receives a CONNACK response from the server.
@@ -124,6 +124,148 @@ def main(broker_host, broker_port, broker_username, broker_password, broker_ca_c
     client.loop_forever()
 
 
+class Rollout(object):
+    """
+    Update many devices in waves: the canary devices first, then waves of a fixed size.
+    The firmware is published retained for each device of a wave, so every device picks it up
+    on its next wake. A wave is finished, when all devices report the new checksum, reported
+    an error or the timeout is reached. The rollout stops, when too many devices of a wave failed.
+    """
+    PENDING, PUBLISHED, UPDATING, DONE, FAILED = "pending", "published", "updating", "done", "failed"
+
+    def __init__(self, client, base_topic, devices, firmware, canary, wave_size, failure_threshold, timeout):
+        self.client = client
+        self.base_topic = base_topic
+        self.firmware = firmware
+        self.md5 = md5(firmware).hexdigest()
+        self.canary = canary
+        self.wave_size = wave_size
+        self.failure_threshold = failure_threshold
+        self.timeout = timeout
+        self.lock = threading.Lock()
+        self.state = dict((device_id, Rollout.PENDING) for device_id in devices)
+        self.checksum = {}
+
+    def topic(self, device_id, suffix):
+        return "{}{}/{}".format(self.base_topic, device_id, suffix)
+
+    def on_connect(self, client, userdata, flags, rc):
+        if rc != 0:
+            print("Connection Failed with result code {}".format(rc))
+            return
+        # track all devices at once, the retained checksums tell the installed firmware
+        for device_id in self.state:
+            client.subscribe(self.topic(device_id, "$fw/checksum"))
+            client.subscribe(self.topic(device_id, "$implementation/ota/status"))
+
+    def on_message(self, client, userdata, msg):
+        device_id = msg.topic[len(self.base_topic):].split('/')[0]
+        payload = msg.payload.decode()
+        with self.lock:
+            if device_id not in self.state:
+                return
+            state = self.state[device_id]
+            if msg.topic.endswith('$fw/checksum'):
+                self.checksum[device_id] = payload
+                if payload == self.md5 and state in (Rollout.PUBLISHED, Rollout.UPDATING):
+                    self.finish(device_id, Rollout.DONE)
+                elif state == Rollout.UPDATING:
+                    # rebooted with the old firmware
+                    self.finish(device_id, Rollout.FAILED)
+            elif msg.topic.endswith('$implementation/ota/status') and state in (Rollout.PUBLISHED, Rollout.UPDATING):
+                status = int(payload.split()[0])
+                if status == 206:
+                    self.state[device_id] = Rollout.UPDATING
+                elif status == 304:
+                    self.finish(device_id, Rollout.DONE)
+                elif status >= 400:
+                    print("{}: {}".format(device_id, payload))
+                    self.finish(device_id, Rollout.FAILED)
+
+    def finish(self, device_id, state):
+        """ must be called with the lock """
+        self.state[device_id] = state
+        # remove the retained firmware, so it is not installed again
+        self.client.publish(self.topic(device_id, "$implementation/ota/firmware/" + self.md5), "", qos=1, retain=True)
+        print("{}: {}".format(device_id, state))
+
+    def waves(self):
+        devices = sorted(self.state.keys())
+        waves = [devices[:self.canary]]
+        for start in range(self.canary, len(devices), self.wave_size):
+            waves.append(devices[start:start + self.wave_size])
+        return [wave for wave in waves if wave]
+
+    def run_wave(self, number, wave):
+        with self.lock:
+            for device_id in wave:
+                if self.checksum.get(device_id) == self.md5:
+                    self.state[device_id] = Rollout.DONE
+                    print("{}: already up to date".format(device_id))
+                    continue
+                self.state[device_id] = Rollout.PUBLISHED
+                self.client.publish(self.topic(device_id, "$implementation/ota/firmware/" + self.md5),
+                                    self.firmware, qos=1, retain=True)
+        print("Wave {}: {} devices, waiting up to {} seconds".format(number, len(wave), self.timeout))
+
+        deadline = time.time() + self.timeout
+        while time.time() < deadline:
+            with self.lock:
+                if all(self.state[device_id] in (Rollout.DONE, Rollout.FAILED) for device_id in wave):
+                    break
+            time.sleep(1)
+
+        with self.lock:
+            for device_id in wave:
+                if self.state[device_id] not in (Rollout.DONE, Rollout.FAILED):
+                    print("{}: timeout".format(device_id))
+                    self.finish(device_id, Rollout.FAILED)
+            failed = sum(1 for device_id in wave if self.state[device_id] == Rollout.FAILED)
+        print("Wave {}: {} of {} failed".format(number, failed, len(wave)))
+        return (failed / len(wave)) <= self.failure_threshold
+
+    def run(self):
+        # wait a moment for the retained checksums
+        time.sleep(2)
+        for number, wave in enumerate(self.waves()):
+            if not self.run_wave(number, wave):
+                print("Too many failures, rollout stopped")
+                break
+        with self.lock:
+            for state in (Rollout.DONE, Rollout.FAILED, Rollout.PENDING):
+                devices = sorted(device_id for device_id in self.state if self.state[device_id] == state)
+                print("{} {}: {}".format(len(devices), state, " ".join(devices)))
+            return all(state == Rollout.DONE for state in self.state.values())
+
+
+def rollout(broker_host, broker_port, broker_username, broker_password, broker_ca_cert, base_topic, devices, firmware,
+            canary, wave_size, failure_threshold, timeout):
+    client = mqtt.Client()
+
+    # set username and password if given
+    if broker_username and broker_password:
+        client.username_pw_set(broker_username, broker_password)
+
+    if broker_ca_cert is not None:
+        client.tls_set(
+            ca_certs=broker_ca_cert
+        )
+
+    updater = Rollout(client, base_topic, devices, firmware, canary, wave_size, failure_threshold, timeout)
+    client.on_connect = updater.on_connect
+    client.on_message = updater.on_message
+
+    print("Connecting to mqtt broker {} on port {}".format(broker_host, broker_port))
+    client.connect(broker_host, broker_port, 60)
+    client.loop_start()
+    try:
+        success = updater.run()
+    finally:
+        client.loop_stop()
+        client.disconnect()
+    return success
+
+
 if __name__ == '__main__':
     import argparse
 
@@ -148,8 +290,18 @@ if __name__ == '__main__':
                         help='password used to authenticate with the mqtt broker')
     parser.add_argument('-t', '--base-topic',      type=base_topic_arg, required=False,
                         help='base topic of the homie devices on the broker', default="homie/")
-    parser.add_argument('-i', '--device-id',       type=str,            required=True,
-                        help='homie device id')
+    parser.add_argument('-i', '--device-id',       type=str,            action='append',
+                        help='homie device id, can be given several times for a rollout')
+    parser.add_argument('-f', '--device-list',     type=argparse.FileType('r'), required=False,
+                        help='file with one homie device id per line, for a rollout')
+    parser.add_argument('--canary',                type=int,            required=False,
+                        help='rollout: amount of devices, updated in the first wave', default=1)
+    parser.add_argument('--wave-size',             type=int,            required=False,
+                        help='rollout: amount of devices, updated in each following wave', default=10)
+    parser.add_argument('--failure-threshold',     type=float,          required=False,
+                        help='rollout: stop, when more than this fraction of a wave failed', default=0.1)
+    parser.add_argument('--wave-timeout',          type=int,            required=False,
+                        help='rollout: seconds to wait for a wave, should cover at least two wakes', default=1800)
     parser.add_argument('firmware', type=argparse.FileType('rb'),
                         help='path to the firmware to be sent to the device')
 
@@ -163,6 +315,16 @@ if __name__ == '__main__':
     # get and validate arguments
     args = parser.parse_args()
 
+    devices = list(args.device_id or [])
+    if args.device_list:
+        devices.extend(line.strip() for line in args.device_list if line.strip() and not line.startswith('#'))
+        args.device_list.close()
+    devices = sorted(set(devices))
+    if not devices:
+        parser.error("at least one device id is required (-i or -f)")
+    if args.canary < 1 or args.wave_size < 1:
+        parser.error("canary and wave size must be at least 1")
+
     # read the contents of firmware into buffer
     fw_buffer = args.firmware.read()
     args.firmware.close()
@@ -170,5 +332,11 @@ if __name__ == '__main__':
     firmware.extend(fw_buffer)
 
     # Invoke the business logic
-    main(args.broker_host, args.broker_port, args.broker_username,
-         args.broker_password, args.broker_tls_cacert, args.base_topic, args.device_id, firmware)
+    if len(devices) == 1:
+        main(args.broker_host, args.broker_port, args.broker_username,
+             args.broker_password, args.broker_tls_cacert, args.base_topic, devices[0], firmware)
+    else:
+        success = rollout(args.broker_host, args.broker_port, args.broker_username,
+                          args.broker_password, args.broker_tls_cacert, args.base_topic, devices, firmware,
+                          args.canary, args.wave_size, args.failure_threshold, args.wave_timeout)
+        sys.exit(0 if success else 1)
@@ -0,0 +1,222 @@
+/**
+ * @file replay.cpp
+ * @author your name (you@domain.com)
+ * @brief Run the control logic of the firmware against a recorded trace
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude -Ihost/sim host/replay/replay.cpp host/sim/HostSettings.cpp \
+ *      src/ControlLogic.cpp src/ControlTrace.cpp -o replay
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "ControlLogic.h"
+#include "ControlTrace.h"
+#include "HostSettings.h"
+
+#define DEFAULT_AWAKE_MODE1     350     /**< ms, only the moisture sensors are read */
+#define DEFAULT_AWAKE_MODE2     5000    /**< ms, MIN_TIME_RUNNING with WiFi and MQTT */
+
+/**
+ * @brief Compare the output with a golden file
+ * @return true, if both are equal
+ */
+static bool compareGolden(const std::vector<std::string>& output, const char* path) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "golden: cannot read " << path << std::endl;
+        return false;
+    }
+    std::string expected;
+    size_t line = 0;
+    while (std::getline(file, expected)) {
+        if ((line >= output.size()) || (output[line] != expected)) {
+            std::cerr << "golden: line " << (line + 1) << " differs" << std::endl
+                      << "  expected: " << expected << std::endl
+                      << "  actual:   " << ((line < output.size()) ? output[line] : "<missing>") << std::endl;
+            return false;
+        }
+        line++;
+    }
+    if (line != output.size()) {
+        std::cerr << "golden: " << (output.size() - line) << " additional lines, first: " << output[line] << std::endl;
+        return false;
+    }
+    std::cerr << "golden: ok (" << line << " lines)" << std::endl;
+    return true;
+}
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [-c config.json] [-q] [--awake-mode1 ms] [--awake-mode2 ms]" << std::endl
+              << "       [--golden file | --write-golden file] trace.csv" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    HostSettings_t settings;
+    long awakeMode1 = DEFAULT_AWAKE_MODE1;
+    long awakeMode2 = DEFAULT_AWAKE_MODE2;
+    const char* configPath = NULL;
+    const char* tracePath = NULL;
+    const char* goldenPath = NULL;
+    const char* writeGoldenPath = NULL;
+    bool quiet = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "-c") && hasValue) {
+            configPath = argv[++i];
+        } else if (argument == "-q") {
+            quiet = true;
+        } else if ((argument == "--awake-mode1") && hasValue) {
+            awakeMode1 = atol(argv[++i]);
+        } else if ((argument == "--awake-mode2") && hasValue) {
+            awakeMode2 = atol(argv[++i]);
+        } else if ((argument == "--golden") && hasValue) {
+            goldenPath = argv[++i];
+        } else if ((argument == "--write-golden") && hasValue) {
+            writeGoldenPath = argv[++i];
+        } else if ((argument[0] != '-') && (tracePath == NULL)) {
+            tracePath = argv[i];
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (tracePath == NULL) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string json;
+    if ((configPath != NULL) && !hostReadFile(configPath, json)) {
+        std::cerr << "cannot read " << configPath << std::endl;
+        return 2;
+    }
+    hostLoadSettings(json, settings);
+
+    std::ifstream trace(tracePath);
+    if (!trace) {
+        std::cerr << "cannot read " << tracePath << std::endl;
+        return 2;
+    }
+
+    /* a fresh controller, as after the first power on */
+    ControlState_t state;
+    memset(&state, 0, sizeof(state));
+    int moisture[MAX_PLANTS];
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        moisture[i] = 4095;
+    }
+    long solar = 0;
+
+    std::vector<std::string> output;
+    unsigned long wakes = 0;
+    unsigned long mode2Wakes = 0;
+    unsigned long pumpRuns = 0;
+    long long awakeMs = 0;
+    long pumpSeconds[MAX_PLANTS] = { 0 };
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string line;
+    TraceRecord_t record;
+    while (std::getline(trace, line)) {
+        if (!traceParse(line.c_str(), record)) {
+            continue;
+        }
+        /* values, that were not measured, keep the last known one */
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            if (record.moisture[i] != TRACE_UNKNOWN) {
+                moisture[i] = record.moisture[i];
+            }
+        }
+        if (record.solar != TRACE_UNKNOWN) {
+            solar = record.solar;
+        }
+
+        wakes++;
+        char decision[64];
+        if (!controlIsMode2Required(state, moisture, record.time)) {
+            awakeMs += awakeMode1;
+            snprintf(decision, sizeof(decision), "%ld %ld m1", (long) record.time, (long) record.boot);
+        } else {
+            mode2Wakes++;
+            state.deepSleepTime = settings.deepSleep;
+            uint32_t pumps = controlSelectPumps(state, settings.plants, moisture, solar, record.time,
+                                                controlPumpLimit(settings.pumpCurrent));
+            long awake = awakeMode2;
+            if (pumps != 0) {
+                std::string started;
+                for (int i = 0; i < MAX_PLANTS; i++) {
+                    if (pumps & (1UL << i)) {
+                        pumpSeconds[i] += settings.maxRuntime[i];
+                        pumpRuns++;
+                        started += (started.empty() ? "" : ",") + std::to_string(i);
+                    }
+                }
+                long pumpTime;
+                long waterTime = hostWaterTime(settings, pumps, HOST_PUMP_CURRENT, pumpTime);
+                if (waterTime > awake) {
+                    awake = waterTime;
+                }
+                snprintf(decision, sizeof(decision), "%ld %ld m2 pump=%s", (long) record.time, (long) record.boot,
+                         started.c_str());
+            } else {
+                snprintf(decision, sizeof(decision), "%ld %ld m2 pump=-", (long) record.time, (long) record.boot);
+            }
+            awakeMs += awake;
+        }
+        if (!quiet) {
+            output.push_back(decision);
+        }
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "wakes %lu", wakes);
+    output.push_back(summary);
+    snprintf(summary, sizeof(summary), "mode2 %lu", mode2Wakes);
+    output.push_back(summary);
+    snprintf(summary, sizeof(summary), "awake %lld.%03lld s", awakeMs / 1000, awakeMs % 1000);
+    output.push_back(summary);
+    snprintf(summary, sizeof(summary), "pumpruns %lu", pumpRuns);
+    output.push_back(summary);
+    std::string pumps = "pump";
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        pumps += " " + std::to_string(pumpSeconds[i]);
+    }
+    output.push_back(pumps + " s");
+
+    for (size_t i = 0; i < output.size(); i++) {
+        std::cout << output[i] << std::endl;
+    }
+
+    /* benchmark of the replay itself, not part of the golden output */
+    double elapsed = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cerr << "replayed " << wakes << " wakes in " << elapsed << " ms";
+    if (elapsed > 0) {
+        std::cerr << " (" << (long) (wakes / elapsed * 1000) << " wakes/s)";
+    }
+    std::cerr << std::endl;
+
+    if (writeGoldenPath != NULL) {
+        std::ofstream golden(writeGoldenPath);
+        for (size_t i = 0; i < output.size(); i++) {
+            golden << output[i] << std::endl;
+        }
+    }
+    if ((goldenPath != NULL) && !compareGolden(output, goldenPath)) {
+        return 1;
+    }
+    return 0;
+}
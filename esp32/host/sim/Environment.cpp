@@ -0,0 +1,146 @@
+/**
+ * @file Environment.cpp
+ * @author your name (you@domain.com)
+ * @brief Simulated greenhouse: soil, tank, sun and lipo
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Environment.h"
+#include <cmath>
+
+#define SECONDS_PER_DAY     86400.0
+#define SOUND_MM_PER_US     0.343
+#define LIPO_EMPTY_VOLT     3.3
+#define LIPO_FULL_VOLT      4.2
+
+void environmentDefaults(EnvironmentConfig_t& config) {
+    config.potVolume = 400;
+    config.initialMoisture = 0.7;
+    config.evaporation = 0.25;
+    config.temperatureMean = 20;
+    config.temperatureSwing = 6;
+    config.sunrise = 6;
+    config.sunset = 20;
+    config.pumpFlow = 8;
+    config.tankVolume = 20000;
+    config.tankHeight = 400;
+    config.sensorOffset = 50;
+    config.panelVoltage = 9.5;
+    config.lipoCapacity = 2000;
+    config.chargeCurrent = 250;
+    config.initialCharge = 0.8;
+    config.adcDry = 1000;
+    config.adcWet = 3500;
+    config.adcNoise = 25;
+    config.echoNoise = 20;
+}
+
+Environment::Environment(const EnvironmentConfig_t& config, unsigned int seed) : mConfig(config), mRandom(seed) {
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        mMoisture[i] = config.initialMoisture;
+    }
+    mTank = config.tankVolume;
+    mCharge = config.initialCharge;
+}
+
+double Environment::getSun(void) {
+    double hour = fmod(mTime, SECONDS_PER_DAY) / 3600.0;
+    if ((hour <= mConfig.sunrise) || (hour >= mConfig.sunset)) {
+        return 0;
+    }
+    return sin(M_PI * (hour - mConfig.sunrise) / (mConfig.sunset - mConfig.sunrise));
+}
+
+double Environment::getTemperature(void) {
+    /* warmest at 15:00 */
+    double hour = fmod(mTime, SECONDS_PER_DAY) / 3600.0;
+    return mConfig.temperatureMean + mConfig.temperatureSwing * cos(2 * M_PI * (hour - 15) / 24);
+}
+
+void Environment::advance(double seconds) {
+    double sun = getSun();
+    double temperature = getTemperature();
+
+    /* evaporation gets slower, the drier the soil is */
+    double rate = mConfig.evaporation / SECONDS_PER_DAY * (0.3 + 0.7 * sun) * (1 + 0.05 * (temperature - 20));
+    if (rate < 0) {
+        rate = 0;
+    }
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        mMoisture[i] -= rate * mMoisture[i] * seconds;
+    }
+
+    /* a full lipo takes no more charge */
+    double charge = mConfig.chargeCurrent * sun * seconds / 3600.0;
+    double space = (1 - mCharge) * mConfig.lipoCapacity;
+    if (charge > space) {
+        charge = space;
+    }
+    mCharged += charge;
+    mCharge += charge / mConfig.lipoCapacity;
+    mTime += seconds;
+}
+
+double Environment::toAdc(double volt, double multiplier) {
+    double adc = volt * 4095 / (3.3 * multiplier);
+    return (adc > 4095) ? 4095 : adc;
+}
+
+int Environment::getMoistureAdc(int plant) {
+    return mConfig.adcDry + (int) ((mConfig.adcWet - mConfig.adcDry) * mMoisture[plant]);
+}
+
+int Environment::readMoisture(int plant) {
+    std::normal_distribution<double> noise(0, mConfig.adcNoise);
+    int adc = getMoistureAdc(plant) + (int) noise(mRandom);
+    return (adc < 0) ? 0 : ((adc > 4095) ? 4095 : adc);
+}
+
+int Environment::readSolar(void) {
+    /* see SOLAR_VOLT() */
+    return (int) toAdc(getSun() * mConfig.panelVoltage, 4.0306);
+}
+
+int Environment::readLipo(void) {
+    /* see ADC_5V_TO_3V3() */
+    double volt = LIPO_EMPTY_VOLT + (LIPO_FULL_VOLT - LIPO_EMPTY_VOLT) * mCharge;
+    return (int) toAdc(volt, 1.7);
+}
+
+double Environment::getWaterDistance(void) {
+    return mConfig.sensorOffset + mConfig.tankHeight * (1 - mTank / mConfig.tankVolume);
+}
+
+long Environment::readEcho(void) {
+    std::normal_distribution<double> noise(0, mConfig.echoNoise);
+    return (long) (getWaterDistance() * 2 / SOUND_MM_PER_US + noise(mRandom));
+}
+
+double Environment::pump(int plant, double seconds) {
+    double water = mConfig.pumpFlow * seconds;
+    if (water > mTank) {
+        water = mTank;
+    }
+    mTank -= water;
+    mPumped += water;
+
+    /* the soil can not take more than saturation, the rest runs off */
+    double space = (1 - mMoisture[plant]) * mConfig.potVolume;
+    double absorbed = (water < space) ? water : space;
+    mMoisture[plant] += absorbed / mConfig.potVolume;
+    mAbsorbed += absorbed;
+    return water;
+}
+
+void Environment::consume(double milliAmpere, double milliseconds) {
+    double used = milliAmpere * milliseconds / 3600000.0;
+    mConsumed += used;
+    mCharge -= used / mConfig.lipoCapacity;
+    if (mCharge < 0) {
+        mCharge = 0;
+    }
+}
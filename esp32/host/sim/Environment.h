@@ -0,0 +1,116 @@
+/**
+ * @file Environment.h
+ * @author your name (you@domain.com)
+ * @brief Simulated greenhouse: soil, tank, sun and lipo
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The sensors return the raw values, the firmware would read (ADC, echo duration),
+ * so the control logic can run unchanged against the simulation.
+ * Time is given in seconds since midnight of the first day.
+ */
+
+#ifndef ENVIRONMENT_H
+#define ENVIRONMENT_H
+
+#include <random>
+#include "ControllerConfiguration.h"
+
+typedef struct EnvironmentConfig_t {
+    double potVolume;           /**< ml of water, the soil of one pot holds when saturated */
+    double initialMoisture;     /**< 0..1 of saturation */
+    double evaporation;         /**< 0..1 of saturation per day (20 °C, full sun) */
+    double temperatureMean;     /**< °C */
+    double temperatureSwing;    /**< °C between the mean and the maximum */
+    double sunrise;             /**< hour */
+    double sunset;              /**< hour */
+    double pumpFlow;            /**< ml/s */
+    double tankVolume;          /**< ml */
+    double tankHeight;          /**< mm between empty and full */
+    double sensorOffset;        /**< mm between the ultrasonic sensor and the full water level */
+    double panelVoltage;        /**< V of the solar panel in full sun */
+    double lipoCapacity;        /**< mAh */
+    double chargeCurrent;       /**< mA in full sun */
+    double initialCharge;       /**< 0..1 */
+    int adcDry;                 /**< Moisture sensor in dry soil */
+    int adcWet;                 /**< Moisture sensor in saturated soil */
+    int adcNoise;               /**< Standard deviation of the moisture sensor */
+    double echoNoise;           /**< us, standard deviation of the ultrasonic sensor */
+} EnvironmentConfig_t;
+
+/**
+ * @brief Defaults: a small greenhouse with 7 pots and a 20 l tank
+ */
+void environmentDefaults(EnvironmentConfig_t& config);
+
+class Environment {
+    private:
+        EnvironmentConfig_t mConfig;
+        std::mt19937 mRandom;
+        double mMoisture[MAX_PLANTS];   /**< 0..1 of saturation */
+        double mTank;                   /**< ml */
+        double mCharge;                 /**< 0..1 */
+        double mTime = 0;
+
+        /* statistics */
+        double mPumped = 0;
+        double mAbsorbed = 0;
+        double mConsumed = 0;           /**< mAh */
+        double mCharged = 0;            /**< mAh */
+
+        static double toAdc(double volt, double multiplier);
+
+    public:
+        Environment(const EnvironmentConfig_t& config, unsigned int seed);
+
+        double getTime(void) { return mTime; }
+
+        /**
+         * @brief Advance the time, evaporate and charge
+         * @param seconds  should be some minutes at most, the model is integrated step by step
+         */
+        void advance(double seconds);
+
+        /**
+         * @brief Sun intensity 0..1
+         */
+        double getSun(void);
+        double getTemperature(void);
+
+        /* sensors, as read by the firmware */
+        int readMoisture(int plant);
+        int readSolar(void);
+        int readLipo(void);
+        long readEcho(void);
+
+        /**
+         * @brief Noise free moisture sensor value
+         */
+        int getMoistureAdc(int plant);
+
+        /**
+         * @brief Noise free distance (mm) of the ultrasonic sensor to the water
+         */
+        double getWaterDistance(void);
+
+        /**
+         * @brief Run a pump, the water is taken from the tank
+         * @return double  ml, that reached the pot
+         */
+        double pump(int plant, double seconds);
+
+        /**
+         * @brief Drain the lipo
+         */
+        void consume(double milliAmpere, double milliseconds);
+
+        double getPumped(void) { return mPumped; }
+        double getAbsorbed(void) { return mAbsorbed; }
+        double getConsumed(void) { return mConsumed; }
+        double getCharged(void) { return mCharged; }
+        double getCharge(void) { return mCharge; }
+        double getTank(void) { return mTank; }
+};
+
+#endif
@@ -0,0 +1,116 @@
+/**
+ * @file HostSettings.cpp
+ * @author your name (you@domain.com)
+ * @brief Homie settings of the firmware, read on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "HostSettings.h"
+#include "TelemetryMemory.h"
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+long hostSetting(const std::string& json, const std::string& key, long defaultValue) {
+    size_t position = json.find("\"" + key + "\"");
+    if (position == std::string::npos) {
+        return defaultValue;
+    }
+    position = json.find(':', position + key.size() + 2);
+    if (position == std::string::npos) {
+        return defaultValue;
+    }
+    const char* value = json.c_str() + position + 1;
+    while ((*value == ' ') || (*value == '\t') || (*value == '\n') || (*value == '\r')) {
+        value++;
+    }
+    if (strncmp(value, "true", 4) == 0) {
+        return 1;
+    }
+    if (strncmp(value, "false", 5) == 0) {
+        return 0;
+    }
+    char* end;
+    long result = strtol(value, &end, 10);
+    return (end == value) ? defaultValue : result;
+}
+
+void hostLoadSettings(const std::string& json, HostSettings_t& settings) {
+    settings.deepSleep = hostSetting(json, "deepsleep", 300000);
+    settings.nightSleep = hostSetting(json, "nightsleep", 0);
+    settings.pumpDeepSleep = hostSetting(json, "pumpdeepsleep", 60000);
+    settings.homieWakes = hostSetting(json, "homiewakes", 12);
+    settings.pumpCurrent = hostSetting(json, "pumpcurrent", 800);
+    settings.maxSilence = hostSetting(json, "maxsilence", TELEMETRY_SILENCE_DEFAULT);
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        std::string plant = std::to_string(i);
+        settings.plants[i].sensorDry = hostSetting(json, "moistdry" + plant, DEACTIVATED_PLANT);
+        settings.plants[i].cooldown = hostSetting(json, "cooldownpump" + plant, 20);
+        settings.plants[i].onlyWhenLowLight = hostSetting(json, "onlyWhenLowLightZ" + plant, 1) != 0;
+        settings.maxRuntime[i] = hostSetting(json, "maxruntime" + plant, 30);
+        settings.plants[i].sensorExit = controlExitThreshold(settings.plants[i].sensorDry);
+        settings.plants[i].runtime = settings.maxRuntime[i];
+        settings.plants[i].soakTime = settings.pumpDeepSleep / 1000;
+    }
+}
+
+long hostWaterTime(const HostSettings_t& settings, uint32_t pumps, long current, long& pumpTime) {
+    long stop[MAX_PLANTS] = { 0 };      /**< ms, 0 while the pump waits */
+    uint32_t pending = pumps;
+    uint32_t running = 0;
+    long now = 0;
+    pumpTime = 0;
+    while (pending != 0) {
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            uint32_t mask = (1UL << i);
+            if (!(pending & mask)) {
+                continue;
+            }
+            int count = __builtin_popcount(running);
+            bool fits = (running == 0) || ((settings.pumpCurrent > 0) && ((count + 1) * current <= settings.pumpCurrent));
+            if (!fits) {
+                continue;
+            }
+            pending &= ~mask;
+            running |= mask;
+            stop[i] = now + settings.maxRuntime[i] * 1000;
+            pumpTime += settings.maxRuntime[i] * 1000;
+        }
+        /* continue with the next stopped pump */
+        long next = -1;
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            if ((running & (1UL << i)) && ((next < 0) || (stop[i] < next))) {
+                next = stop[i];
+            }
+        }
+        now = next;
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            if ((running & (1UL << i)) && (stop[i] <= now)) {
+                running &= ~(1UL << i);
+            }
+        }
+    }
+    long end = now;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        if ((pumps & (1UL << i)) && (stop[i] > end)) {
+            end = stop[i];
+        }
+    }
+    return end;
+}
+
+bool hostReadFile(const char* path, std::string& content) {
+    std::ifstream file(path);
+    if (!file) {
+        return false;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file HostSettings.h
+ * @author your name (you@domain.com)
+ * @brief Homie settings of the firmware, read on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The settings are taken from the Homie configuration (JSON), missing ones
+ * get the same defaults as in the firmware (systemInit() and Plant::init()).
+ */
+
+#ifndef HOST_SETTINGS_H
+#define HOST_SETTINGS_H
+
+#include <stdint.h>
+#include <string>
+#include "ControlLogic.h"
+
+#define HOST_PUMP_CURRENT   350     /**< mA of one pump, PUMP_DEFAULT_CURRENT of the firmware */
+
+typedef struct HostSettings_t {
+    long deepSleep;                     /**< ms */
+    long nightSleep;                    /**< ms, 0 uses deepSleep */
+    long pumpDeepSleep;                 /**< ms, sleep after a pump was started */
+    long homieWakes;                    /**< every n-th wake starts Homie */
+    long pumpCurrent;                   /**< mA of all pumps running at once, 0 runs one pump per wake */
+    long maxSilence;                    /**< s, an unchanged value is published again (deadbands use the defaults) */
+    PlantControl_t plants[MAX_PLANTS];
+    long maxRuntime[MAX_PLANTS];        /**< s */
+} HostSettings_t;
+
+/**
+ * @brief Find a setting in the Homie configuration
+ * Only numbers and booleans are supported, that is all the control logic needs.
+ */
+long hostSetting(const std::string& json, const std::string& key, long defaultValue);
+
+/**
+ * @brief Fill all settings from the Homie configuration
+ * @param json  content of the configuration, empty for the defaults
+ */
+void hostLoadSettings(const std::string& json, HostSettings_t& settings);
+
+/**
+ * @brief Run the started pumps like the pump task of the firmware
+ * A pump starts, when it fits into the current budget next to the running ones;
+ * the first pump always runs.
+ *
+ * @param pumps         bit mask of the started pumps
+ * @param current       mA of one pump
+ * @param pumpTime      sum of the runtime of all pumps (ms)
+ * @return long         ms until the last pump stopped
+ */
+long hostWaterTime(const HostSettings_t& settings, uint32_t pumps, long current, long& pumpTime);
+
+/**
+ * @brief Read a whole file
+ * @return false, if the file can not be read
+ */
+bool hostReadFile(const char* path, std::string& content);
+
+#endif
@@ -0,0 +1,172 @@
+/**
+ * @file SimController.cpp
+ * @author your name (you@domain.com)
+ * @brief Wake sequence of the firmware on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SimController.h"
+#include <cmath>
+#include <cstring>
+
+void powerProfileDefaults(PowerProfile_t& profile) {
+    profile.sleepCurrent = 0.15;
+    profile.cpuCurrent = 45;
+    profile.wifiTxCurrent = 190;
+    profile.wifiRxCurrent = 100;
+    profile.wifiTxShare = 0.2;
+    profile.pumpCurrent = 350;
+    profile.mode1Time = 350;
+    profile.fastPathTime = 1500;
+    profile.probeTime = 200;
+    profile.homieTime = 5000;
+}
+
+void powerProfileLoad(const std::string& json, PowerProfile_t& profile) {
+    profile.sleepCurrent = hostSetting(json, "sleep_ua", profile.sleepCurrent * 1000) / 1000.0;
+    profile.cpuCurrent = hostSetting(json, "cpu_ma", profile.cpuCurrent);
+    profile.wifiTxCurrent = hostSetting(json, "wifi_tx_ma", profile.wifiTxCurrent);
+    profile.wifiRxCurrent = hostSetting(json, "wifi_rx_ma", profile.wifiRxCurrent);
+    profile.wifiTxShare = hostSetting(json, "wifi_tx_percent", profile.wifiTxShare * 100) / 100.0;
+    profile.pumpCurrent = hostSetting(json, "pump_ma", profile.pumpCurrent);
+    profile.mode1Time = hostSetting(json, "mode1_ms", profile.mode1Time);
+    profile.fastPathTime = hostSetting(json, "fastpath_ms", profile.fastPathTime);
+    profile.probeTime = hostSetting(json, "probe_ms", profile.probeTime);
+    profile.homieTime = hostSetting(json, "homie_ms", profile.homieTime);
+}
+
+SimController::SimController(const HostSettings_t& settings, const PowerProfile_t& profile)
+    : mSettings(settings), mProfile(profile) {
+    memset(&mState, 0, sizeof(mState));
+    memset(&mTelemetry, 0, sizeof(mTelemetry));
+    telemetryParseDeadbands("", mTelemetry.deadband);
+    mTelemetry.maxSilence = settings.maxSilence;
+}
+
+void SimController::consume(Environment& environment, PowerPhase_t phase, double milliAmpere, double milliseconds) {
+    environment.consume(milliAmpere, milliseconds);
+    mEnergy[phase] += milliAmpere * milliseconds / 3600000.0;
+}
+
+void SimController::sleep(Environment& environment, long milliseconds) {
+    consume(environment, PHASE_SLEEP, mProfile.sleepCurrent, milliseconds);
+}
+
+long SimController::sleepTime(Environment& environment, bool pumpStarted) {
+    long sleep = mSettings.deepSleep;
+    if (pumpStarted) {
+        /* check the moisture again, after the water reached the sensor */
+        sleep = mSettings.pumpDeepSleep;
+    } else if ((mSettings.nightSleep > 0) && (SOLAR_VOLT(environment.readSolar()) < MINIMUM_SOLAR_VOLT)) {
+        sleep = mSettings.nightSleep;
+    }
+    double lipo = ADC_5V_TO_3V3(environment.readLipo());
+    if ((lipo < MINIMUM_LIPO_VOLT) && (lipo > NO_LIPO_VOLT)) {
+        sleep *= EMPTY_LIPO_MULTIPL;
+    }
+    return sleep;
+}
+
+bool SimController::publishTelemetry(Environment& environment, const int moisture[MAX_PLANTS]) {
+    /* 0 marks a value, that was never published */
+    uint32_t now = (uint32_t) environment.getTime() + 1;
+    long temperature = lround(environment.getTemperature() * 100);
+    int lipo = environment.readLipo();
+    int solar = environment.readSolar();
+    long values[TELEMETRY_PROPERTIES];
+    bool measured[TELEMETRY_PROPERTIES] = { false };
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        values[TELEMETRY_MOIST + i] = mCalibration.getPercent(i, moisture[i]);
+        measured[TELEMETRY_MOIST + i] = true;
+    }
+    /* the same conversions as publishSample() of the firmware */
+    values[TELEMETRY_TEMP] = temperature;
+    values[TELEMETRY_TEMP_CONTROL] = temperature;
+    /* the estimated level is taken noise free, only its change is compared */
+    values[TELEMETRY_WATER_REMAINING] = -lround(environment.getWaterDistance());
+    values[TELEMETRY_LIPO_PERCENT] = 100 * lipo / 4095;
+    values[TELEMETRY_LIPO_VOLT] = lround(ADC_5V_TO_3V3(lipo) * 100);
+    values[TELEMETRY_SOLAR_PERCENT] = 100 * solar / 4095;
+    values[TELEMETRY_SOLAR_VOLT] = lround(SOLAR_VOLT(solar) * 100);
+    measured[TELEMETRY_TEMP] = measured[TELEMETRY_TEMP_CONTROL] = measured[TELEMETRY_WATER_REMAINING] = true;
+    measured[TELEMETRY_LIPO_PERCENT] = measured[TELEMETRY_LIPO_VOLT] = true;
+    measured[TELEMETRY_SOLAR_PERCENT] = measured[TELEMETRY_SOLAR_VOLT] = true;
+
+    bool due = false;
+    for (int i = 0; i < TELEMETRY_PROPERTIES; i++) {
+        TelemetryProperty_t property = (TelemetryProperty_t) i;
+        if (measured[i] && telemetryIsDue(mTelemetry, property, values[i], now)) {
+            telemetryRemember(mTelemetry, property, values[i], now);
+            due = true;
+        }
+    }
+    return due;
+}
+
+WakeReport_t SimController::wake(Environment& environment) {
+    WakeReport_t report;
+    report.type = WAKE_NOP;
+    report.pumps = 0;
+    report.pumpTime = 0;
+    report.awake = mProfile.mode1Time;
+
+    /* mode1 */
+    int moisture[MAX_PLANTS];
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        moisture[i] = environment.readMoisture(i);
+    }
+    consume(environment, PHASE_SENSE, mProfile.cpuCurrent, mProfile.mode1Time);
+    double wifiCurrent = mProfile.wifiTxShare * mProfile.wifiTxCurrent + (1 - mProfile.wifiTxShare) * mProfile.wifiRxCurrent;
+
+    bool fastPathEnabled = mFastPathStored && (mSettings.homieWakes > 0);
+    bool homieDue = false;
+    if (fastPathEnabled) {
+        mWakesSinceHomie++;
+        homieDue = (mWakesSinceHomie >= mSettings.homieWakes);
+    }
+
+    long now = (long) environment.getTime();
+    if (controlIsMode2Required(mState, moisture, now) || homieDue) {
+        report.type = WAKE_HOMIE;
+        mState.deepSleepTime = mSettings.deepSleep;
+        mFastPathStored = true;
+        mWakesSinceHomie = 0;
+
+        report.pumps = controlSelectPumps(mState, mSettings.plants, moisture, environment.readSolar(), now,
+                                          controlPumpLimit(mSettings.pumpCurrent));
+        long wifiTime = mProfile.homieTime;
+        if (report.pumps != 0) {
+            for (int i = 0; i < MAX_PLANTS; i++) {
+                if (report.pumps & (1UL << i)) {
+                    environment.pump(i, mSettings.maxRuntime[i]);
+                }
+            }
+            long waterTime = hostWaterTime(mSettings, report.pumps, (long) mProfile.pumpCurrent, report.pumpTime);
+            consume(environment, PHASE_PUMP, mProfile.pumpCurrent, report.pumpTime);
+            /* the controller stays awake, until the last pump is switched off */
+            if (waterTime > wifiTime) {
+                wifiTime = waterTime;
+            }
+        }
+        consume(environment, PHASE_WIFI, wifiCurrent, wifiTime);
+        report.awake += wifiTime;
+        publishTelemetry(environment, moisture);
+    } else if (fastPathEnabled) {
+        if (publishTelemetry(environment, moisture)) {
+            report.type = WAKE_FASTPATH;
+            consume(environment, PHASE_WIFI, wifiCurrent, mProfile.fastPathTime);
+            report.awake += mProfile.fastPathTime;
+        } else {
+            /* every value within its deadband: the WiFi stays off */
+            consume(environment, PHASE_SENSE, mProfile.cpuCurrent, mProfile.probeTime);
+            report.awake += mProfile.probeTime;
+        }
+    }
+
+    report.sleep = sleepTime(environment, report.pumps != 0);
+    return report;
+}
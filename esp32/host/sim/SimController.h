@@ -0,0 +1,110 @@
+/**
+ * @file SimController.h
+ * @author your name (you@domain.com)
+ * @brief Wake sequence of the firmware on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Follows setup() of the firmware: mode1 (moisture), then either mode2 (Homie,
+ * control logic and pump), the fast path or directly back to sleep.
+ * The decisions are made by ControlLogic.cpp, the same code as on the controller.
+ */
+
+#ifndef SIM_CONTROLLER_H
+#define SIM_CONTROLLER_H
+
+#include <string>
+#include "ControlLogic.h"
+#include "MoistureCalibration.h"
+#include "TelemetryMemory.h"
+#include "Environment.h"
+#include "HostSettings.h"
+
+typedef struct PowerProfile_t {
+    double sleepCurrent;    /**< mA in deep sleep */
+    double cpuCurrent;      /**< mA, sensors powered, WiFi off */
+    double wifiTxCurrent;   /**< mA while sending */
+    double wifiRxCurrent;   /**< mA while receiving or listening */
+    double wifiTxShare;     /**< 0..1 of the WiFi time spent sending */
+    double pumpCurrent;     /**< mA of one running pump */
+    long mode1Time;         /**< ms, reading the moisture sensors */
+    long fastPathTime;      /**< ms with WiFi, publishing without Homie */
+    long probeTime;         /**< ms, waiting for the remaining sensors, when the fast path has nothing to publish */
+    long homieTime;         /**< ms with WiFi, Homie bootstrap and publishing */
+} PowerProfile_t;
+
+/**
+ * @brief Measured on the controller with the default settings
+ */
+void powerProfileDefaults(PowerProfile_t& profile);
+
+/**
+ * @brief Overwrite the defaults with a profile (JSON)
+ * Keys: sleep_ua, cpu_ma, wifi_tx_ma, wifi_rx_ma, wifi_tx_percent, pump_ma, mode1_ms, fastpath_ms, probe_ms, homie_ms
+ */
+void powerProfileLoad(const std::string& json, PowerProfile_t& profile);
+
+typedef enum PowerPhase_t {
+    PHASE_SLEEP = 0,
+    PHASE_SENSE,    /**< mode1, WiFi off */
+    PHASE_WIFI,
+    PHASE_PUMP,
+    PHASE_COUNT
+} PowerPhase_t;
+
+typedef enum WakeType_t {
+    WAKE_NOP = 0,   /**< mode1 only, or every value within its deadband */
+    WAKE_FASTPATH,
+    WAKE_HOMIE      /**< mode2 */
+} WakeType_t;
+
+typedef struct WakeReport_t {
+    WakeType_t type;
+    uint32_t pumps; /**< bit mask of the started pumps */
+    long awake;     /**< ms */
+    long pumpTime;  /**< ms, sum of all pumps */
+    long sleep;     /**< ms until the next wake */
+} WakeReport_t;
+
+class SimController {
+    private:
+        HostSettings_t mSettings;
+        PowerProfile_t mProfile;
+        ControlState_t mState;
+        bool mFastPathStored = false;
+        long mWakesSinceHomie = 0;
+        TelemetryMemory_t mTelemetry;           /**< Last published values, like the RTC memory of the firmware */
+        MoistureCalibration mCalibration;       /**< Uncalibrated, percent of the full ADC range */
+        double mEnergy[PHASE_COUNT] = { 0 };   /**< mAh */
+
+        long sleepTime(Environment& environment, bool pumpStarted);
+
+        /**
+         * @brief Publish the values of this wake, that left their deadband (TelemetryMemory.cpp)
+         * @return true, if a value was due
+         */
+        bool publishTelemetry(Environment& environment, const int moisture[MAX_PLANTS]);
+        void consume(Environment& environment, PowerPhase_t phase, double milliAmpere, double milliseconds);
+
+    public:
+        SimController(const HostSettings_t& settings, const PowerProfile_t& profile);
+
+        /**
+         * @brief Run one wake against the environment
+         * The pump water and the energy of the wake are applied, the sleep is not.
+         */
+        WakeReport_t wake(Environment& environment);
+
+        /**
+         * @brief Apply the deep sleep current (the time is advanced by the caller)
+         */
+        void sleep(Environment& environment, long milliseconds);
+
+        /**
+         * @brief Used energy (mAh) of one phase since the start
+         */
+        double getEnergy(PowerPhase_t phase) { return mEnergy[phase]; }
+};
+
+#endif
@@ -0,0 +1,98 @@
+/**
+ * @file Simulation.cpp
+ * @author your name (you@domain.com)
+ * @brief Closed loop of the simulated controller and the environment
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "Simulation.h"
+#include <cstring>
+
+/**
+ * @brief History record of a wake, with the noise free values of the environment
+ */
+static HistoryRecord_t historyRecord(Environment& environment, const WakeReport_t& report) {
+    static const uint8_t WAKES[] = { HISTORY_WAKE_NOP, HISTORY_WAKE_FASTPATH, HISTORY_WAKE_HOMIE };
+    HistoryRecord_t record;
+    historyClear(record);
+    record.time = (uint32_t) environment.getTime();
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        record.moisture[i] = environment.getMoistureAdc(i);
+    }
+    record.wake = WAKES[report.type];
+    if (report.type != WAKE_NOP) {
+        /* mode1 only reads the moisture */
+        record.temperature[0] = (int16_t) (environment.getTemperature() * 100);
+        record.water = (uint16_t) environment.getWaterDistance();
+        record.lipo = environment.readLipo();
+        record.solar = environment.readSolar();
+    }
+    record.pumps = (uint8_t) report.pumps;
+    long awake = report.awake / 100;
+    record.awake = (awake < 255) ? awake : 255;
+    historySeal(record);
+    return record;
+}
+
+SimulationResult_t simulate(Environment& environment, SimController& controller,
+                            const HostSettings_t& settings, double days, std::ostream* csv,
+                            std::vector<HistoryRecord_t>* history) {
+    SimulationResult_t result;
+    memset(&result, 0, sizeof(result));
+    double nextSample = environment.getTime();
+    double end = environment.getTime() + days * 86400;
+
+    if (csv != NULL) {
+        *csv << "hour,sun,temperature,tank,charge";
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            *csv << ",moist" << i;
+        }
+        *csv << std::endl;
+    }
+
+    while (environment.getTime() < end) {
+        WakeReport_t report = controller.wake(environment);
+        result.wakes[report.type]++;
+        if (history != NULL) {
+            /* the wake does not advance the time */
+            history->push_back(historyRecord(environment, report));
+        }
+        result.awakeSeconds += report.awake / 1000.0;
+        if (report.pumps != 0) {
+            result.pumpRuns += __builtin_popcount(report.pumps);
+            result.pumpSeconds += report.pumpTime / 1000.0;
+        }
+
+        long sleep = (report.sleep < SIM_MIN_SLEEP) ? SIM_MIN_SLEEP : report.sleep;
+        controller.sleep(environment, sleep);
+        double remaining = (report.awake + sleep) / 1000.0;
+        while (remaining > 0) {
+            double step = (remaining > SIM_STEP) ? SIM_STEP : remaining;
+            for (int i = 0; i < MAX_PLANTS; i++) {
+                long dry = settings.plants[i].sensorDry;
+                if ((dry != DEACTIVATED_PLANT) && (environment.getMoistureAdc(i) < dry)) {
+                    result.belowDry[i] += step;
+                }
+            }
+            environment.advance(step);
+            remaining -= step;
+
+            if ((csv != NULL) && (environment.getTime() >= nextSample)) {
+                *csv << (long) (environment.getTime() / 3600) << "," << environment.getSun() << ","
+                     << environment.getTemperature() << "," << (long) environment.getTank() << ","
+                     << environment.getCharge();
+                for (int i = 0; i < MAX_PLANTS; i++) {
+                    *csv << "," << environment.getMoistureAdc(i);
+                }
+                *csv << std::endl;
+                nextSample += 3600;
+            }
+        }
+    }
+    result.days = days;
+    return result;
+}
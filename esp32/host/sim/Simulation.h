@@ -0,0 +1,44 @@
+/**
+ * @file Simulation.h
+ * @author your name (you@domain.com)
+ * @brief Closed loop of the simulated controller and the environment
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+#include <ostream>
+#include <vector>
+#include "Environment.h"
+#include "HistoryFormat.h"
+#include "HostSettings.h"
+#include "SimController.h"
+
+#define SIM_STEP            300     /**< s, integration step of the environment while sleeping */
+#define SIM_MIN_SLEEP       1000    /**< ms, deepsleep 0 keeps the controller awake */
+
+typedef struct SimulationResult_t {
+    double days;
+    unsigned long wakes[WAKE_HOMIE + 1];    /**< per WakeType_t */
+    unsigned long pumpRuns;
+    double pumpSeconds;
+    double awakeSeconds;
+    double belowDry[MAX_PLANTS];            /**< s, the plant was below moistdry */
+} SimulationResult_t;
+
+/**
+ * @brief Run wake and sleep cycles, until the given time is reached
+ *
+ * @param csv       hourly values of the environment, NULL if not needed
+ * @param history   one record per wake, as the firmware writes it into the flash; NULL if not needed
+ */
+SimulationResult_t simulate(Environment& environment, SimController& controller,
+                            const HostSettings_t& settings, double days, std::ostream* csv,
+                            std::vector<HistoryRecord_t>* history = NULL);
+
+#endif
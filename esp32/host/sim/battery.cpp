@@ -0,0 +1,174 @@
+/**
+ * @file battery.cpp
+ * @author your name (you@domain.com)
+ * @brief Battery life estimation from the measured awake time and current per phase
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude -Ihost/sim host/sim/battery.cpp host/sim/Simulation.cpp host/sim/Environment.cpp \
+ *      host/sim/SimController.cpp host/sim/HostSettings.cpp src/ControlLogic.cpp src/HistoryFormat.cpp \
+ *      src/TelemetryMemory.cpp src/MoistureCalibration.cpp -o battery
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "Environment.h"
+#include "HostSettings.h"
+#include "SimController.h"
+#include "Simulation.h"
+
+#define DEFAULT_MAX_LOSS    0.5     /**< days of autonomy, that may be lost against the baseline */
+#define ESTIMATE_RUNS       32      /**< Simulations with a different sensor noise, that are averaged */
+
+typedef struct Estimate_t {
+    double phase[PHASE_COUNT];  /**< mAh/day */
+    double consumed;            /**< mAh/day */
+    double harvested;           /**< mAh/day */
+    double awake;               /**< s/day */
+} Estimate_t;
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [-c config.json] [-p profile.json] [--days n] [--solar factor] [--capacity mAh]" << std::endl
+              << "       [--baseline file | --write-baseline file] [--max-loss days]" << std::endl;
+}
+
+static Estimate_t estimate(const EnvironmentConfig_t& config, const HostSettings_t& settings,
+                           const PowerProfile_t& profile, double days) {
+    Estimate_t estimate;
+    memset(&estimate, 0, sizeof(estimate));
+    /* the pump wakes depend on the sensor noise: average several runs */
+    for (unsigned int seed = 1; seed <= ESTIMATE_RUNS; seed++) {
+        Environment environment(config, seed);
+        SimController controller(settings, profile);
+        SimulationResult_t result = simulate(environment, controller, settings, days, NULL);
+        for (int i = 0; i < PHASE_COUNT; i++) {
+            double phase = controller.getEnergy((PowerPhase_t) i) / days / ESTIMATE_RUNS;
+            estimate.phase[i] += phase;
+            estimate.consumed += phase;
+        }
+        estimate.harvested += environment.getCharged() / days / ESTIMATE_RUNS;
+        estimate.awake += result.awakeSeconds / days / ESTIMATE_RUNS;
+    }
+    return estimate;
+}
+
+int main(int argc, char** argv) {
+    const char* configPath = NULL;
+    const char* profilePath = NULL;
+    const char* baselinePath = NULL;
+    const char* writeBaselinePath = NULL;
+    double days = 14;
+    double solar = 1;
+    double maxLoss = DEFAULT_MAX_LOSS;
+    EnvironmentConfig_t config;
+    environmentDefaults(config);
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "-c") && hasValue) {
+            configPath = argv[++i];
+        } else if ((argument == "-p") && hasValue) {
+            profilePath = argv[++i];
+        } else if ((argument == "--days") && hasValue) {
+            days = atof(argv[++i]);
+        } else if ((argument == "--solar") && hasValue) {
+            solar = atof(argv[++i]);
+        } else if ((argument == "--capacity") && hasValue) {
+            config.lipoCapacity = atof(argv[++i]);
+        } else if ((argument == "--baseline") && hasValue) {
+            baselinePath = argv[++i];
+        } else if ((argument == "--write-baseline") && hasValue) {
+            writeBaselinePath = argv[++i];
+        } else if ((argument == "--max-loss") && hasValue) {
+            maxLoss = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (days <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    std::string json;
+    if ((configPath != NULL) && !hostReadFile(configPath, json)) {
+        std::cerr << "cannot read " << configPath << std::endl;
+        return 2;
+    }
+    HostSettings_t settings;
+    hostLoadSettings(json, settings);
+    PowerProfile_t profile;
+    powerProfileDefaults(profile);
+    if (profilePath != NULL) {
+        if (!hostReadFile(profilePath, json)) {
+            std::cerr << "cannot read " << profilePath << std::endl;
+            return 2;
+        }
+        powerProfileLoad(json, profile);
+    }
+
+    /* the harvest is only limited by the capacity, when the lipo is full: start half charged */
+    config.initialCharge = 0.5;
+    config.panelVoltage *= solar;
+    config.chargeCurrent *= solar;
+    Estimate_t sunny = estimate(config, settings, profile, days);
+
+    /* without sun the controller uses the night and empty lipo settings */
+    config.panelVoltage = 0;
+    config.chargeCurrent = 0;
+    Estimate_t dark = estimate(config, settings, profile, days);
+    double darkAutonomy = config.lipoCapacity / dark.consumed;
+
+    static const char* phaseNames[PHASE_COUNT] = { "sleep", "sense", "wifi", "pump" };
+    printf("awake %.1f s/day\n", sunny.awake);
+    for (int i = 0; i < PHASE_COUNT; i++) {
+        printf("%s %.2f mAh/day\n", phaseNames[i], sunny.phase[i]);
+    }
+    printf("consumed %.2f mAh/day\n", sunny.consumed);
+    printf("harvested %.2f mAh/day (solar %.2f)\n", sunny.harvested, solar);
+    double net = sunny.consumed - sunny.harvested;
+    if (net > 0) {
+        printf("autonomy %.1f days\n", config.lipoCapacity / net);
+    } else {
+        printf("autonomy unlimited\n");
+    }
+    printf("autonomy without sun %.1f days (%.2f mAh/day, %.0f mAh)\n", darkAutonomy, dark.consumed,
+           config.lipoCapacity);
+
+    if (writeBaselinePath != NULL) {
+        FILE* baseline = fopen(writeBaselinePath, "w");
+        if (baseline == NULL) {
+            std::cerr << "cannot write " << writeBaselinePath << std::endl;
+            return 2;
+        }
+        fprintf(baseline, "%.2f\n", darkAutonomy);
+        fclose(baseline);
+    }
+    if (baselinePath != NULL) {
+        FILE* baseline = fopen(baselinePath, "r");
+        double expected;
+        if ((baseline == NULL) || (fscanf(baseline, "%lf", &expected) != 1)) {
+            std::cerr << "cannot read " << baselinePath << std::endl;
+            if (baseline != NULL) {
+                fclose(baseline);
+            }
+            return 2;
+        }
+        fclose(baseline);
+        double loss = expected - darkAutonomy;
+        printf("baseline %.1f days, change %+.1f days\n", expected, -loss);
+        if (loss > maxLoss) {
+            std::cerr << "regression: " << loss << " battery days lost (allowed " << maxLoss << ")" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * @file simulator.cpp
+ * @author your name (you@domain.com)
+ * @brief Closed loop simulation of the control logic in a simulated greenhouse
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude -Ihost/sim host/sim/simulator.cpp host/sim/Simulation.cpp host/sim/Environment.cpp \
+ *      host/sim/SimController.cpp host/sim/HostSettings.cpp src/ControlLogic.cpp src/HistoryFormat.cpp \
+ *      src/TelemetryMemory.cpp src/MoistureCalibration.cpp -o simulator
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "Environment.h"
+#include "HostSettings.h"
+#include "SimController.h"
+#include "Simulation.h"
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [-c config.json] [-p profile.json] [--days n] [--seed n] [--csv file] [--history file]" << std::endl
+              << "       [--evaporation fraction/day] [--pot ml] [--flow ml/s] [--tank ml]" << std::endl;
+}
+
+/**
+ * @brief Write the records in pages, like a dump of the history partition
+ */
+static bool writeHistory(const char* path, const std::vector<HistoryRecord_t>& records) {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    uint8_t page[HISTORY_PAGE_SIZE];
+    uint32_t sequence = 0;
+    for (size_t i = 0; i < records.size(); i += HISTORY_PAGE_RECORDS) {
+        size_t count = records.size() - i;
+        historyPageBuild(page, sequence++, &records[i], (count > HISTORY_PAGE_RECORDS) ? HISTORY_PAGE_RECORDS : count);
+        file.write((const char*) page, sizeof(page));
+    }
+    /* the rest of the last sector is erased */
+    memset(page, 0xFF, sizeof(page));
+    for (uint32_t written = sequence * HISTORY_PAGE_SIZE; (written % HISTORY_SECTOR_SIZE) != 0; written += HISTORY_PAGE_SIZE) {
+        file.write((const char*) page, sizeof(page));
+    }
+    return file.good();
+}
+
+int main(int argc, char** argv) {
+    const char* configPath = NULL;
+    const char* csvPath = NULL;
+    const char* profilePath = NULL;
+    const char* historyPath = NULL;
+    double days = 28;
+    unsigned int seed = 1;
+    EnvironmentConfig_t environmentConfig;
+    environmentDefaults(environmentConfig);
+
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        bool hasValue = (i + 1 < argc);
+        if ((argument == "-c") && hasValue) {
+            configPath = argv[++i];
+        } else if ((argument == "-p") && hasValue) {
+            profilePath = argv[++i];
+        } else if ((argument == "--days") && hasValue) {
+            days = atof(argv[++i]);
+        } else if ((argument == "--seed") && hasValue) {
+            seed = atoi(argv[++i]);
+        } else if ((argument == "--csv") && hasValue) {
+            csvPath = argv[++i];
+        } else if ((argument == "--history") && hasValue) {
+            historyPath = argv[++i];
+        } else if ((argument == "--evaporation") && hasValue) {
+            environmentConfig.evaporation = atof(argv[++i]);
+        } else if ((argument == "--pot") && hasValue) {
+            environmentConfig.potVolume = atof(argv[++i]);
+        } else if ((argument == "--flow") && hasValue) {
+            environmentConfig.pumpFlow = atof(argv[++i]);
+        } else if ((argument == "--tank") && hasValue) {
+            environmentConfig.tankVolume = atof(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    std::string json;
+    if ((configPath != NULL) && !hostReadFile(configPath, json)) {
+        std::cerr << "cannot read " << configPath << std::endl;
+        return 2;
+    }
+    HostSettings_t settings;
+    hostLoadSettings(json, settings);
+    PowerProfile_t profile;
+    powerProfileDefaults(profile);
+    if (profilePath != NULL) {
+        if (!hostReadFile(profilePath, json)) {
+            std::cerr << "cannot read " << profilePath << std::endl;
+            return 2;
+        }
+        powerProfileLoad(json, profile);
+    }
+
+    std::ofstream csv;
+    if (csvPath != NULL) {
+        csv.open(csvPath);
+    }
+
+    Environment environment(environmentConfig, seed);
+    SimController controller(settings, profile);
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<HistoryRecord_t> history;
+    SimulationResult_t result = simulate(environment, controller, settings, days, csv.is_open() ? &csv : NULL,
+                                         (historyPath != NULL) ? &history : NULL);
+    std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+    if ((historyPath != NULL) && !writeHistory(historyPath, history)) {
+        std::cerr << "cannot write " << historyPath << std::endl;
+        return 2;
+    }
+
+    const unsigned long* wakes = result.wakes;
+    unsigned long allWakes = wakes[WAKE_NOP] + wakes[WAKE_FASTPATH] + wakes[WAKE_HOMIE];
+    double simulatedDays = result.days;
+    printf("days %.1f\n", simulatedDays);
+    printf("wakes %lu (nop %lu, fastpath %lu, homie %lu)\n", allWakes,
+           wakes[WAKE_NOP], wakes[WAKE_FASTPATH], wakes[WAKE_HOMIE]);
+    printf("awake %.0f s (%.1f s/day)\n", result.awakeSeconds, result.awakeSeconds / simulatedDays);
+    printf("pumpruns %lu, %.0f s\n", result.pumpRuns, result.pumpSeconds);
+    printf("water pumped %.0f ml, absorbed %.0f ml, efficiency %.1f %%\n", environment.getPumped(),
+           environment.getAbsorbed(),
+           (environment.getPumped() > 0) ? (100 * environment.getAbsorbed() / environment.getPumped()) : 100.0);
+    printf("below moistdry (h):");
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        printf(" %.1f", result.belowDry[i] / 3600);
+    }
+    printf("\n");
+    printf("energy %.1f mAh (%.1f mAh/day), charged %.1f mAh, lipo %.0f %%\n", environment.getConsumed(),
+           environment.getConsumed() / simulatedDays, environment.getCharged(), 100 * environment.getCharge());
+    printf("tank %.0f ml left\n", environment.getTank());
+
+    double elapsed = std::chrono::duration<double, std::milli>(stop - start).count();
+    std::cerr << "simulated " << simulatedDays << " days in " << elapsed << " ms" << std::endl;
+    return 0;
+}
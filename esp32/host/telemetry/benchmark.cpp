@@ -0,0 +1,178 @@
+/**
+ * @file benchmark.cpp
+ * @author your name (you@domain.com)
+ * @brief Compare the String path of the telemetry with the fixed buffers on the host
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The same values as telemetryBenchmark() on the controller (build flag TELEMETRY_BENCHMARK),
+ * formatted with TelemetryFormat.cpp and with std::string in place of the Arduino String.
+ * "format" only formats the payloads (like the controller), "publish" also builds the topic,
+ * as Homie does on the heap and the TelemetryPublisher in its buffer.
+ * The allocations are counted with a replaced operator new. std::string keeps short texts
+ * without the heap (small string optimization), so its count is the lower bound of the String path.
+ * Build (in the esp32 folder):
+ *  g++ -std=c++11 -O2 -Iinclude host/telemetry/benchmark.cpp src/TelemetryFormat.cpp -o telemetry-benchmark
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+#include "ControllerConfiguration.h"
+#include "TelemetryFormat.h"
+
+#define DEFAULT_ROUNDS      1000000
+#define TOPIC_SIZE          128     /**< TELEMETRY_TOPIC_SIZE of the firmware */
+#define VALUES_PER_ROUND    3
+
+typedef std::chrono::steady_clock Clock;
+
+static unsigned long gAllocations = 0;
+
+void* operator new(size_t size) {
+    gAllocations++;
+    void* memory = malloc(size);
+    if (memory == NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+typedef struct BenchmarkResult_t {
+    unsigned long allocations;
+    double nanoseconds;     /**< per value */
+    size_t checksum;        /**< keeps the compiler from dropping the work */
+} BenchmarkResult_t;
+
+static const char* const BASE_TOPIC = "homie/";
+static const char* const DEVICE_ID = "plantctrl-000";
+static const char* const NODES[VALUES_PER_ROUND] = { "lipo", "lipo", "temperature" };
+static const char* const PROPERTIES[VALUES_PER_ROUND] = { "percent", "volt", "temp" };
+
+static void usage(const char* name) {
+    std::cerr << "usage: " << name << " [--rounds n]" << std::endl;
+}
+
+/**
+ * @brief String(value, decimals) of the Arduino core
+ */
+static std::string floatString(float value, int decimals) {
+    char text[33];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return std::string(text);
+}
+
+/**
+ * @brief Topic and payload as std::string, like setProperty().send(String(...))
+ */
+static size_t stringValue(int index, const std::string& payload) {
+    std::string topic = std::string(BASE_TOPIC) + DEVICE_ID + "/" + NODES[index] + "/" + PROPERTIES[index];
+    return topic.length() + payload.length();
+}
+
+/**
+ * @brief Topic into the prepared prefix, like TelemetryPublisher::buildTopic()
+ */
+static size_t bufferValue(char* topic, size_t prefixLength, int index, size_t payloadLength) {
+    size_t nodeLength = strlen(NODES[index]);
+    size_t propertyLength = strlen(PROPERTIES[index]);
+    char* position = topic + prefixLength;
+    memcpy(position, NODES[index], nodeLength);
+    position += nodeLength;
+    *position++ = '/';
+    memcpy(position, PROPERTIES[index], propertyLength + 1);
+    return prefixLength + nodeLength + 1 + propertyLength + payloadLength;
+}
+
+static BenchmarkResult_t runString(long rounds, bool withTopic) {
+    BenchmarkResult_t result = { 0, 0, 0 };
+    unsigned long allocations = gAllocations;
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < rounds; i++) {
+        std::string percent = std::to_string(100 * (i % 4096) / 4095);
+        std::string volt = floatString(ADC_5V_TO_3V3(i % 4096), 2);
+        std::string temp = floatString(-10.0f + (i % 500) * 0.0625f, 2);
+        if (withTopic) {
+            result.checksum += stringValue(0, percent) + stringValue(1, volt) + stringValue(2, temp);
+        } else {
+            result.checksum += percent.length() + volt.length() + temp.length();
+        }
+    }
+    result.nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (rounds * VALUES_PER_ROUND);
+    result.allocations = gAllocations - allocations;
+    return result;
+}
+
+static BenchmarkResult_t runBuffer(long rounds, bool withTopic) {
+    BenchmarkResult_t result = { 0, 0, 0 };
+    char payload[TELEMETRY_VALUE_SIZE];
+    char topic[TOPIC_SIZE];
+    size_t prefixLength = snprintf(topic, sizeof(topic), "%s%s/", BASE_TOPIC, DEVICE_ID);
+    unsigned long allocations = gAllocations;
+    Clock::time_point start = Clock::now();
+    for (long i = 0; i < rounds; i++) {
+        size_t percent = formatLong(payload, sizeof(payload), 100 * (i % 4096) / 4095);
+        if (withTopic) {
+            percent = bufferValue(topic, prefixLength, 0, percent);
+        }
+        size_t volt = formatFloat(payload, sizeof(payload), ADC_5V_TO_3V3(i % 4096), 2);
+        if (withTopic) {
+            volt = bufferValue(topic, prefixLength, 1, volt);
+        }
+        size_t temp = formatFloat(payload, sizeof(payload), -10.0f + (i % 500) * 0.0625f, 2);
+        if (withTopic) {
+            temp = bufferValue(topic, prefixLength, 2, temp);
+        }
+        result.checksum += percent + volt + temp;
+    }
+    result.nanoseconds = std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (rounds * VALUES_PER_ROUND);
+    result.allocations = gAllocations - allocations;
+    return result;
+}
+
+static void report(const char* name, const BenchmarkResult_t& result, long rounds) {
+    printf("%-16s %10lu allocs %6.2f per value %8.1f ns per value\n", name, result.allocations,
+           (double) result.allocations / (rounds * VALUES_PER_ROUND), result.nanoseconds);
+}
+
+int main(int argc, char** argv) {
+    long rounds = DEFAULT_ROUNDS;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if ((argument == "--rounds") && (i + 1 < argc)) {
+            rounds = atol(argv[++i]);
+        } else {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+    if (rounds <= 0) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    size_t checksum = 0;
+    printf("%ld rounds, %d values each\n", rounds, VALUES_PER_ROUND);
+    const char* const SECTIONS[] = { "format", "publish" };
+    for (int section = 0; section < 2; section++) {
+        bool withTopic = (section == 1);
+        BenchmarkResult_t string = runString(rounds, withTopic);
+        BenchmarkResult_t buffer = runBuffer(rounds, withTopic);
+        std::string name = SECTIONS[section];
+        report((name + " String").c_str(), string, rounds);
+        report((name + " Buffer").c_str(), buffer, rounds);
+        checksum += string.checksum + buffer.checksum;
+    }
+    printf("checksum %zu\n", checksum);
+    return 0;
+}
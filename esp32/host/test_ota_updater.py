@@ -0,0 +1,189 @@
+#!/usr/bin/env python
+"""
+Tests of the fleet rollout in ota_updater.py, without a broker.
+The MQTT client is replaced by a fake, that answers each published firmware like a
+device would (ota/status and $fw/checksum), and the clock only advances in time.sleep().
+
+    cd esp32/host
+    python3 -m unittest test_ota_updater
+"""
+
+from __future__ import division, print_function
+import heapq, io, os, sys, types, unittest
+from contextlib import redirect_stdout
+from hashlib import md5
+from unittest import mock
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+try:
+    import paho.mqtt.client
+except ImportError:
+    # only the import needs paho, the tests use the fake client
+    paho = types.ModuleType("paho")
+    paho.mqtt = types.ModuleType("paho.mqtt")
+    paho.mqtt.client = types.ModuleType("paho.mqtt.client")
+    sys.modules.update({"paho": paho, "paho.mqtt": paho.mqtt, "paho.mqtt.client": paho.mqtt.client})
+import ota_updater
+from ota_updater import Rollout
+
+BASE = "homie/"
+FIRMWARE = bytearray(b"new firmware")
+NEW_MD5 = md5(FIRMWARE).hexdigest()
+OLD_MD5 = md5(b"old firmware").hexdigest()
+TIMEOUT = 600
+
+
+class Message(object):
+    def __init__(self, topic, payload):
+        self.topic = topic
+        self.payload = payload.encode()
+
+
+class FakeClock(object):
+    """ time.time() and time.sleep() of ota_updater; the messages are delivered while sleeping """
+
+    def __init__(self):
+        self.now = 1000.0
+        self.events = []
+        self.sequence = 0
+        self.deliver = None
+
+    def time(self):
+        return self.now
+
+    def schedule(self, delay, topic, payload):
+        self.sequence += 1
+        heapq.heappush(self.events, (self.now + delay, self.sequence, topic, payload))
+
+    def sleep(self, seconds):
+        end = self.now + seconds
+        while self.events and self.events[0][0] <= end:
+            at, _, topic, payload = heapq.heappop(self.events)
+            self.now = at
+            self.deliver(Message(topic, payload))
+        self.now = end
+
+
+class FakeClient(object):
+    """
+    Records the publishes. A device answers its firmware with the given behaviour:
+    ok          downloads and comes back with the new checksum
+    old         downloads, but reboots with the old firmware
+    error       rejects the firmware (ota disabled)
+    silent      sleeps through the whole wave
+    """
+
+    def __init__(self, clock, devices):
+        self.clock = clock
+        self.devices = devices
+        self.published = []
+        self.subscribed = []
+
+    def subscribe(self, topic):
+        self.subscribed.append(topic)
+
+    def publish(self, topic, payload, qos=0, retain=False):
+        self.published.append((topic, payload, retain))
+        device_id = topic[len(BASE):].split("/")[0]
+        if not payload:
+            return
+        status = "{}{}/$implementation/ota/status".format(BASE, device_id)
+        checksum = "{}{}/$fw/checksum".format(BASE, device_id)
+        behaviour = self.devices[device_id]
+        if behaviour == "ok":
+            self.clock.schedule(60, status, "206 4096/{}".format(len(FIRMWARE)))
+            self.clock.schedule(120, checksum, NEW_MD5)
+        elif behaviour == "old":
+            self.clock.schedule(60, status, "206 4096/{}".format(len(FIRMWARE)))
+            self.clock.schedule(120, checksum, OLD_MD5)
+        elif behaviour == "error":
+            self.clock.schedule(60, status, "403")
+
+    def firmware(self, device_id):
+        """ amount of the published firmware, the removal excluded """
+        topic = "{}{}/$implementation/ota/firmware/{}".format(BASE, device_id, NEW_MD5)
+        return sum(1 for published in self.published if published[0] == topic and published[1])
+
+    def removed(self, device_id):
+        topic = "{}{}/$implementation/ota/firmware/{}".format(BASE, device_id, NEW_MD5)
+        return any(published[0] == topic and not published[1] and published[2] for published in self.published)
+
+
+class RolloutTest(unittest.TestCase):
+
+    def rollout(self, devices, canary=1, wave_size=2, failure_threshold=0.1, installed=None):
+        """ run a rollout, every device reports its retained checksum after the connect """
+        self.clock = FakeClock()
+        self.client = FakeClient(self.clock, devices)
+        self.updater = Rollout(self.client, BASE, sorted(devices), FIRMWARE, canary, wave_size,
+                               failure_threshold, TIMEOUT)
+        self.clock.deliver = lambda message: self.updater.on_message(self.client, None, message)
+        self.updater.on_connect(self.client, None, None, 0)
+        for device_id in devices:
+            checksum = (installed or {}).get(device_id, OLD_MD5)
+            self.clock.schedule(0.5, "{}{}/$fw/checksum".format(BASE, device_id), checksum)
+        with mock.patch.object(ota_updater, "time", self.clock), redirect_stdout(io.StringIO()):
+            return self.updater.run()
+
+    def test_subscribes_all_devices(self):
+        self.rollout({"a": "ok", "b": "ok"})
+        for device_id in ("a", "b"):
+            self.assertIn(BASE + device_id + "/$fw/checksum", self.client.subscribed)
+            self.assertIn(BASE + device_id + "/$implementation/ota/status", self.client.subscribed)
+
+    def test_canary_pass(self):
+        self.assertTrue(self.rollout({"a": "ok", "b": "ok", "c": "ok"}))
+        for device_id in ("a", "b", "c"):
+            self.assertEqual(self.updater.state[device_id], Rollout.DONE)
+            self.assertEqual(self.client.firmware(device_id), 1)
+            self.assertTrue(self.client.removed(device_id))
+        # the canary is finished, before the next wave gets the firmware
+        topics = [published[0] for published in self.client.published if published[1]]
+        self.assertEqual([topic[len(BASE)] for topic in topics], ["a", "b", "c"])
+
+    def test_canary_failure(self):
+        self.assertFalse(self.rollout({"a": "error", "b": "ok", "c": "ok"}))
+        self.assertEqual(self.updater.state["a"], Rollout.FAILED)
+        self.assertTrue(self.client.removed("a"))
+        for device_id in ("b", "c"):
+            self.assertEqual(self.updater.state[device_id], Rollout.PENDING)
+            self.assertEqual(self.client.firmware(device_id), 0)
+
+    def test_wave_timeout(self):
+        start = FakeClock().now
+        self.assertFalse(self.rollout({"a": "silent", "b": "ok"}))
+        self.assertEqual(self.updater.state["a"], Rollout.FAILED)
+        self.assertTrue(self.client.removed("a"))
+        self.assertGreaterEqual(self.clock.now - start, TIMEOUT)
+        self.assertEqual(self.updater.state["b"], Rollout.PENDING)
+
+    def test_old_checksum_after_reboot(self):
+        self.assertFalse(self.rollout({"a": "old", "b": "ok"}))
+        self.assertEqual(self.updater.state["a"], Rollout.FAILED)
+        # failed on the checksum, not on the timeout
+        self.assertLess(self.clock.now - FakeClock().now, TIMEOUT)
+
+    def test_failure_threshold_exceeded(self):
+        devices = {"a": "ok", "b": "ok", "c": "old", "d": "ok", "e": "ok"}
+        self.assertFalse(self.rollout(devices, wave_size=2, failure_threshold=0.4))
+        self.assertEqual(self.updater.state["b"], Rollout.DONE)
+        self.assertEqual(self.updater.state["c"], Rollout.FAILED)
+        for device_id in ("d", "e"):
+            self.assertEqual(self.updater.state[device_id], Rollout.PENDING)
+            self.assertEqual(self.client.firmware(device_id), 0)
+
+    def test_failure_threshold_not_exceeded(self):
+        devices = {"a": "ok", "b": "ok", "c": "old", "d": "ok", "e": "ok"}
+        self.assertFalse(self.rollout(devices, wave_size=2, failure_threshold=0.5))
+        self.assertEqual(self.updater.state["c"], Rollout.FAILED)
+        for device_id in ("d", "e"):
+            self.assertEqual(self.updater.state[device_id], Rollout.DONE)
+
+    def test_already_up_to_date(self):
+        self.assertTrue(self.rollout({"a": "ok", "b": "silent"}, installed={"b": NEW_MD5}))
+        self.assertEqual(self.updater.state["b"], Rollout.DONE)
+        self.assertEqual(self.client.firmware("b"), 0)
+
+
+if __name__ == "__main__":
+    unittest.main()
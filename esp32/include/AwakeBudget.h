@@ -0,0 +1,84 @@
+/**
+ * @file AwakeBudget.h
+ * @author your name (you@domain.com)
+ * @brief Deadlines of the phases of a wake
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * WiFi, MQTT, publish and watering follow each other; each phase has its own
+ * deadline, counted from the start of the phase. The sensing runs in parallel
+ * and its deadline is counted from the wake.
+ * An overrun is counted once per phase and wake; the caller decides, how to degrade.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef AWAKE_BUDGET_H
+#define AWAKE_BUDGET_H
+
+#include <stdint.h>
+
+typedef enum BudgetPhase_t {
+    BUDGET_SENSE = 0,   /**< Acquisition of all sensors, from the wake */
+    BUDGET_WIFI,        /**< Association with the access point */
+    BUDGET_MQTT,        /**< Connect to the broker */
+    BUDGET_PUBLISH,     /**< All values published */
+    BUDGET_WATER,       /**< Pump run */
+    BUDGET_PHASES,
+    BUDGET_DONE = BUDGET_PHASES     /**< Nothing left to do, ready to sleep */
+} BudgetPhase_t;
+
+#define BUDGET_SENSE_DEFAULT    3000    /**< ms */
+#define BUDGET_WIFI_DEFAULT     4000    /**< ms */
+#define BUDGET_MQTT_DEFAULT     3000    /**< ms */
+#define BUDGET_PUBLISH_DEFAULT  2000    /**< ms */
+#define BUDGET_WATER_MARGIN     1000    /**< ms after the maximum runtime of the pump, if not configured */
+
+class AwakeBudget {
+    private:
+        uint32_t mDeadline[BUDGET_PHASES];
+        uint16_t* mOverruns = 0;
+        BudgetPhase_t mPhase = BUDGET_SENSE;
+        uint32_t mStart = 0;
+        bool mCounted[BUDGET_PHASES];
+
+    public:
+        /**
+         * @brief Start with the sensing phase
+         *
+         * @param deadlines ms per phase, 0 uses the default
+         * @param overruns  counter per phase, kept by the caller until published
+         */
+        void begin(const uint16_t deadlines[BUDGET_PHASES], uint16_t overruns[BUDGET_PHASES]);
+
+        /**
+         * @brief Parse the setting "sense,wifi,mqtt,publish,water" (ms, empty fields use the defaults)
+         * @return false, if the text is malformed; deadlines are unchanged then
+         */
+        static bool parse(const char* text, uint16_t deadlines[BUDGET_PHASES]);
+
+        static const char* getName(BudgetPhase_t phase);
+
+        void setDeadline(BudgetPhase_t phase, uint32_t milliseconds);
+        uint32_t getDeadline(BudgetPhase_t phase) const;
+
+        void enter(BudgetPhase_t phase, uint32_t now);
+        BudgetPhase_t getPhase() const { return mPhase; }
+
+        /**
+         * @brief ms left in the current phase (0 if overrun or done)
+         */
+        uint32_t getRemaining(uint32_t now) const;
+
+        /**
+         * @brief Check the current phase; the first detection is counted
+         */
+        bool isOverrun(uint32_t now);
+
+        /**
+         * @brief Count an overrun of a phase, that is not the current one (e.g. sensing)
+         */
+        void countOverrun(BudgetPhase_t phase);
+};
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file ChunkDecoder.h
+ * @author your name (you@domain.com)
+ * @brief Manifest and chunk format of the resumable firmware update
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The format is described in ChunkedOta.h. A chunk is checked against the manifest
+ * (index, length), inflated and compared with its CRC32, before it is written.
+ * Without Arduino dependencies, so it can be compiled on the host, too: the controller
+ * inflates with miniz (tinfl) of the ROM, the host with zlib.
+ */
+
+#ifndef CHUNK_DECODER_H
+#define CHUNK_DECODER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CHUNKOTA_MD5_SIZE           33      /**< 32 hex characters and termination */
+#define CHUNKOTA_SECTOR_SIZE        4096    /**< Flash sector, the chunk size must be a multiple of it */
+#define CHUNKOTA_MAX_CHUNK_SIZE     4096    /**< Decompressed size, one flash sector */
+#define CHUNKOTA_HEADER_SIZE        12
+#define CHUNKOTA_MAX_MESSAGE_SIZE   (CHUNKOTA_HEADER_SIZE + CHUNKOTA_MAX_CHUNK_SIZE + 64) /**< zlib overhead for data, that can not be compressed */
+
+typedef struct ChunkManifest_t {
+    char md5[CHUNKOTA_MD5_SIZE];
+    uint32_t imageSize;
+    uint32_t chunkSize;
+    uint32_t chunkCount;
+} ChunkManifest_t;
+
+typedef enum ChunkResult_t {
+    CHUNK_OK = 0,
+    CHUNK_UNEXPECTED,   /**< Duplicate or other index, the message is ignored */
+    CHUNK_CORRUPT       /**< Inflating or the CRC failed, the chunk must be requested again */
+} ChunkResult_t;
+
+/**
+ * @brief Parse "<md5> <image size> <chunk size> <chunk count>"
+ * @return false, if the manifest is empty or does not fit to the flash
+ */
+bool chunkParseManifest(const char* text, ChunkManifest_t& manifest);
+
+/**
+ * @brief Decompressed length of a chunk, the last one may be shorter
+ */
+uint32_t chunkLength(const ChunkManifest_t& manifest, uint32_t index);
+
+/**
+ * @brief Bytes of the inflator, that chunkDecode() needs (0, if none is needed)
+ */
+size_t chunkInflatorSize(void);
+
+/**
+ * @brief Check and inflate one chunk message
+ *
+ * @param index     the chunk, that was requested
+ * @param inflator  chunkInflatorSize() bytes
+ * @param output    CHUNKOTA_MAX_CHUNK_SIZE bytes, chunkLength() of them are valid with CHUNK_OK
+ */
+ChunkResult_t chunkDecode(const ChunkManifest_t& manifest, uint32_t index, const uint8_t* message, size_t length,
+                          void* inflator, uint8_t* output);
+
+/**
+ * @brief Text of the request topic: "<md5> <chunk index>"
+ * @return int      length of the text
+ */
+int chunkRequest(const ChunkManifest_t& manifest, uint32_t index, char* buffer, size_t size);
+
+#endif
@@ -0,0 +1,72 @@
+/**
+ * @file ChunkedOta.h
+ * @author your name (you@domain.com)
+ * @brief Resumable firmware update with compressed chunks over MQTT
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Topics below <base topic><device id>/$implementation/chunkota/
+ *  manifest  (host, retained)  "<md5> <image size> <chunk size> <chunk count>"
+ *  request   (device)          "<md5> <chunk index>", the next chunk, that is needed
+ *  chunk     (host)            header (index, raw length, CRC32 of raw data; uint32 little endian)
+ *                              followed by the zlib compressed data
+ *  status    (device)          "206 <written>/<size>", "200" when done, "304" when up to date,
+ *                              "4xx/5xx <reason>" on errors
+ *
+ * Every chunk is compressed on its own, so the update can continue with the next chunk
+ * after a deep sleep or a power loss. The progress is kept in the RTC memory and the NVS.
+ */
+
+#ifndef CHUNKED_OTA_H
+#define CHUNKED_OTA_H
+
+#include <Arduino.h>
+#include <AsyncMqttClient.h>
+#include "ChunkDecoder.h"
+
+#define CHUNKOTA_TOPIC_SIZE         128
+#define CHUNKOTA_TIMEOUT            10000   /**< Request the chunk again, if nothing was received (ms) */
+#define CHUNKOTA_RETRIES            3       /**< Stop the update (until the next wake), after so many timeouts */
+#define CHUNKOTA_PERSIST_INTERVAL   16      /**< Store the progress in the NVS after so many chunks */
+
+class ChunkedOta {
+    private:
+        AsyncMqttClient* mClient = NULL;
+        bool mSubscribed = false;
+
+        ChunkManifest_t mManifest;
+        uint32_t mNextChunk = 0;
+        bool mActive = false;
+        unsigned long mLastActivity = 0;
+        int mRetries = 0;
+
+        const char* topic(const char* name);
+        void publishStatus(const char* status);
+        void requestChunk(void);
+        void startUpdate(void);
+        void processChunk(void);
+        void finishUpdate(void);
+        void stopUpdate(const char* status);
+        void storeProgress(bool persistent);
+
+    public:
+        /**
+         * @brief Subscribe to the update topics
+         * Must be called, when the MQTT client is connected (MQTT_READY)
+         */
+        void begin(AsyncMqttClient* client, const char* baseTopic, const char* deviceId);
+
+        /**
+         * @brief Decompress and write the received chunks
+         * The flash is written here and not in the MQTT callback, so the network task is not blocked.
+         */
+        void loop(void);
+
+        /**
+         * @brief Check, if an update is running (the controller must not sleep)
+         */
+        bool isActive(void) { return mActive; }
+};
+
+#endif
@@ -0,0 +1,119 @@
+/**
+ * @file ControlLogic.h
+ * @author your name (you@domain.com)
+ * @brief Decisions of a wake, without any hardware access
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Used by the firmware and by the host tools (e.g. host/replay), so only
+ * plain C++ is allowed here: no Arduino, Homie or FreeRTOS headers.
+ */
+
+#ifndef CONTROL_LOGIC_H
+#define CONTROL_LOGIC_H
+
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define DEACTIVATED_PLANT   5000    /**< Moisture trigger, that never wakes the controller */
+#define MOIST_PERCENT_UNUSED    -1  /**< moistpercent setting: the raw threshold moistdry is used */
+#define NO_PUMP             -1
+#define CONTROL_HYSTERESIS  10      /**< Percent of moistdry, the moisture must rise above, to end the watering */
+#define CONTROL_MAX_BURSTS  5       /**< Pump runs of one watering cycle, e.g. with a broken sensor */
+#define CONTROL_ADC_MAX     4095    /**< Highest moisture reading, the exit threshold is limited to it */
+
+/**
+ * @brief Watering state machine of one plant
+ *
+ * idle -(below enter threshold)-> needs water -(pump started)-> watering
+ * -(runtime over)-> soaking -(soak time over, below exit threshold)-> needs water
+ *                           -(soak time over, above exit threshold)-> cooldown -(cooldown over)-> idle
+ */
+typedef enum PlantPhase_t {
+    PLANT_IDLE = 0,
+    PLANT_NEEDS_WATER,      /**< Waits for the next possible pump run (low light, other pump) */
+    PLANT_WATERING,         /**< Pump runs */
+    PLANT_SOAKING,          /**< Water sinks to the sensor, the moisture is not usable yet */
+    PLANT_COOLDOWN          /**< Watered, no new cycle until the cooldown is over */
+} PlantPhase_t;
+
+/**
+ * @brief Settings of one plant, needed by the decisions
+ */
+typedef struct PlantControl_t {
+    long sensorDry;         /**< Moisture (ADC or percent), below the plant needs water (enter threshold) */
+    long sensorExit;        /**< Moisture, the watering cycle ends above (exit threshold) */
+    long cooldown;          /**< Minutes between two pump runs */
+    long runtime;           /**< Seconds, the pump runs at once */
+    long soakTime;          /**< Seconds after a pump run, until the moisture is used again */
+    bool onlyWhenLowLight;  /**< Only water, when the sun does not charge the battery */
+} PlantControl_t;
+
+/**
+ * @brief State of one plant, kept over deep sleep
+ */
+typedef struct PlantState_t {
+    uint8_t phase;              /**< @see PlantPhase_t */
+    uint8_t bursts;             /**< Pump runs of the current watering cycle */
+    int16_t trigger;            /**< Copy of the enter threshold for mode1, valid when the state is initialized */
+    uint32_t lastActivation;    /**< Time (s) of the last pump run */
+    uint32_t timer;             /**< Time (s), the soak or the cooldown ends */
+} PlantState_t;
+
+/**
+ * @brief State kept over deep sleep (RTC memory)
+ */
+typedef struct ControlState_t {
+    long deepSleepTime;                 /**< Copy of the setting, 0 until the first mode2 */
+    bool initialized;                   /**< The triggers are set, by the first controlSelectPumps() */
+    PlantState_t plants[MAX_PLANTS];
+} ControlState_t;
+
+/**
+ * @brief Exit threshold with the default hysteresis, at most CONTROL_ADC_MAX
+ */
+long controlExitThreshold(long sensorDry);
+
+/**
+ * @brief mode1: decide, if the full wake (mode2) is necessary
+ *
+ * @param moisture  ADC value (or percent) of each plant
+ * @param now       current time (s)
+ * @return true     if mode2 is required
+ */
+bool controlIsMode2Required(const ControlState_t& state, const int moisture[MAX_PLANTS], long now);
+
+/**
+ * @brief Advance the state machine of all plants and select the next pump
+ * The selected plant is in PLANT_WATERING afterwards.
+ *
+ * @param plants    settings of each plant
+ * @param moisture  ADC value (or percent) of each plant
+ * @param solar     ADC value of the solar panel
+ * @param now       current time (s)
+ * @return int      index of the pump to start or NO_PUMP
+ */
+int controlSelectPump(ControlState_t& state, const PlantControl_t plants[MAX_PLANTS],
+                      const int moisture[MAX_PLANTS], long solar, long now);
+
+/**
+ * @brief Like controlSelectPump(), but selects up to limit pumps for one wake
+ * The pumps are started together; the pump driver sequences them within its current budget.
+ *
+ * @param limit     maximum amount of pumps
+ * @return uint32_t bit mask of the pumps to start
+ */
+uint32_t controlSelectPumps(ControlState_t& state, const PlantControl_t plants[MAX_PLANTS],
+                            const int moisture[MAX_PLANTS], long solar, long now, int limit);
+
+/**
+ * @brief Limit of controlSelectPumps() for a current budget
+ * Without a current budget only one pump runs per wake.
+ *
+ * @param currentBudget mA of all pumps running at once (pumpcurrent setting)
+ * @return int          maximum amount of pumps
+ */
+int controlPumpLimit(long currentBudget);
+
+#endif
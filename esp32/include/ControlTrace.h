@@ -0,0 +1,63 @@
+/**
+ * @file ControlTrace.h
+ * @author your name (you@domain.com)
+ * @brief Raw sensor inputs of one wake, as a CSV line
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The firmware writes one line per wake (build flag CONTROL_TRACE),
+ * host/replay reads the lines and runs the control logic again.
+ * Values, that were not measured in the wake, are left empty.
+ * Wakes without a connection are staged in a DeltaCodec stream and published
+ * together as one batch: TRACE_BATCH_MAGIC, varint length, stream.
+ */
+
+#ifndef CONTROL_TRACE_H
+#define CONTROL_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define TRACE_UNKNOWN       INT32_MIN   /**< Value was not measured in this wake */
+#define TRACE_LINE_SIZE     128
+#define TRACE_HEADER        "#time,boot,moist0,moist1,moist2,moist3,moist4,moist5,moist6,lipo,solar,tempair,tempcontrol,echo"
+#define TRACE_CHANNELS      (1 + MAX_PLANTS + 5)    /**< Values of a record for the DeltaCodec, without the time */
+#define TRACE_BATCH_MAGIC   0xD1
+
+typedef struct TraceRecord_t {
+    int32_t time;                   /**< Wake time (s) */
+    int32_t boot;                   /**< Boot counter */
+    int32_t moisture[MAX_PLANTS];   /**< ADC */
+    int32_t lipo;                   /**< ADC */
+    int32_t solar;                  /**< ADC */
+    int32_t temperature[2];         /**< 1/100 °C, air and control */
+    int32_t echo;                   /**< Duration of the ultrasonic echo (us) */
+} TraceRecord_t;
+
+/**
+ * @brief Mark all values as not measured
+ */
+void traceClear(TraceRecord_t& record);
+
+/**
+ * @brief Format one record as CSV line (without line break)
+ * @return size_t   amount of written characters, 0 if the buffer is too small
+ */
+size_t traceFormat(char* buffer, size_t size, const TraceRecord_t& record);
+
+/**
+ * @brief Values of a record in the order of TRACE_HEADER, without the time
+ */
+void traceToChannels(const TraceRecord_t& record, int32_t values[TRACE_CHANNELS]);
+
+void traceFromChannels(TraceRecord_t& record, uint32_t time, const int32_t values[TRACE_CHANNELS]);
+
+/**
+ * @brief Parse one CSV line
+ * @return false for comments, empty lines and lines with missing columns
+ */
+bool traceParse(const char* line, TraceRecord_t& record);
+
+#endif
@@ -55,8 +55,9 @@
 
 #define HC_SR04                  /**< Ultrasonic distance sensor to measure water level */
 #define SENSOR_SR04_ECHO    17   /**< GPIO 17 - Echo */
-#define SENSOR_SR04_TRIG    23   /**< GPIO 23 - Trigger */
+#define SENSOR_SR04_TRIG    4    /**< GPIO 4 - Trigger (GPIO 23 is OUTPUT_PUMP0, driven by LEDC) */
 
-#define MAX_CONFIG_SETTING_ITEMS 50 /**< Parameter, that can be configured in Homie */
+#define MAX_CONFIG_SETTING_ITEMS 64 /**< Parameter, that can be configured in Homie (15 global, 7 per plant) */
+#define MAX_CONFIG_FILE_SIZE    3000 /**< Bytes of a config.json with all settings: about 1800 compact, 2600 indented like host/config-example.json */
 
 #endif
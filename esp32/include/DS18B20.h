@@ -21,10 +21,23 @@
 
 #include <OneWire.h>
 
+#define DS18B20_RESOLUTION_MAX  12
+/**
+ * @brief Maximum conversion time (ms) of a resolution (9..12 bit), from the datasheet
+ */
+#define DS18B20_CONVERSION_TIME(bits)   (750 >> (DS18B20_RESOLUTION_MAX - (bits)))
+
 class Ds18B20 {
     private:
         OneWire* mDs;
         int foundDevices;
+        uint8_t mResolution = DS18B20_RESOLUTION_MAX;
+
+        /**
+         * @brief Read the scratchpad of each sensor and convert the temperature
+         * @return int amount of read temperature values, -1 if the array is too small
+         */
+        int readScratchpads(float* pTemperatures, int maxTemperatures);
     public:
         Ds18B20(int pin) {
             this->mDs = new OneWire(pin);
@@ -42,11 +55,39 @@ class Ds18B20 {
 
         /**
          * @brief Read all temperatures in celsius
-         * 
+         * Starts the conversion and waits for it (blocking, at most DS18B20_CONVERSION_TIME).
          * @param pTemperatures     array of float valuies
          * @param maxTemperatures  size of the given array
-         * @return int amount of read temperature values
+         * @return int amount of read temperature values, -1 if the array is too small
          */
         int readAllTemperatures(float* pTemperatures, int maxTemperatures);
+
+        /**
+         * @brief Set the resolution of all sensors (9..12 bit)
+         * Only the scratchpad is written, so it must be repeated after each power on.
+         */
+        void setResolution(uint8_t bits);
+
+        /**
+         * @brief Start the conversion of all sensors at once (non blocking)
+         * The result is available with readTemperatures() after the conversion is done.
+         */
+        void startConversion(void);
+
+        /**
+         * @brief Check, if the conversion started by startConversion() is finished
+         * The sensors answer read time slots with 0 while converting; there must be no
+         * other bus traffic between the start and this poll. Needs externally powered sensors.
+         */
+        bool isConversionDone(void);
+
+        /**
+         * @brief Read the result of the last conversion of all sensors (non blocking)
+         *
+         * @param pTemperatures     array of float values
+         * @param maxTemperatures   size of the given array
+         * @return int amount of read temperature values, -1 if the array is too small
+         */
+        int readTemperatures(float* pTemperatures, int maxTemperatures);
 };
 #endif
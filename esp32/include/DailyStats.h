@@ -0,0 +1,134 @@
+/**
+ * @file DailyStats.h
+ * @author your name (you@domain.com)
+ * @brief Daily minimum, maximum, mean and deviation of each plant and sensor
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Every wake adds its values in O(1) (count, sum, sum of squares), so the
+ * accumulators fit into the RTC memory. At the first wake of a new (local) day
+ * the previous day is reduced to a summary, that waits for the next connection.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef DAILY_STATS_H
+#define DAILY_STATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define STATS_MAX_INTERVAL  7200    /**< s, longer gaps between two wakes are not counted as dry time */
+#define STATS_LINE_SIZE     640     /**< Summary of all plants and sensors */
+
+typedef enum StatsSensor_t {
+    STATS_TEMP_AIR = 0,     /**< 0.01 degree */
+    STATS_TEMP_CONTROL,     /**< 0.01 degree */
+    STATS_WATER,            /**< mm remaining */
+    STATS_LIPO,             /**< mV */
+    STATS_SOLAR,            /**< mV */
+    STATS_SENSORS
+} StatsSensor_t;
+
+typedef struct StatsAccumulator_t {
+    int64_t sumSquares;
+    int32_t sum;
+    uint16_t count;
+    int16_t min;
+    int16_t max;
+} StatsAccumulator_t;
+
+typedef struct StatsPlant_t {
+    StatsAccumulator_t moisture;    /**< % */
+    uint32_t drySeconds;            /**< Time below the enter threshold */
+    uint32_t pumpMilliseconds;
+    uint32_t water;                 /**< ml */
+} StatsPlant_t;
+
+typedef struct StatsValue_t {
+    int16_t min;
+    int16_t max;
+    int16_t mean;
+    uint16_t deviation;
+    uint16_t count;                 /**< 0, if there was no value the whole day */
+} StatsValue_t;
+
+typedef struct StatsSummaryPlant_t {
+    StatsValue_t moisture;
+    uint16_t dryMinutes;
+    uint16_t pumpSeconds;
+    uint32_t water;                 /**< ml */
+} StatsSummaryPlant_t;
+
+typedef struct DailySummary_t {
+    int32_t day;                    /**< YYYYMMDD, 0 if no summary is pending */
+    uint16_t wakes;
+    StatsSummaryPlant_t plants[MAX_PLANTS];
+    StatsValue_t sensors[STATS_SENSORS];
+} DailySummary_t;
+
+/**
+ * @brief Survives the deep sleep (RTC_DATA_ATTR), all zero after a power on
+ */
+typedef struct DailyStatsState_t {
+    int32_t day;                    /**< YYYYMMDD of the accumulators */
+    uint32_t lastWake;              /**< s, 0 before the first wake */
+    uint16_t wakes;
+    uint8_t dryMask;                /**< Plants below the threshold at the last wake */
+    StatsPlant_t plants[MAX_PLANTS];
+    StatsAccumulator_t sensors[STATS_SENSORS];
+    DailySummary_t summary;         /**< Previous day, until published */
+} DailyStatsState_t;
+
+class DailyStats {
+    private:
+        DailyStatsState_t* mState = 0;
+
+        static void clear(StatsAccumulator_t& accumulator);
+        static void add(StatsAccumulator_t& accumulator, int32_t value);
+        static void reduce(StatsValue_t& value, const StatsAccumulator_t& accumulator);
+        void reset(int32_t day);
+
+    public:
+        /**
+         * @param state kept by the caller (RTC memory)
+         */
+        void begin(DailyStatsState_t* state);
+
+        /**
+         * @brief Start a new day, if the day of this wake differs
+         * The previous day becomes the pending summary (an older, unpublished one is replaced).
+         *
+         * @param day   local date of this wake as YYYYMMDD
+         * @return true, if the day changed
+         */
+        bool rollover(int32_t day);
+
+        /**
+         * @brief Count the wake and the time, the plants were dry since the last wake
+         *
+         * @param now       s
+         * @param dryMask   plants below their threshold in this wake
+         */
+        void addWake(uint32_t now, uint8_t dryMask);
+
+        void addMoisture(int plant, int32_t percent);
+        void addSensor(StatsSensor_t sensor, int32_t value);
+        void addPump(int plant, uint32_t milliseconds, uint32_t millilitre);
+
+        bool isSummaryPending(void) const { return (this->mState != 0) && (this->mState->summary.day != 0); }
+        const DailySummary_t& getSummary(void) const { return this->mState->summary; }
+        void clearSummary(void);
+
+        /**
+         * @brief Format the summary as compact JSON
+         * {"day":20261019,"wakes":288,"plant0":[min,max,mean,sd,drymin,pumps,ml],...,"tempair":[min,max,mean,sd],...}
+         * Temperatures in degree, lipo and solar in V; a plant or sensor without values is null.
+         *
+         * @return size_t   amount of written characters, 0 if the buffer is too small
+         */
+        static size_t format(char* buffer, size_t size, const DailySummary_t& summary);
+};
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file DeltaCodec.h
+ * @author your name (you@domain.com)
+ * @brief Compact stream of sensor records: delta-of-delta time, varint deltas per channel
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Each record is encoded against the previous one of the stream:
+ *  - time: difference of the wake interval to the previous interval (0 for regular wakes)
+ *  - bitmap: one bit per channel, that changed
+ *  - per changed channel: the difference to the previous value
+ * All numbers are zig-zag varints, so small positive and negative values need one byte.
+ * A regular wake with unchanged values needs two bytes; the first record of a
+ * stream is encoded against zero. The differences wrap around (32 bit), so
+ * markers like INT32_MIN do not overflow.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef DELTA_CODEC_H
+#define DELTA_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define DELTA_MAX_CHANNELS      16
+#define DELTA_VARINT_SIZE       5       /**< Maximum bytes of one 32 bit varint */
+#define DELTA_MAX_RECORD(channels)  (DELTA_VARINT_SIZE * (2 + (channels)))
+
+/**
+ * @brief Previous record of a stream; the encoder and the decoder keep one each
+ */
+typedef struct DeltaState_t {
+    uint32_t time;
+    uint32_t interval;
+    int32_t values[DELTA_MAX_CHANNELS];
+} DeltaState_t;
+
+/**
+ * @brief Start a new stream
+ */
+void deltaReset(DeltaState_t& state);
+
+/**
+ * @brief Append one record
+ *
+ * @param channels  amount of values (at most DELTA_MAX_CHANNELS), the same for the whole stream
+ * @return size_t   written bytes, 0 if the record does not fit (the state is unchanged then)
+ */
+size_t deltaEncode(DeltaState_t& state, uint8_t channels, uint32_t time, const int32_t* values,
+                   uint8_t* buffer, size_t size);
+
+/**
+ * @brief Read one record
+ *
+ * @return size_t   read bytes, 0 at the end of the data or if it is truncated
+ */
+size_t deltaDecode(DeltaState_t& state, uint8_t channels, const uint8_t* buffer, size_t length,
+                   uint32_t& time, int32_t* values);
+
+/**
+ * @brief Write one unsigned varint
+ * @return size_t   written bytes, 0 if it does not fit
+ */
+size_t deltaPutVarint(uint8_t* buffer, size_t size, uint32_t value);
+
+/**
+ * @brief Read one unsigned varint
+ * @return size_t   read bytes, 0 if it is truncated
+ */
+size_t deltaGetVarint(const uint8_t* buffer, size_t length, uint32_t& value);
+
+#endif
@@ -0,0 +1,129 @@
+/**
+ * @file HistoryFormat.h
+ * @author your name (you@domain.com)
+ * @brief Binary format of the history log in the flash
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The history partition is written page by page (256 byte). Each page starts
+ * with a header, followed by up to HISTORY_PAGE_RECORDS records of one wake.
+ * Header and records are each protected by a CRC-8; unused records stay erased (0xFF).
+ * Shared by the firmware (HistoryLog) and the host decoder (host/history).
+ */
+
+#ifndef HISTORY_FORMAT_H
+#define HISTORY_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define HISTORY_PAGE_SIZE           256
+#define HISTORY_SECTOR_SIZE         4096        /**< Erase unit of the flash */
+#define HISTORY_RECORD_SIZE         32
+#define HISTORY_PAGE_RECORDS        ((HISTORY_PAGE_SIZE / HISTORY_RECORD_SIZE) - 1)
+#define HISTORY_MAGIC               0x48495331UL /**< "HIS1" */
+#define HISTORY_VERSION             1
+#define HISTORY_UNKNOWN             0xFFFF      /**< Value was not measured in this wake */
+#define HISTORY_TEMP_UNKNOWN        INT16_MIN   /**< Temperature was not measured in this wake */
+#define HISTORY_ALL_PLANTS          -1
+#define HISTORY_LINE_SIZE           128
+#define HISTORY_CHANNELS            (MAX_PLANTS + 8)    /**< Values of a record for the DeltaCodec, without the time */
+
+typedef enum HistoryWake_t {
+    HISTORY_WAKE_NOP = 0,       /**< mode1 only */
+    HISTORY_WAKE_FASTPATH,
+    HISTORY_WAKE_HOMIE,         /**< mode2 */
+    HISTORY_WAKE_BUTTON,        /**< mode3 */
+    HISTORY_WAKE_COLD           /**< Power on or reset */
+} HistoryWake_t;
+
+typedef struct __attribute__((packed)) HistoryRecord_t {
+    uint32_t time;                  /**< Wake time (s) */
+    uint16_t moisture[MAX_PLANTS];  /**< ADC */
+    int16_t temperature[2];         /**< 1/100 °C, air and control */
+    uint16_t water;                 /**< Estimated distance to the water (mm) */
+    uint16_t lipo;                  /**< ADC */
+    uint16_t solar;                 /**< ADC */
+    uint8_t pumps;                  /**< Bit mask of the pumps started in this wake */
+    uint8_t wake;                   /**< HistoryWake_t */
+    uint8_t awake;                  /**< Awake time (1/10 s), 255 for longer wakes */
+    uint8_t crc;                    /**< CRC-8 of the bytes before */
+} HistoryRecord_t;
+
+typedef struct __attribute__((packed)) HistoryPageHeader_t {
+    uint32_t magic;
+    uint32_t sequence;              /**< Counts the written pages, the highest one is the newest */
+    uint8_t version;
+    uint8_t count;                  /**< Records in this page */
+    uint16_t recordSize;
+    uint8_t reserved[19];
+    uint8_t crc;                    /**< CRC-8 of the bytes before */
+} HistoryPageHeader_t;
+
+static_assert(sizeof(HistoryRecord_t) == HISTORY_RECORD_SIZE, "history record size");
+static_assert(sizeof(HistoryPageHeader_t) == HISTORY_RECORD_SIZE, "history header size");
+
+/**
+ * @brief CRC-8 (polynomial 0x07)
+ */
+uint8_t historyCrc8(const uint8_t* data, size_t length);
+
+/**
+ * @brief Mark all values as not measured
+ */
+void historyClear(HistoryRecord_t& record);
+
+/**
+ * @brief Set the CRC of a record
+ */
+void historySeal(HistoryRecord_t& record);
+
+/**
+ * @brief Check the CRC of a record (erased records are invalid)
+ */
+bool historyIsValid(const HistoryRecord_t& record);
+
+/**
+ * @brief Fill the header of a page
+ */
+void historyPageHeader(HistoryPageHeader_t& header, uint32_t sequence, uint8_t count);
+
+/**
+ * @brief Check magic, version and CRC of a page header
+ */
+bool historyPageIsValid(const HistoryPageHeader_t& header);
+
+/**
+ * @brief Build a page from the header and the records, unused records stay erased
+ *
+ * @param page      HISTORY_PAGE_SIZE bytes
+ * @param records   sealed records
+ * @param count     up to HISTORY_PAGE_RECORDS
+ */
+void historyPageBuild(uint8_t* page, uint32_t sequence, const HistoryRecord_t* records, uint8_t count);
+
+/**
+ * @brief Values of a record in the order of the record, for the DeltaCodec
+ */
+void historyToChannels(const HistoryRecord_t& record, int32_t values[HISTORY_CHANNELS]);
+
+/**
+ * @brief Record from the values of historyToChannels(), sealed
+ */
+void historyFromChannels(HistoryRecord_t& record, uint32_t time, const int32_t values[HISTORY_CHANNELS]);
+
+/**
+ * @brief CSV header line (without line break)
+ * @param plant     only the columns of this plant, HISTORY_ALL_PLANTS for all
+ */
+size_t historyFormatHeader(char* buffer, size_t size, int plant);
+
+/**
+ * @brief Format one record as CSV line (without line break), unknown values are empty
+ * @return size_t   amount of written characters, 0 if the buffer is too small
+ */
+size_t historyFormat(char* buffer, size_t size, const HistoryRecord_t& record, int plant);
+
+#endif
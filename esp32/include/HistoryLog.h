@@ -0,0 +1,113 @@
+/**
+ * @file HistoryLog.h
+ * @author your name (you@domain.com)
+ * @brief Append-only history of all wakes in a dedicated flash partition
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The records are collected in the RTC memory, compressed with the DeltaCodec,
+ * and written as whole pages, when HISTORY_STAGED_RECORDS wakes are staged or
+ * the buffer is full; so the flash is written only every few wakes. The partition is used as a ring: the sector in front of the
+ * head is erased, which drops the oldest pages and wears all sectors evenly.
+ * After a power loss the head is found again by the highest page sequence.
+ * @see HistoryFormat.h and host/history for the decoder
+ */
+
+#ifndef HISTORY_LOG_H
+#define HISTORY_LOG_H
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "HistoryFormat.h"
+#include "DeltaCodec.h"
+
+#define HISTORY_PARTITION_LABEL     "history"
+#define HISTORY_PARTITION_SUBTYPE   0x99        /**< Custom data subtype, @see defaultWithSmallerSpiffs.csv */
+#define HISTORY_HEAD_UNKNOWN        0xFFFFFFFFUL
+#define HISTORY_STAGED_PAGES        2           /**< Pages collected in the RTC memory */
+#define HISTORY_STAGED_RECORDS      (HISTORY_STAGED_PAGES * HISTORY_PAGE_RECORDS)
+#define HISTORY_STAGING_SIZE        320         /**< Bytes of compressed records (about 20 bytes per wake) */
+
+/**
+ * @brief Staged records, survives the deep sleep
+ */
+typedef struct HistoryStaging_t {
+    uint32_t head;                                  /**< Offset of the next page, HISTORY_HEAD_UNKNOWN after power on */
+    uint32_t sequence;                              /**< Of the next page */
+    uint16_t count;                                 /**< Staged records */
+    uint16_t used;                                  /**< Bytes of data */
+    DeltaState_t encoder;                           /**< After the last staged record */
+    uint8_t data[HISTORY_STAGING_SIZE];             /**< DeltaCodec stream with HISTORY_CHANNELS */
+} HistoryStaging_t;
+
+class HistoryLog {
+    private:
+        HistoryStaging_t* mStaging = NULL;
+        const esp_partition_t* mPartition = NULL;
+        uint32_t mSize = 0;                         /**< Used bytes of the partition, whole sectors */
+
+        bool findHead(void);
+
+        /**
+         * @brief Stage a record, without writing
+         * @return false, if the buffer is full
+         */
+        bool stage(const HistoryRecord_t& record);
+
+        /**
+         * @brief Write the staged records as pages
+         * @param partial   also write the last, not full page; otherwise its records stay staged
+         */
+        bool writeStaged(bool partial);
+
+    public:
+        /**
+         * @brief Find the partition
+         * @param staging   kept by the caller in RTC memory, head HISTORY_HEAD_UNKNOWN after power on
+         * @return false, if the partition is missing
+         */
+        bool begin(HistoryStaging_t* staging);
+
+        /**
+         * @brief Stage the record of a wake, full pages are written to the flash
+         * @return false, if a page could not be written (its records are dropped)
+         */
+        bool append(const HistoryRecord_t& record);
+
+        /**
+         * @brief Write the staged records, even if the page is not full (e.g. before an update)
+         */
+        bool flush(void);
+
+        /**
+         * @brief Offset of the next page to write; the oldest pages follow it
+         */
+        uint32_t getHead(void);
+
+        /**
+         * @brief Used bytes of the partition
+         */
+        uint32_t getSize(void) { return this->mSize; }
+
+        /**
+         * @brief Read directly from the partition
+         */
+        bool read(uint32_t offset, void* data, size_t length);
+
+        /**
+         * @brief Records staged in the RTC memory, not written yet
+         * @return DeltaCodec stream with HISTORY_CHANNELS
+         */
+        const uint8_t* getStaged(size_t& length) {
+            length = (this->mStaging != NULL) ? this->mStaging->used : 0;
+            return (this->mStaging != NULL) ? this->mStaging->data : NULL;
+        }
+
+        /**
+         * @brief Amount of written pages since the partition was erased
+         */
+        uint32_t getSequence(void) { return (this->mStaging != NULL) ? this->mStaging->sequence : 0; }
+};
+
+#endif
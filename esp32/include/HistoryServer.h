@@ -0,0 +1,43 @@
+/**
+ * @file HistoryServer.h
+ * @author your name (you@domain.com)
+ * @brief HTTP download of the history, while the controller stays alive (mode3)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * GET /history[?from=<s>&to=<s>&plant=<0..6>] answers with CSV in chunked transfer
+ * encoding; every chunk is filled directly from the flash by HistoryStream.
+ * Only one download runs at a time, a second one is answered with 503.
+ */
+
+#ifndef HISTORY_SERVER_H
+#define HISTORY_SERVER_H
+
+#include <ESPAsyncWebServer.h>
+#include "HistoryLog.h"
+#include "HistoryStream.h"
+
+#define HISTORY_HTTP_PORT   80      /**< Free in normal mode, Homie only serves its configuration in config mode */
+#define HISTORY_HTTP_PATH   "/history"
+
+class HistoryServer {
+    private:
+        AsyncWebServer* mServer = NULL;
+        HistoryLog* mLog = NULL;
+        HistoryStream mStream;
+        volatile bool mStreaming = false;
+
+        static bool readLog(void* context, uint32_t offset, void* data, size_t length);
+        void handle(AsyncWebServerRequest* request);
+
+    public:
+        /**
+         * @brief Start the web server, the WiFi must be connected
+         */
+        void begin(HistoryLog* log);
+
+        bool isStarted(void) { return this->mServer != NULL; }
+};
+
+#endif
@@ -0,0 +1,88 @@
+/**
+ * @file HistoryStream.h
+ * @author your name (you@domain.com)
+ * @brief History records as CSV, in pieces of any size
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Feeds a chunked HTTP response: every call fills the given buffer, the records
+ * are read one by one from the flash (oldest first), followed by the staged ones.
+ * Only one CSV line is kept between two calls.
+ * Without Arduino dependencies, so it can be compiled on the host, too (host/history/server.cpp).
+ */
+
+#ifndef HISTORY_STREAM_H
+#define HISTORY_STREAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "HistoryFormat.h"
+#include "DeltaCodec.h"
+
+/**
+ * @brief Read from the history partition (or a dump of it)
+ * @return false on errors
+ */
+typedef bool (*HistoryRead_t)(void* context, uint32_t offset, void* data, size_t length);
+
+typedef struct HistoryFilter_t {
+    uint32_t from;          /**< Oldest wake time (s) */
+    uint32_t to;            /**< Newest wake time (s), 0 without limit */
+    int plant;              /**< Only the columns of this plant, HISTORY_ALL_PLANTS for all */
+} HistoryFilter_t;
+
+/**
+ * @brief All records, all plants
+ */
+void historyFilterClear(HistoryFilter_t& filter);
+
+class HistoryStream {
+    private:
+        HistoryRead_t mRead = 0;
+        void* mContext = 0;
+        uint32_t mSize = 0;                 /**< Bytes of the ring */
+        uint32_t mHead = 0;                 /**< Offset of the oldest page */
+        const uint8_t* mStaged = 0;
+        size_t mStagedLength = 0;
+        HistoryFilter_t mFilter;
+
+        uint32_t mPage = 0;                 /**< Visited pages */
+        uint8_t mSlot = 0;                  /**< Next record of the current page */
+        uint8_t mCount = 0;                 /**< Records of the current page */
+        size_t mStagedPosition = 0;
+        DeltaState_t mDecoder;              /**< Of the staged records */
+        bool mHeaderSent = false;
+
+        char mLine[HISTORY_LINE_SIZE + 1];  /**< With the line break */
+        size_t mLineLength = 0;
+        size_t mLinePosition = 0;
+
+        bool nextStored(HistoryRecord_t& record);
+        bool matches(const HistoryRecord_t& record) const;
+        bool nextLine(void);
+
+    public:
+        /**
+         * @param read      reads the partition
+         * @param size      used bytes of the partition
+         * @param head      offset of the next page, that is written
+         * @param staged    records, not written yet, as DeltaCodec stream (may be NULL)
+         */
+        void begin(HistoryRead_t read, void* context, uint32_t size, uint32_t head,
+                   const uint8_t* staged, size_t stagedLength, const HistoryFilter_t& filter);
+
+        /**
+         * @brief Next record, that passes the filter
+         * @return false at the end
+         */
+        bool next(HistoryRecord_t& record);
+
+        /**
+         * @brief Fill the buffer with the next CSV lines
+         * @return size_t   written bytes, 0 at the end
+         */
+        size_t fill(uint8_t* buffer, size_t size);
+};
+
+#endif
@@ -33,6 +33,7 @@ HomieNode sensorSolar("solar", "Solar Status", "Solarpanel");
 HomieNode sensorWater("water", "WaterSensor", "Water");
 HomieNode sensorTemp("temperature", "Temperature", "temperature");
 HomieNode stayAlive("stay", "alive", "alive");
+HomieNode systemStats("system", "System", "Statistics");
 
 /**
  *********************************** Settings *******************************
@@ -41,21 +42,31 @@ HomieNode stayAlive("stay", "alive", "alive");
 HomieSetting<long> deepSleepTime("deepsleep", "time in milliseconds to sleep (0 deactivats it)");
 HomieSetting<long> deepSleepNightTime("nightsleep", "time in milliseconds to sleep (0 uses same setting: deepsleep at night, too)");
 HomieSetting<long> wateringDeepSleep("pumpdeepsleep", "time seconds to sleep, while a pump is running");
+HomieSetting<long> homieWakes("homiewakes", "every n-th wake starts Homie, the others only publish the sensor values (0 always starts Homie)");
+HomieSetting<long> pumpCurrentBudget("pumpcurrent", "total current (mA) of the pumps running at once (0 runs one pump per wake)");
+HomieSetting<const char*> awakeBudget("awakebudget", "deadlines (ms) sense,wifi,mqtt,publish,water; empty fields use the defaults");
+HomieSetting<const char*> telemetryDeadband("deadband", "change needed to publish moist(%),temp(0.01C),water(mm),volume(ml),volt(0.01V),percent(%); empty fields use the defaults");
+HomieSetting<const char*> timeZone("timezone", "POSIX time zone (e.g. CET-1CEST,M3.5.0,M10.5.0/3), the daily statistics end at local midnight");
+HomieSetting<const char*> ntpServer("ntpserver", "SNTP server to synchronize the time (empty: not synchronized)");
+HomieSetting<long> telemetrySilence("maxsilence", "seconds after which an unchanged value is published again (0 publishes every wake)");
 
 HomieSetting<long> waterLevelMax("watermaxlevel", "distance (mm) at maximum water level");
 HomieSetting<long> waterLevelMin("waterminlevel", "distance (mm) at minimum water level (pumps still covered)");
 HomieSetting<long> waterLevelWarn("waterlevelwarn", "warn (mm) if below this water level %");
 HomieSetting<long> waterLevelVol("waterVolume", "(ml) between minimum and maximum");
+HomieSetting<long> pumpFlow("pumpflow", "water (ml) one pump delivers per minute, predicts the water level");
 
 /** Plant specific ones */
 
 #define GENERATE_PLANT(plant, strplant)   \
-        HomieSetting<long> mSensorDry##plant = HomieSetting<long>("moistdry" strplant, "Plant " strplant "- Moist sensor dry threshold"); \
+        HomieSetting<long> mSensorDry##plant = HomieSetting<long>("moistdry" strplant, "Plant " strplant "- Moist sensor dry threshold (raw ADC value)"); \
+        HomieSetting<long> mSensorDryPercent##plant = HomieSetting<long>("moistpercent" strplant, "Plant " strplant "- Moist dry threshold in percent, replaces moistdry once the sensor is calibrated (-1: not used)"); \
         HomieSetting<long> mPumpAllowedHourRangeStart##plant = HomieSetting<long>("rangehourstart" strplant, "Plant" strplant " - Range pump allowed hour start (0-23)"); \
         HomieSetting<long> mPumpAllowedHourRangeEnd##plant = HomieSetting<long>("rangehourend" strplant, "Plant" strplant " - Range pump allowed hour end (0-23)"); \
         HomieSetting<bool> mPumpOnlyWhenLowLight##plant = HomieSetting<bool>("onlyWhenLowLightZ" strplant, "Plant" strplant " - Enable the Pump only, when there is light but not enought to charge battery"); \
         HomieSetting<long> mPumpCooldownInHours##plant = HomieSetting<long>("cooldownpump" strplant, "Plant" strplant " - How long to wait until the pump is activated again (minutes)"); \
-        PlantSettings_t mSetting##plant = { &mSensorDry##plant, &mPumpAllowedHourRangeStart##plant, &mPumpAllowedHourRangeEnd##plant, &mPumpOnlyWhenLowLight##plant, &mPumpCooldownInHours##plant };
+        HomieSetting<long> mPumpMaxRuntime##plant = HomieSetting<long>("maxruntime" strplant, "Plant" strplant " - Maximum time the pump runs at once (seconds)"); \
+        PlantSettings_t mSetting##plant = { &mSensorDry##plant, &mSensorDryPercent##plant, &mPumpAllowedHourRangeStart##plant, &mPumpAllowedHourRangeEnd##plant, &mPumpOnlyWhenLowLight##plant, &mPumpCooldownInHours##plant, &mPumpMaxRuntime##plant };
         
 GENERATE_PLANT(0, "0");
 GENERATE_PLANT(1, "1");
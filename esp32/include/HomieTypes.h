@@ -12,15 +12,16 @@
 #define HOMIE_PLANT_CFG_CONFIG_H
 
 #include <Homie.h>
-
-#define DEACTIVATED_PLANT   5000
+#include "ControlLogic.h"
 
 typedef struct PlantSettings_t {
     HomieSetting<long>* pSensorDry;
+    HomieSetting<long>* pSensorDryPercent;
     HomieSetting<long>* pPumpAllowedHourRangeStart;
     HomieSetting<long>* pPumpAllowedHourRangeEnd;
     HomieSetting<bool>* pPumpOnlyWhenLowLight;
     HomieSetting<long>* pPumpCooldownInHours;
+    HomieSetting<long>* pPumpMaxRuntime;
 } PlantSettings_t;
 
 #endif
\ No newline at end of file
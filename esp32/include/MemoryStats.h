@@ -0,0 +1,68 @@
+/**
+ * @file MemoryStats.h
+ * @author your name (you@domain.com)
+ * @brief Heap, stack and RTC memory usage of one wake
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <Arduino.h>
+
+#define RTC_SLOW_MEMORY_SIZE    8192    /**< Size of the RTC slow memory of the ESP32 */
+
+#define TASK_NAME_LOOP          "loopTask"  /**< Arduino task, running setup() and loop() */
+#define TASK_NAME_WIFI          "wifi"      /**< WiFi driver task of the IDF */
+#define TASK_NAME_MQTT          "async_tcp" /**< AsyncTCP task, handling the MQTT callbacks */
+
+#define STACK_UNKNOWN           -1      /**< Task is not running */
+
+class MemoryStats {
+    private:
+        uint32_t mLargestFreeBlock = UINT32_MAX;
+        long mStackLoop = STACK_UNKNOWN;
+        long mStackWifi = STACK_UNKNOWN;
+        long mStackMqtt = STACK_UNKNOWN;
+
+        static long stackHighWaterMark(const char* taskName);
+
+    public:
+        /**
+         * @brief Capture the current values
+         * Call this at the points with the highest usage (e.g. after connecting and after publishing);
+         * the minimum of all samples of this wake is kept.
+         */
+        void sample(void);
+
+        /**
+         * @brief Lowest amount of free heap (bytes) since this wake started
+         */
+        uint32_t getMinFreeHeap(void);
+
+        /**
+         * @brief Smallest "largest free block" (bytes) of all samples
+         */
+        uint32_t getLargestFreeBlock(void) { return mLargestFreeBlock; }
+
+        /**
+         * @brief Unused stack in bytes, that was never touched
+         * @return STACK_UNKNOWN, if the task was not found
+         */
+        long getStackLoop(void) { return mStackLoop; }
+        long getStackWifi(void) { return mStackWifi; }
+        long getStackMqtt(void) { return mStackMqtt; }
+
+        /**
+         * @brief Used RTC slow memory, calculated from the linker sections
+         *
+         * @return size_t bytes in .rtc.data, .rtc.bss and .rtc_noinit
+         */
+        static size_t getRtcUsage(void);
+};
+
+#endif
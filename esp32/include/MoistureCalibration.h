@@ -0,0 +1,65 @@
+/**
+ * @file MoistureCalibration.h
+ * @author your name (you@domain.com)
+ * @brief Two point calibration of the moisture sensors
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Every plant has a dry and a wet point (raw ADC values, captured in stay alive mode).
+ * From these points a lookup table per plant is built once, so the conversion of a
+ * reading into percent needs one table access and an integer interpolation.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef MOISTURE_CALIBRATION_H
+#define MOISTURE_CALIBRATION_H
+
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define CALIBRATION_TABLE_SIZE  256
+#define CALIBRATION_TABLE_SHIFT 4       /**< 12 bit ADC value to the table index */
+#define CALIBRATION_FRACTION    8       /**< Fixed point table entries: percent * 256 */
+#define CALIBRATION_ADC_MAX     4095
+#define CALIBRATION_UNSET       0xFFFF
+#define CALIBRATION_MIN_SPAN    100     /**< ADC steps between dry and wet, that are required */
+
+typedef struct CalibrationPoints_t {
+    uint16_t dry;   /**< ADC value in dry soil, CALIBRATION_UNSET if not captured */
+    uint16_t wet;   /**< ADC value in water, CALIBRATION_UNSET if not captured */
+} CalibrationPoints_t;
+
+void calibrationClear(CalibrationPoints_t& points);
+
+/**
+ * @brief Both points are captured and far enough apart
+ */
+bool calibrationIsValid(const CalibrationPoints_t& points);
+
+class MoistureCalibration {
+    private:
+        uint16_t mTables[MAX_PLANTS][CALIBRATION_TABLE_SIZE];   /**< percent at the start of each ADC step */
+        bool mCalibrated[MAX_PLANTS];
+
+    public:
+        /**
+         * @brief All plants uncalibrated: the percent is relative to the full ADC range
+         */
+        MoistureCalibration();
+
+        /**
+         * @brief Build the lookup table of a plant
+         * Invalid points reset the plant to the full ADC range.
+         */
+        void setPoints(int plant, const CalibrationPoints_t& points);
+
+        bool isCalibrated(int plant) const;
+
+        /**
+         * @brief Moisture in percent (0: dry point, 100: wet point)
+         */
+        int getPercent(int plant, int adc) const;
+};
+
+#endif
@@ -0,0 +1,62 @@
+/**
+ * @file MqttFastPath.h
+ * @author your name (you@domain.com)
+ * @brief Publish the sensor values without the Homie bootstrap
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The WiFi and broker settings of the last full Homie start are kept in the RTC memory.
+ * With them, a wake only connects to the broker, publishes the telemetry topics and
+ * sleeps again. SPIFFS, the JSON configuration and the Homie advertising are skipped.
+ */
+
+#ifndef MQTT_FAST_PATH_H
+#define MQTT_FAST_PATH_H
+
+#include <Homie.h>
+#include "TelemetryPublisher.h"
+#include "AwakeBudget.h"
+
+#define FASTPATH_SSID_SIZE      33
+#define FASTPATH_PASSWORD_SIZE  65
+#define FASTPATH_HOST_SIZE      64
+#define FASTPATH_TOPIC_SIZE     49
+#define FASTPATH_ID_SIZE        33
+#define FASTPATH_CREDS_SIZE     33
+
+class MqttFastPath {
+    public:
+        /**
+         * @brief Keep the settings of the running Homie configuration
+         * Must be called, when Homie is connected (MQTT_READY)
+         *
+         * @param config      loaded Homie configuration
+         * @param homieWakes  every n-th wake runs the full Homie setup (0 disables the fast path)
+         */
+        void store(const HomieInternals::ConfigStruct& config, long homieWakes);
+
+        /**
+         * @brief Check, if the stored settings can be used
+         */
+        bool isEnabled(void);
+
+        /**
+         * @brief Count this wake and check, if Homie must be started
+         * @return true, when the last full Homie start is homieWakes ago
+         */
+        bool isFullSetupDue(void);
+
+        /**
+         * @brief Connect, publish and disconnect
+         * Blocks until all messages are acknowledged by the broker or a deadline is reached.
+         *
+         * @param publisher      used to publish, prepared with the stored topic
+         * @param publishValues  publishes all values with the given publisher
+         * @param budget         deadlines of the WiFi, MQTT and publish phase
+         * @return true          all values are published
+         */
+        bool run(TelemetryPublisher* publisher, void (*publishValues)(void), AwakeBudget* budget);
+};
+
+#endif
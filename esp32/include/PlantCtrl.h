@@ -83,11 +83,34 @@ public:
         return mPlant->setProperty(property);
     }
 
+    /**
+     * @brief Get the id of the Homie node, used for the MQTT topic
+     */
+    const char* getNodeId() const {
+        return mPlant->getId();
+    }
+
     void init(void);
 
     long getSettingSensorDry() {
         return this->mSetting->pSensorDry->get();
     }
+
+    /**
+     * @brief Dry threshold in percent of the calibrated sensor
+     * @return long MOIST_PERCENT_UNUSED, if the raw threshold (moistdry) is used
+     */
+    long getSettingSensorDryPercent() {
+        return this->mSetting->pSensorDryPercent->get();
+    }
+
+    /**
+     * @brief Maximum time, the pump may run at once
+     * @return long milliseconds
+     */
+    long getSettingMaxRuntime() {
+        return this->mSetting->pPumpMaxRuntime->get() * 1000;
+    }
 };
 
 #endif
@@ -0,0 +1,148 @@
+/**
+ * @file PumpControl.h
+ * @author your name (you@domain.com)
+ * @brief Pump task with a hard deadline for every running pump
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The pump GPIOs are only switched by this task. Commands are placed in a
+ * mailbox per pump (one atomic word, the last command wins), so Homie, MQTT
+ * callbacks and the loop never block each other.
+ * A hardware timer fires at the earliest deadline and wakes the task, which
+ * runs with the highest priority on the core without WiFi.
+ * Each pump is soft-started with a LEDC duty ramp. Several pumps run at once,
+ * as long as the sum of their estimated currents fits into the current budget;
+ * the others wait until a running pump is switched off. The current of each
+ * pump is estimated from the supply voltage sag, after its ramp finished.
+ */
+
+#ifndef PUMP_CONTROL_H
+#define PUMP_CONTROL_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#define PUMP_MAX_PUMPS              7
+#define PUMP_DEFAULT_MAX_RUNTIME    30000       /**< Used until the settings are loaded (ms) */
+#define PUMP_TASK_STACK             2048
+#define PUMP_TASK_CORE              1           /**< WiFi runs on core 0 */
+#define PUMP_TIMER                  0           /**< Hardware timer, used for the deadline */
+#define PUMP_TIMER_DIVIDER          80          /**< 80 MHz APB clock, one tick per microsecond */
+
+#define PUMP_LEDC_CHANNEL           0           /**< First LEDC channel, one per pump */
+#define PUMP_LEDC_FREQUENCY         20000       /**< Hz, above the audible range */
+#define PUMP_LEDC_RESOLUTION        8           /**< bit */
+#define PUMP_LEDC_MAX_DUTY          ((1 << PUMP_LEDC_RESOLUTION) - 1)
+#define PUMP_SOFTSTART_TIME         200         /**< ms from off to full duty */
+#define PUMP_SOFTSTART_STEP         10          /**< ms between two duty steps */
+#define PUMP_SAG_DELAY              50          /**< ms after the ramp, until the supply is measured */
+
+#define PUMP_DEFAULT_CURRENT        350         /**< mA, until the current of a pump is measured */
+#define PUMP_MIN_CURRENT            50          /**< mA, lower limit of the estimation */
+#define PUMP_MAX_CURRENT            2000        /**< mA, upper limit of the estimation */
+#define PUMP_SUPPLY_RESISTANCE      250         /**< mOhm, internal resistance of the lipo and the wiring */
+
+#define PUMP_CMD_NONE               0UL
+#define PUMP_CMD_STOP               1UL
+#define PUMP_CMD_START              0x80000000UL /**< Combined with the requested runtime (ms) */
+
+class PumpControl {
+    private:
+        int mPins[PUMP_MAX_PUMPS];
+        int mEnablePin = -1;
+        int mSupplyPin = -1;
+        int mPumps = 0;
+
+        volatile uint32_t mMailbox[PUMP_MAX_PUMPS];
+        volatile uint32_t mMaxRuntime[PUMP_MAX_PUMPS];  /**< ms */
+        int64_t mDeadline[PUMP_MAX_PUMPS];              /**< esp_timer time (us), 0 if off */
+        volatile uint32_t mRunningMask = 0;
+        volatile uint32_t mPendingMask = 0;             /**< Started, but waiting for the current budget */
+        uint32_t mPendingRuntime[PUMP_MAX_PUMPS];       /**< ms, requested by the pending pumps */
+
+        int64_t mRunStart[PUMP_MAX_PUMPS];              /**< esp_timer time (us) of the start */
+        volatile uint32_t mRunTime[PUMP_MAX_PUMPS];     /**< ms of all finished runs */
+        int64_t mRampStart[PUMP_MAX_PUMPS];             /**< esp_timer time (us), 0 after the sag is measured */
+        uint16_t mSupplyBefore[PUMP_MAX_PUMPS];         /**< ADC value of the supply, before the pump started */
+        uint16_t* mCurrent = NULL;                      /**< mA per pump, kept by the caller */
+        uint16_t mCurrentBudget = 0;                    /**< mA of all running pumps, 0 runs one pump at a time */
+
+        TaskHandle_t mTask = NULL;
+        hw_timer_t* mTimer = NULL;
+
+        static void taskMain(void* parameter);
+        static void IRAM_ATTR onTimer(void);
+
+        void post(int pump, uint32_t command);
+        void process(void);
+        void switchPump(int pump, bool on);
+        void armTimer(int64_t now);
+        void startPending(int64_t now);
+        bool ramp(int64_t now);
+        bool fitsBudget(int pump);
+        uint16_t getCurrent(int pump);
+
+    public:
+        /**
+         * @brief Start the pump task, all pumps are switched off
+         *
+         * @param pins       GPIOs of the pumps
+         * @param count      amount of pumps
+         * @param enablePin  GPIO enabling the pump power, -1 if not present
+         * @param supplyPin  ADC1 GPIO measuring the supply (lipo), -1 if not present
+         */
+        void begin(const int* pins, int count, int enablePin, int supplyPin = -1);
+
+        /**
+         * @brief Limit the current of all pumps running at once
+         *
+         * @param milliAmpere  0 runs only one pump at a time
+         * @param currents     estimated current (mA) per pump, 0 if unknown; updated after each start
+         */
+        void setCurrentBudget(uint16_t milliAmpere, uint16_t* currents);
+
+        /**
+         * @brief Limit the runtime of one pump
+         * @param milliseconds  0 uses PUMP_DEFAULT_MAX_RUNTIME
+         */
+        void setMaxRuntime(int pump, uint32_t milliseconds);
+
+        /**
+         * @brief Request to start a pump
+         * Can be called from any task, the pump is switched off after the runtime,
+         * but at the latest after its maximum runtime. The runtime is counted from the
+         * moment, the current budget allows the pump to start.
+         *
+         * @param milliseconds  requested runtime, 0 uses the maximum runtime
+         */
+        void start(int pump, uint32_t milliseconds = 0);
+
+        /**
+         * @brief Request to stop a pump
+         */
+        void stop(int pump);
+
+        /**
+         * @brief Request to stop all pumps, e.g. before sleeping
+         */
+        void stopAll(void);
+
+        /**
+         * @brief Time (ms) the pump ran since begin(), without the current run
+         */
+        uint32_t getRunTime(int pump);
+
+        /**
+         * @brief Check, if at least one pump is running (or requested or waiting to run)
+         */
+        bool isActive(void);
+
+        /**
+         * @brief Check, if one pump is running (or requested or waiting to run)
+         */
+        bool isRunning(int pump);
+};
+
+#endif
@@ -0,0 +1,102 @@
+/**
+ * @file SampleRing.h
+ * @author your name (you@domain.com)
+ * @brief Lock-free ring of timestamped sensor samples
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * One producer (e.g. the acquisition task) and one consumer (e.g. the publisher)
+ * per ring; both only write their own index, so no lock is needed.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum SampleType_t {
+    SAMPLE_MOISTURE = 0,    /**< channel: plant, value: ADC */
+    SAMPLE_TEMPERATURE,     /**< channel: TEMP_CHANNEL_*, value: °C */
+    SAMPLE_WATER,           /**< value: distance to the water surface (mm) */
+    SAMPLE_LIPO,            /**< value: ADC */
+    SAMPLE_SOLAR,           /**< value: ADC */
+    SAMPLE_ECHO,            /**< value: duration of the ultrasonic echo (us) */
+    SAMPLE_SETTLE,          /**< channel: plant or SETTLE_CHANNEL_TEMP, value: settle time (ms) */
+    SAMPLE_TYPES
+} SampleType_t;
+
+#define TEMP_CHANNEL_AIR        0   /**< First DS18B20, if two are present */
+#define TEMP_CHANNEL_CONTROL    1   /**< DS18B20 next to the controller (and lipo) */
+
+typedef struct SensorSample_t {
+    uint32_t timestamp;     /**< ms since the wake */
+    uint8_t type;           /**< @see SampleType_t */
+    uint8_t channel;
+    float value;
+} SensorSample_t;
+
+/**
+ * @brief Single producer, single consumer ring
+ *
+ * @tparam T    element type, copied by value
+ * @tparam N    capacity, must be a power of two
+ */
+template <typename T, size_t N>
+class SampleRing {
+    static_assert((N > 0) && ((N & (N - 1)) == 0), "capacity must be a power of two");
+
+    private:
+        T mItems[N];
+        uint32_t mHead = 0;     /**< written by the producer only */
+        uint32_t mTail = 0;     /**< written by the consumer only */
+        uint32_t mDropped = 0;  /**< samples lost, because the ring was full */
+
+    public:
+        /**
+         * @brief Add an element (producer)
+         * @return false, if the ring is full; the element is dropped
+         */
+        bool push(const T& item) {
+            uint32_t head = __atomic_load_n(&mHead, __ATOMIC_RELAXED);
+            uint32_t tail = __atomic_load_n(&mTail, __ATOMIC_ACQUIRE);
+            if ((uint32_t) (head - tail) >= N) {
+                __atomic_store_n(&mDropped, mDropped + 1, __ATOMIC_RELAXED);
+                return false;
+            }
+            mItems[head & (N - 1)] = item;
+            __atomic_store_n(&mHead, head + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /**
+         * @brief Take the oldest element (consumer)
+         * @return false, if the ring is empty
+         */
+        bool pop(T& item) {
+            uint32_t tail = __atomic_load_n(&mTail, __ATOMIC_RELAXED);
+            uint32_t head = __atomic_load_n(&mHead, __ATOMIC_ACQUIRE);
+            if (head == tail) {
+                return false;
+            }
+            item = mItems[tail & (N - 1)];
+            __atomic_store_n(&mTail, tail + 1, __ATOMIC_RELEASE);
+            return true;
+        }
+
+        /**
+         * @brief Amount of elements, that can be taken
+         * Exact for the consumer, a lower bound for the producer
+         */
+        size_t size() const {
+            return (uint32_t) (__atomic_load_n(&mHead, __ATOMIC_ACQUIRE) - __atomic_load_n(&mTail, __ATOMIC_ACQUIRE));
+        }
+
+        size_t capacity() const { return N; }
+
+        uint32_t getDropped() const { return __atomic_load_n(&mDropped, __ATOMIC_RELAXED); }
+};
+
+#endif
@@ -0,0 +1,69 @@
+/**
+ * @file SensorSettle.h
+ * @author your name (you@domain.com)
+ * @brief Detects, when a freshly powered sensor delivers stable values
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The sensors are sampled at short intervals after power on; a channel is settled
+ * once successive readings stay within a tolerance. The settle time of the last
+ * wakes is learned per channel (kept in the RTC memory by the caller), so an early,
+ * accidental plateau is not taken for the settled value.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef SENSOR_SETTLE_H
+#define SENSOR_SETTLE_H
+
+#include <stdint.h>
+
+#define SETTLE_STABLE_READINGS  2   /**< Successive differences within the tolerance */
+
+class SensorSettle {
+    private:
+        uint32_t mStart = 0;
+        uint32_t mMinimum = 0;      /**< ms, stable readings before are ignored */
+        uint32_t mMaximum = 0;      /**< ms, upper bound */
+        float mTolerance = 0;
+        float mLast = 0;
+        bool mHasLast = false;
+        int mStable = 0;
+        uint32_t mSettleTime = 0;
+        bool mDone = false;
+        bool mTimedOut = false;
+
+    public:
+        /**
+         * @brief Start the detection, directly after the sensor was powered
+         *
+         * @param now       ms
+         * @param learned   ms, learned settle time of the channel (0: unknown)
+         * @param maximum   ms, the channel is used after this time in any case
+         * @param tolerance maximum difference of successive readings
+         */
+        void begin(uint32_t now, uint16_t learned, uint32_t maximum, float tolerance);
+
+        /**
+         * @brief Add a reading
+         * @param valid false for readings, that are known to be wrong (e.g. the power on value)
+         * @return true, if the channel is settled or timed out
+         */
+        bool add(uint32_t now, float value, bool valid = true);
+
+        bool isDone() const { return mDone; }
+        bool isTimedOut() const { return mTimedOut; }
+
+        /**
+         * @brief ms from the power on, until the channel was settled
+         */
+        uint32_t getSettleTime() const { return mSettleTime; }
+
+        /**
+         * @brief Learned settle time for the next wake
+         * @param learned   value, that was given to begin()
+         */
+        uint16_t learn(uint16_t learned) const;
+};
+
+#endif
@@ -0,0 +1,90 @@
+/**
+ * @file TankEstimator.h
+ * @author your name (you@domain.com)
+ * @brief Water level of the tank, estimated from the pump runs and the ultrasonic sensor
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * A one dimensional Kalman filter in fixed-point: the level (distance of the
+ * sensor to the surface) is predicted from the water, the pumps moved since the
+ * last wake, and corrected with one ping per wake. Pings outside of the
+ * 3 sigma gate (ripple, echo of the wall) are rejected; several rejected pings
+ * in a row are taken as a refilled tank and restart the filter.
+ * The state is kept by the caller in RTC memory.
+ * Without Arduino dependencies, so it can be compiled on the host, too.
+ */
+
+#ifndef TANK_ESTIMATOR_H
+#define TANK_ESTIMATOR_H
+
+#include <stdint.h>
+
+#define TANK_FRACTION_BITS          8           /**< Q8 for the level and the variance */
+#define TANK_MEASUREMENT_VARIANCE   100         /**< mm^2, noise of one ping (10 mm) */
+#define TANK_PROCESS_VARIANCE       4           /**< mm^2 per wake, evaporation and leaks */
+#define TANK_PUMP_UNCERTAINTY       10          /**< 1/n of the predicted drop is its standard deviation */
+#define TANK_MAX_VARIANCE           1000000     /**< mm^2, the level is unknown */
+#define TANK_GATE_SIGMA             3           /**< Pings further away are rejected */
+#define TANK_MAX_REJECTED           3           /**< Rejected pings in a row, until the filter restarts */
+#define TANK_FILL_SCALE             1000        /**< getFill() in per mille */
+
+typedef struct TankState_t {
+    int32_t level;          /**< mm, Q8 */
+    uint32_t variance;      /**< mm^2, Q8 */
+    int32_t pending;        /**< mm, Q8, change of the level by the pumps, not predicted yet */
+    uint8_t rejected;       /**< Pings in a row outside of the gate */
+    uint8_t valid;          /**< At least one ping was accepted */
+} TankState_t;
+
+class TankEstimator {
+    private:
+        TankState_t* mState = 0;
+
+        void predict(void);
+        void restart(int32_t measured);
+
+    public:
+        /**
+         * @param state kept by the caller (RTC memory), all zero at the first start
+         */
+        void begin(TankState_t* state);
+
+        /**
+         * @brief Add the water of a pump run, it is predicted with the next update()
+         *
+         * @param millilitre    pumped water
+         * @param minLevel      distance (mm) at the minimum water level
+         * @param maxLevel      distance (mm) at the maximum water level
+         * @param volume        water (ml) between minimum and maximum
+         */
+        void addPumped(long millilitre, long minLevel, long maxLevel, long volume);
+
+        /**
+         * @brief Predict and correct with one ping
+         *
+         * @param measured  distance (mm), 0 if there was no echo (only predicted)
+         * @return true     if the ping was used
+         */
+        bool update(long measured);
+
+        bool isValid(void) const { return (this->mState != 0) && this->mState->valid; }
+
+        /**
+         * @brief Estimated distance (mm) of the sensor to the surface
+         */
+        long getLevel(void) const;
+
+        /**
+         * @brief Standard deviation (mm) of the estimation
+         */
+        long getDeviation(void) const;
+
+        /**
+         * @brief Fill of the tank between the minimum (0) and maximum level (TANK_FILL_SCALE)
+         * Works for both orientations of the two levels.
+         */
+        static long getFill(long level, long minLevel, long maxLevel);
+};
+
+#endif
@@ -0,0 +1,48 @@
+/**
+ * @file TelemetryFormat.h
+ * @author your name (you@domain.com)
+ * @brief Format the telemetry values into fixed buffers
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Without Arduino dependencies, so it can be compiled on the host, too
+ * (host/telemetry/benchmark.cpp compares it with the String path).
+ */
+
+#ifndef TELEMETRY_FORMAT_H
+#define TELEMETRY_FORMAT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define TELEMETRY_VALUE_SIZE    16  /**< Enough for a signed 32bit value with decimal point */
+
+/**
+ * @brief Format a signed integer
+ *
+ * @param buffer    destination, is always terminated
+ * @param size      size of the destination
+ * @return size_t   amount of written characters (without termination)
+ */
+size_t formatLong(char* buffer, size_t size, long value);
+
+/**
+ * @brief Format a fixed point value
+ * e.g. value 1234 with 2 decimals results in "12.34"
+ *
+ * @param value     value multiplied with 10^decimals
+ * @param decimals  digits behind the decimal point
+ * @return size_t   amount of written characters (without termination)
+ */
+size_t formatFixed(char* buffer, size_t size, long value, uint8_t decimals);
+
+/**
+ * @brief Format a float, rounded to the given decimals
+ * The output is the same as String(value, decimals)
+ *
+ * @return size_t   amount of written characters (without termination)
+ */
+size_t formatFloat(char* buffer, size_t size, float value, uint8_t decimals);
+
+#endif
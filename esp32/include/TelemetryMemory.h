@@ -0,0 +1,95 @@
+/**
+ * @file TelemetryMemory.h
+ * @author your name (you@domain.com)
+ * @brief Deadbands and last published values of the telemetry
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Decides, if a value must be published, without Arduino dependencies: the fast path
+ * checks it before the WiFi is started, the simulator on the host runs the same decision.
+ */
+
+#ifndef TELEMETRY_MEMORY_H
+#define TELEMETRY_MEMORY_H
+
+#include <stdint.h>
+#include "ControllerConfiguration.h"
+
+#define TELEMETRY_SILENCE_DEFAULT   3600    /**< s, a value is repeated at least once an hour */
+
+/**
+ * @brief Properties, whose last published value is remembered
+ */
+typedef enum TelemetryProperty_t {
+    TELEMETRY_MOIST = 0,                                /**< + plant */
+    TELEMETRY_SWITCH = TELEMETRY_MOIST + MAX_PLANTS,    /**< + plant */
+    TELEMETRY_TEMP = TELEMETRY_SWITCH + MAX_PLANTS,
+    TELEMETRY_TEMP_CONTROL,
+    TELEMETRY_WATER_REMAINING,
+    TELEMETRY_WATER_VOLUME,
+    TELEMETRY_WATER_WARNING,
+    TELEMETRY_LIPO_PERCENT,
+    TELEMETRY_LIPO_VOLT,
+    TELEMETRY_SOLAR_PERCENT,
+    TELEMETRY_SOLAR_VOLT,
+    TELEMETRY_PROPERTIES
+} TelemetryProperty_t;
+
+/**
+ * @brief Deadbands, in the unit of the published value (temperature and volt in 1/100)
+ * Each one is shared by the properties of the same kind.
+ */
+typedef enum TelemetryDeadband_t {
+    DEADBAND_MOIST = 0,     /**< % */
+    DEADBAND_TEMP,          /**< 0.01 degree */
+    DEADBAND_WATER,         /**< mm */
+    DEADBAND_VOLUME,        /**< ml */
+    DEADBAND_VOLT,          /**< 0.01 V */
+    DEADBAND_PERCENT,       /**< % of lipo and solar */
+    TELEMETRY_DEADBANDS,
+    DEADBAND_STATE = TELEMETRY_DEADBANDS    /**< Switches and warnings, sent on every change only */
+} TelemetryDeadband_t;
+
+#define DEADBAND_MOIST_DEFAULT      1
+#define DEADBAND_TEMP_DEFAULT       20
+#define DEADBAND_WATER_DEFAULT      5
+#define DEADBAND_VOLUME_DEFAULT     100
+#define DEADBAND_VOLT_DEFAULT       5
+#define DEADBAND_PERCENT_DEFAULT    1
+
+typedef struct TelemetryLast_t {
+    int32_t value;
+    uint32_t time;          /**< s, 0 if never published */
+} TelemetryLast_t;
+
+/**
+ * @brief Survives the deep sleep (RTC_DATA_ATTR)
+ * All zero after a power on, so every value is published once.
+ */
+typedef struct TelemetryMemory_t {
+    uint16_t deadband[TELEMETRY_DEADBANDS];
+    uint32_t maxSilence;    /**< s, 0 repeats the values on every wake */
+    TelemetryLast_t last[TELEMETRY_PROPERTIES];
+} TelemetryMemory_t;
+
+/**
+ * @brief Parse the setting "moist,temp,water,volume,volt,percent" (empty fields use the defaults)
+ * @return false, if the text is malformed; the deadbands are unchanged then
+ */
+bool telemetryParseDeadbands(const char* text, uint16_t deadband[TELEMETRY_DEADBANDS]);
+
+/**
+ * @brief Compare with the last published value
+ *
+ * @param now       time of this wake (s), not 0
+ * @return true, if the value left its deadband, changed (states) or the maximum silence is over
+ */
+bool telemetryIsDue(const TelemetryMemory_t& memory, TelemetryProperty_t property, long value, uint32_t now);
+
+/**
+ * @brief Keep a published value
+ */
+void telemetryRemember(TelemetryMemory_t& memory, TelemetryProperty_t property, long value, uint32_t now);
+
+#endif
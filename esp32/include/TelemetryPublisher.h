@@ -0,0 +1,130 @@
+/**
+ * @file TelemetryPublisher.h
+ * @author your name (you@domain.com)
+ * @brief Publish sensor values without heap allocation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * The numbers are formatted into fixed buffers and handed directly
+ * to the MQTT client, the topics are the same as the Homie ones:
+ * <base topic><device id>/<node>/<property>
+ * The last published value of each sensor property is kept in the RTC memory;
+ * a value is only sent again, if it left its deadband or the maximum silence is over.
+ */
+
+#ifndef TELEMETRY_PUBLISHER_H
+#define TELEMETRY_PUBLISHER_H
+
+#include <Arduino.h>
+#include <AsyncMqttClient.h>
+#include "ControllerConfiguration.h"
+#include "TelemetryMemory.h"
+#include "TelemetryFormat.h"
+
+#define TELEMETRY_TOPIC_SIZE    128 /**< Base topic (48) + device id (32) + node and property */
+#define TELEMETRY_QOS           1   /**< Same QoS as used by Homie for properties */
+
+class TelemetryPublisher {
+    private:
+        AsyncMqttClient* mClient = NULL;
+        char mTopic[TELEMETRY_TOPIC_SIZE];
+        size_t mPrefixLength = 0;
+        uint16_t mPublished = 0;
+        uint16_t mSuppressed = 0;
+        TelemetryMemory_t* mMemory = NULL;
+        uint32_t mNow = 0;
+        bool mProbe = false;
+        bool mProbeDue = false;
+
+        /**
+         * @brief Append node and property to the prepared prefix
+         * @return false, if the topic does not fit into the buffer
+         */
+        bool buildTopic(const char* node, const char* property);
+
+        /**
+         * @brief Compare with the last published value
+         * @return true, if the value must be published
+         */
+        bool isDue(TelemetryProperty_t property, long value);
+
+        void remember(TelemetryProperty_t property, long value);
+
+    public:
+        /**
+         * @brief Prepare the topic prefix
+         * Must be called, after the configuration is loaded (e.g. on MQTT_READY)
+         *
+         * @param client     connected MQTT client
+         * @param baseTopic  Homie base topic, ending with a slash
+         * @param deviceId   Homie device id
+         */
+        void begin(AsyncMqttClient* client, const char* baseTopic, const char* deviceId);
+
+        bool isReady() { return (this->mClient != NULL) && (this->mPrefixLength > 0); }
+
+        /**
+         * @brief Amount of messages handed to the MQTT client since begin()
+         */
+        uint16_t getPublishCount() { return this->mPublished; }
+
+        /**
+         * @brief Amount of values, that were not sent, as they did not change
+         */
+        uint16_t getSuppressedCount() { return this->mSuppressed; }
+
+        /**
+         * @brief Remember the published values across the deep sleep
+         * Without a memory, every value is published.
+         *
+         * @param memory    kept in the RTC memory
+         * @param now       time of this wake (s)
+         */
+        void setMemory(TelemetryMemory_t* memory, uint32_t now);
+
+        /**
+         * @brief Only check the values, until stopProbe(): nothing is sent or remembered
+         * Used to skip the connection, if no value is due.
+         */
+        void startProbe(void) { this->mProbe = true; this->mProbeDue = false; }
+        void stopProbe(void) { this->mProbe = false; }
+
+        /**
+         * @brief A probed value left its deadband, changed or must be repeated
+         */
+        bool isProbeDue(void) { return this->mProbeDue; }
+
+        /**
+         * @brief Publish an already formatted payload
+         *
+         * @return uint16_t packet id (0 on errors)
+         */
+        uint16_t publish(const char* node, const char* property, const char* payload, size_t length, bool retained = true);
+
+        uint16_t publishLong(const char* node, const char* property, long value, bool retained = true);
+        uint16_t publishFixed(const char* node, const char* property, long value, uint8_t decimals, bool retained = true);
+        uint16_t publishFloat(const char* node, const char* property, float value, uint8_t decimals = 2, bool retained = true);
+
+        /**
+         * @brief Publish a fixed point value (retained), if it left its deadband
+         * @return uint16_t packet id (0 on errors or if not sent)
+         */
+        uint16_t publishChanged(TelemetryProperty_t slot, const char* node, const char* property, long value, uint8_t decimals = 0);
+
+        /**
+         * @brief Publish a state (retained), if it changed
+         */
+        uint16_t publishStateChanged(TelemetryProperty_t slot, const char* node, const char* property, bool state,
+                                     const char* onText, const char* offText);
+};
+
+#ifdef TELEMETRY_BENCHMARK
+/**
+ * @brief Compare the heap usage of String based and buffer based formatting
+ * Requires the linker flags -Wl,--wrap=malloc,--wrap=realloc (see platformio.ini)
+ */
+void telemetryBenchmark(void);
+#endif
+
+#endif
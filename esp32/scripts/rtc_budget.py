@@ -0,0 +1,74 @@
+#!/usr/bin/env python
+"""
+PlatformIO post build script: fail the build, when the variables in the RTC slow memory
+(RTC_DATA_ATTR, RTC_NOINIT_ATTR) exceed the budget.
+
+The budget is configured in platformio.ini:
+    custom_rtc_budget = 4096
+
+The script can also be used standalone:
+    python scripts/rtc_budget.py .pio/build/esp32doit-devkit-v1/firmware.elf 4096
+"""
+
+from __future__ import print_function
+import struct
+import sys
+
+RTC_SECTIONS = (".rtc.data", ".rtc.bss", ".rtc_noinit")
+DEFAULT_BUDGET = 4096
+
+
+def section_sizes(elf_path):
+    """ Return a dict with the size of each section of a 32bit little endian ELF file """
+    with open(elf_path, "rb") as elf:
+        data = elf.read()
+    if data[:4] != b"\x7fELF" or data[4:5] != b"\x01":
+        raise ValueError("{} is no 32bit ELF file".format(elf_path))
+    shoff, = struct.unpack_from("<I", data, 0x20)
+    shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+
+    headers = []
+    for index in range(shnum):
+        name, _, _, _, offset, size = struct.unpack_from("<IIIIII", data, shoff + index * shentsize)
+        headers.append((name, offset, size))
+
+    strtab_offset = headers[shstrndx][1]
+    sizes = {}
+    for name, _, size in headers:
+        end = data.index(b"\x00", strtab_offset + name)
+        sizes[data[strtab_offset + name:end].decode()] = size
+    return sizes
+
+
+def rtc_usage(elf_path):
+    sizes = section_sizes(elf_path)
+    return dict((name, sizes.get(name, 0)) for name in RTC_SECTIONS)
+
+
+def check(elf_path, budget):
+    usage = rtc_usage(elf_path)
+    total = sum(usage.values())
+    details = ", ".join("{} {}".format(name, size) for name, size in sorted(usage.items()))
+    print("RTC memory: {} of {} bytes ({})".format(total, budget, details))
+    if total > budget:
+        sys.stderr.write("RTC memory budget exceeded by {} bytes\n".format(total - budget))
+        return False
+    return True
+
+
+try:
+    Import("env")
+
+    def check_rtc_budget(source, target, env):
+        budget = int(env.GetProjectOption("custom_rtc_budget", DEFAULT_BUDGET))
+        if not check(str(target[0]), budget):
+            env.Exit(1)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", check_rtc_budget)
+except NameError:
+    # not executed by PlatformIO
+    if __name__ == "__main__":
+        if len(sys.argv) < 2:
+            print("usage: rtc_budget.py firmware.elf [budget]")
+            sys.exit(2)
+        sys.exit(0 if check(sys.argv[1], int(sys.argv[2]) if len(sys.argv) > 2 else DEFAULT_BUDGET) else 1)
@@ -0,0 +1,96 @@
+/**
+ * @file AwakeBudget.cpp
+ * @author your name (you@domain.com)
+ * @brief Deadlines of the phases of a wake
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "AwakeBudget.h"
+#include <stdlib.h>
+
+static const uint32_t DEFAULT_DEADLINES[BUDGET_PHASES] = {
+    BUDGET_SENSE_DEFAULT, BUDGET_WIFI_DEFAULT, BUDGET_MQTT_DEFAULT, BUDGET_PUBLISH_DEFAULT, 0
+};
+
+static const char* const PHASE_NAMES[BUDGET_PHASES] = { "sense", "wifi", "mqtt", "publish", "water" };
+
+void AwakeBudget::begin(const uint16_t deadlines[BUDGET_PHASES], uint16_t overruns[BUDGET_PHASES]) {
+    for (int i = 0; i < BUDGET_PHASES; i++) {
+        this->mDeadline[i] = (deadlines[i] > 0) ? deadlines[i] : DEFAULT_DEADLINES[i];
+        this->mCounted[i] = false;
+    }
+    this->mOverruns = overruns;
+    this->mPhase = BUDGET_SENSE;
+    this->mStart = 0;
+}
+
+bool AwakeBudget::parse(const char* text, uint16_t deadlines[BUDGET_PHASES]) {
+    uint16_t parsed[BUDGET_PHASES] = { 0 };
+    int phase = 0;
+    const char* position = text;
+    while ((position != NULL) && (*position != '\0')) {
+        if (phase >= BUDGET_PHASES) {
+            return false;
+        }
+        char* end;
+        long value = strtol(position, &end, 10);
+        if ((value < 0) || (value > UINT16_MAX) || ((*end != ',') && (*end != '\0'))) {
+            return false;
+        }
+        parsed[phase++] = (uint16_t) value;
+        position = (*end == ',') ? (end + 1) : end;
+    }
+    for (int i = 0; i < BUDGET_PHASES; i++) {
+        deadlines[i] = parsed[i];
+    }
+    return true;
+}
+
+const char* AwakeBudget::getName(BudgetPhase_t phase) {
+    return (phase < BUDGET_PHASES) ? PHASE_NAMES[phase] : "done";
+}
+
+void AwakeBudget::setDeadline(BudgetPhase_t phase, uint32_t milliseconds) {
+    if (phase < BUDGET_PHASES) {
+        this->mDeadline[phase] = milliseconds;
+    }
+}
+
+uint32_t AwakeBudget::getDeadline(BudgetPhase_t phase) const {
+    return (phase < BUDGET_PHASES) ? this->mDeadline[phase] : 0;
+}
+
+void AwakeBudget::enter(BudgetPhase_t phase, uint32_t now) {
+    this->mPhase = phase;
+    this->mStart = now;
+}
+
+uint32_t AwakeBudget::getRemaining(uint32_t now) const {
+    if (this->mPhase >= BUDGET_PHASES) {
+        return 0;
+    }
+    uint32_t elapsed = now - this->mStart;
+    return (elapsed < this->mDeadline[this->mPhase]) ? (this->mDeadline[this->mPhase] - elapsed) : 0;
+}
+
+bool AwakeBudget::isOverrun(uint32_t now) {
+    if ((this->mPhase >= BUDGET_PHASES) || (this->getRemaining(now) > 0)) {
+        return false;
+    }
+    this->countOverrun(this->mPhase);
+    return true;
+}
+
+void AwakeBudget::countOverrun(BudgetPhase_t phase) {
+    if ((phase >= BUDGET_PHASES) || this->mCounted[phase]) {
+        return;
+    }
+    this->mCounted[phase] = true;
+    if ((this->mOverruns != 0) && (this->mOverruns[phase] < UINT16_MAX)) {
+        this->mOverruns[phase]++;
+    }
+}
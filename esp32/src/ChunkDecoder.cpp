@@ -0,0 +1,104 @@
+/**
+ * @file ChunkDecoder.cpp
+ * @author your name (you@domain.com)
+ * @brief Manifest and chunk format of the resumable firmware update
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ChunkDecoder.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef ARDUINO
+#include "rom/miniz.h"
+#include "rom/crc.h"
+#else
+#include <zlib.h>
+#endif
+
+static uint32_t readLittleEndian(const uint8_t* data) {
+    return ((uint32_t) data[0]) | (((uint32_t) data[1]) << 8) |
+           (((uint32_t) data[2]) << 16) | (((uint32_t) data[3]) << 24);
+}
+
+/**
+ * @return false, if the data is not a complete zlib stream or does not fit into the output
+ */
+static bool inflateChunk(void* inflator, const uint8_t* input, size_t inputLength, uint8_t* output, size_t& outputLength) {
+#ifdef ARDUINO
+    tinfl_decompressor* decompressor = (tinfl_decompressor*) inflator;
+    tinfl_init(decompressor);
+    tinfl_status result = tinfl_decompress(decompressor, input, &inputLength, output, output, &outputLength,
+                                           TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_USING_NON_WRAPPING_OUTPUT_BUF);
+    return (result == TINFL_STATUS_DONE);
+#else
+    (void) inflator;
+    uLongf length = outputLength;
+    int result = uncompress(output, &length, input, inputLength);
+    outputLength = length;
+    return (result == Z_OK);
+#endif
+}
+
+static uint32_t checksum(const uint8_t* data, size_t length) {
+#ifdef ARDUINO
+    return crc32_le(0, data, length);
+#else
+    return (uint32_t) crc32(0, data, length);
+#endif
+}
+
+bool chunkParseManifest(const char* text, ChunkManifest_t& manifest) {
+    unsigned int imageSize = 0;
+    unsigned int chunkSize = 0;
+    unsigned int chunkCount = 0;
+    if ((sscanf(text, "%32s %u %u %u", manifest.md5, &imageSize, &chunkSize, &chunkCount) != 4) ||
+        (strlen(manifest.md5) != (CHUNKOTA_MD5_SIZE - 1)) ||
+        (chunkSize == 0) || (chunkSize > CHUNKOTA_MAX_CHUNK_SIZE) || ((chunkSize % CHUNKOTA_SECTOR_SIZE) != 0) ||
+        (chunkCount != ((imageSize + chunkSize - 1) / chunkSize))) {
+        return false;
+    }
+    manifest.imageSize = imageSize;
+    manifest.chunkSize = chunkSize;
+    manifest.chunkCount = chunkCount;
+    return true;
+}
+
+uint32_t chunkLength(const ChunkManifest_t& manifest, uint32_t index) {
+    if (index >= manifest.chunkCount) {
+        return 0;
+    }
+    uint32_t remaining = manifest.imageSize - (index * manifest.chunkSize);
+    return (remaining < manifest.chunkSize) ? remaining : manifest.chunkSize;
+}
+
+size_t chunkInflatorSize(void) {
+#ifdef ARDUINO
+    return sizeof(tinfl_decompressor);
+#else
+    return 0;
+#endif
+}
+
+ChunkResult_t chunkDecode(const ChunkManifest_t& manifest, uint32_t index, const uint8_t* message, size_t length,
+                          void* inflator, uint8_t* output) {
+    if ((index >= manifest.chunkCount) || (length <= CHUNKOTA_HEADER_SIZE) || (length > CHUNKOTA_MAX_MESSAGE_SIZE) ||
+        (readLittleEndian(message) != index) || (readLittleEndian(message + 4) != chunkLength(manifest, index))) {
+        return CHUNK_UNEXPECTED;
+    }
+    uint32_t rawLength = readLittleEndian(message + 4);
+    uint32_t crc = readLittleEndian(message + 8);
+    size_t outputLength = CHUNKOTA_MAX_CHUNK_SIZE;
+    if (!inflateChunk(inflator, message + CHUNKOTA_HEADER_SIZE, length - CHUNKOTA_HEADER_SIZE, output, outputLength) ||
+        (outputLength != rawLength) || (checksum(output, rawLength) != crc)) {
+        return CHUNK_CORRUPT;
+    }
+    return CHUNK_OK;
+}
+
+int chunkRequest(const ChunkManifest_t& manifest, uint32_t index, char* buffer, size_t size) {
+    return snprintf(buffer, size, "%s %u", manifest.md5, (unsigned int) index);
+}
@@ -0,0 +1,328 @@
+/**
+ * @file ChunkedOta.cpp
+ * @author your name (you@domain.com)
+ * @brief Resumable firmware update with compressed chunks over MQTT
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ChunkedOta.h"
+#include <Preferences.h>
+#include <MD5Builder.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+
+#define PROGRESS_MAGIC      0x4F544131  /**< "OTA1" */
+#define NVS_NAMESPACE       "chunkota"
+#define NVS_KEY_MD5         "md5"
+#define NVS_KEY_NEXT        "next"
+#define MANIFEST_SIZE       96
+#define STATUS_SIZE         48
+
+/**
+ * @brief Progress of the update, survives the deep sleep
+ * The NVS copy is used after a power loss.
+ */
+typedef struct ChunkedOtaProgress_t {
+    uint32_t magic;
+    char md5[CHUNKOTA_MD5_SIZE];
+    uint32_t nextChunk;
+} ChunkedOtaProgress_t;
+
+RTC_DATA_ATTR ChunkedOtaProgress_t rtcOtaProgress;
+
+/* Shared between the MQTT callback (network task) and loop() */
+static char gTopicPrefix[CHUNKOTA_TOPIC_SIZE];
+static size_t gTopicPrefixLength = 0;
+static char gManifest[MANIFEST_SIZE];
+static volatile bool gManifestReady = false;
+static uint8_t* gMessage = NULL;               /**< Only allocated and released with gMessageLock held */
+static volatile size_t gMessageLength = 0;
+static volatile bool gMessageReady = false;
+static portMUX_TYPE gMessageLock = portMUX_INITIALIZER_UNLOCKED;
+
+/* Only used in loop() */
+static void* gInflator = NULL;
+static uint8_t* gChunk = NULL;
+static const esp_partition_t* gPartition = NULL;
+static char gTopic[CHUNKOTA_TOPIC_SIZE];
+
+static bool isTopic(const char* topic, const char* name) {
+    return (strncmp(topic, gTopicPrefix, gTopicPrefixLength) == 0) &&
+           (strcmp(topic + gTopicPrefixLength, name) == 0);
+}
+
+static void onMessage(char* topic, char* payload, AsyncMqttClientMessageProperties properties, size_t len, size_t index, size_t total) {
+    if (gTopicPrefixLength == 0) {
+        return;
+    }
+    if (isTopic(topic, "manifest")) {
+        /* the manifest is small and always received as one piece */
+        if ((index == 0) && (len == total) && (len < sizeof(gManifest)) && !gManifestReady) {
+            memcpy(gManifest, payload, len);
+            gManifest[len] = '\0';
+            gManifestReady = true;
+        }
+    } else if (isTopic(topic, "chunk")) {
+        /* large messages are delivered in several pieces */
+        if ((total > CHUNKOTA_MAX_MESSAGE_SIZE) || ((index + len) > total)) {
+            return;
+        }
+        /* loop() may release the buffer at the same time (timeout, error) */
+        portENTER_CRITICAL(&gMessageLock);
+        if ((gMessage != NULL) && !gMessageReady) {
+            memcpy(gMessage + index, payload, len);
+            if ((index + len) == total) {
+                gMessageLength = total;
+                gMessageReady = true;
+            }
+        }
+        portEXIT_CRITICAL(&gMessageLock);
+    }
+}
+
+static uint32_t loadProgress(const char* md5) {
+    if ((rtcOtaProgress.magic == PROGRESS_MAGIC) && (strcmp(rtcOtaProgress.md5, md5) == 0)) {
+        return rtcOtaProgress.nextChunk;
+    }
+    Preferences preferences;
+    uint32_t nextChunk = 0;
+    char storedMd5[CHUNKOTA_MD5_SIZE] = { 0 };
+    if (preferences.begin(NVS_NAMESPACE, true)) {
+        preferences.getString(NVS_KEY_MD5, storedMd5, sizeof(storedMd5));
+        if (strcmp(storedMd5, md5) == 0) {
+            nextChunk = preferences.getUInt(NVS_KEY_NEXT, 0);
+        }
+        preferences.end();
+    }
+    return nextChunk;
+}
+
+static void clearProgress(void) {
+    rtcOtaProgress.magic = 0;
+    Preferences preferences;
+    if (preferences.begin(NVS_NAMESPACE, false)) {
+        preferences.clear();
+        preferences.end();
+    }
+}
+
+static void releaseBuffers(void) {
+    free(gInflator);
+    free(gChunk);
+    gInflator = NULL;
+    gChunk = NULL;
+    /* after leaving the lock, the network task can not reach the buffer anymore */
+    portENTER_CRITICAL(&gMessageLock);
+    uint8_t* message = gMessage;
+    gMessage = NULL;
+    gMessageReady = false;
+    portEXIT_CRITICAL(&gMessageLock);
+    free(message);
+}
+
+const char* ChunkedOta::topic(const char* name) {
+    snprintf(gTopic, sizeof(gTopic), "%s%s", gTopicPrefix, name);
+    return gTopic;
+}
+
+void ChunkedOta::publishStatus(const char* status) {
+    this->mClient->publish(topic("status"), 1, false, status, strlen(status));
+}
+
+void ChunkedOta::begin(AsyncMqttClient* client, const char* baseTopic, const char* deviceId) {
+    this->mClient = client;
+    int length = snprintf(gTopicPrefix, sizeof(gTopicPrefix), "%s%s/$implementation/chunkota/", baseTopic, deviceId);
+    if ((length <= 0) || (length >= (int) (sizeof(gTopicPrefix) - sizeof("manifest")))) {
+        gTopicPrefixLength = 0;
+        return;
+    }
+    gTopicPrefixLength = length;
+    /* the callback stays registered after a reconnect */
+    if (!this->mSubscribed) {
+        client->onMessage(onMessage);
+        this->mSubscribed = true;
+    }
+    client->subscribe(topic("manifest"), 1);
+    client->subscribe(topic("chunk"), 1);
+}
+
+void ChunkedOta::storeProgress(bool persistent) {
+    rtcOtaProgress.magic = PROGRESS_MAGIC;
+    strcpy(rtcOtaProgress.md5, this->mManifest.md5);
+    rtcOtaProgress.nextChunk = this->mNextChunk;
+    if (persistent) {
+        Preferences preferences;
+        if (preferences.begin(NVS_NAMESPACE, false)) {
+            preferences.putString(NVS_KEY_MD5, this->mManifest.md5);
+            preferences.putUInt(NVS_KEY_NEXT, this->mNextChunk);
+            preferences.end();
+        }
+    }
+}
+
+void ChunkedOta::requestChunk(void) {
+    char request[STATUS_SIZE];
+    int length = chunkRequest(this->mManifest, this->mNextChunk, request, sizeof(request));
+    this->mClient->publish(topic("request"), 1, false, request, length);
+    this->mLastActivity = millis();
+}
+
+void ChunkedOta::stopUpdate(const char* status) {
+    publishStatus(status);
+    releaseBuffers();
+    this->mActive = false;
+}
+
+void ChunkedOta::startUpdate(void) {
+    ChunkManifest_t manifest;
+    if (!chunkParseManifest(gManifest, manifest)) {
+        /* an empty manifest removes the retained message */
+        if (strlen(gManifest) > 0) {
+            publishStatus("400 manifest");
+        }
+        return;
+    }
+
+    if (ESP.getSketchMD5().equals(manifest.md5)) {
+        clearProgress();
+        publishStatus("304");
+        return;
+    }
+
+    gPartition = esp_ota_get_next_update_partition(NULL);
+    if ((gPartition == NULL) || (gPartition->size < manifest.imageSize)) {
+        publishStatus("413 partition");
+        return;
+    }
+
+    gInflator = malloc(chunkInflatorSize());
+    gChunk = (uint8_t*) malloc(CHUNKOTA_MAX_CHUNK_SIZE);
+    uint8_t* message = (uint8_t*) malloc(CHUNKOTA_MAX_MESSAGE_SIZE);
+    portENTER_CRITICAL(&gMessageLock);
+    gMessage = message;
+    gMessageReady = false;
+    portEXIT_CRITICAL(&gMessageLock);
+    if ((gInflator == NULL) || (gChunk == NULL) || (gMessage == NULL)) {
+        releaseBuffers();
+        publishStatus("500 memory");
+        return;
+    }
+
+    this->mManifest = manifest;
+    this->mNextChunk = loadProgress(manifest.md5);
+    if (this->mNextChunk > this->mManifest.chunkCount) {
+        this->mNextChunk = 0;
+    }
+    this->mRetries = 0;
+    this->mActive = true;
+    Serial << "ota " << manifest.md5 << " from chunk " << this->mNextChunk << "/" << manifest.chunkCount << endl;
+
+    if (this->mNextChunk == this->mManifest.chunkCount) {
+        finishUpdate();
+    } else {
+        requestChunk();
+    }
+}
+
+void ChunkedOta::processChunk(void) {
+    char status[STATUS_SIZE];
+    uint32_t index = this->mNextChunk;
+    uint32_t rawLength = chunkLength(this->mManifest, index);
+    ChunkResult_t result = chunkDecode(this->mManifest, index, gMessage, gMessageLength, gInflator, gChunk);
+    /* the message is consumed, the next one can be received while the flash is written */
+    gMessageReady = false;
+    if (result == CHUNK_UNEXPECTED) {
+        /* duplicate or unexpected chunk: ignore it */
+        return;
+    }
+    if (result == CHUNK_CORRUPT) {
+        snprintf(status, sizeof(status), "400 crc %u", (unsigned int) index);
+        publishStatus(status);
+        requestChunk();
+        return;
+    }
+
+    size_t offset = index * this->mManifest.chunkSize;
+    size_t eraseLength = min((size_t) this->mManifest.chunkSize, (size_t) (gPartition->size - offset));
+    if ((esp_partition_erase_range(gPartition, offset, eraseLength) != ESP_OK) ||
+        (esp_partition_write(gPartition, offset, gChunk, rawLength) != ESP_OK)) {
+        stopUpdate("500 flash");
+        return;
+    }
+
+    this->mNextChunk++;
+    this->mRetries = 0;
+    bool persistent = ((this->mNextChunk % CHUNKOTA_PERSIST_INTERVAL) == 0);
+    storeProgress(persistent);
+    if (persistent) {
+        snprintf(status, sizeof(status), "206 %u/%u", (unsigned int) (offset + rawLength), (unsigned int) this->mManifest.imageSize);
+        publishStatus(status);
+    }
+
+    if (this->mNextChunk == this->mManifest.chunkCount) {
+        finishUpdate();
+    } else {
+        requestChunk();
+    }
+}
+
+void ChunkedOta::finishUpdate(void) {
+    /* check the complete image, as it may be written during several wakes */
+    MD5Builder md5;
+    md5.begin();
+    for (uint32_t offset = 0; offset < this->mManifest.imageSize; offset += CHUNKOTA_MAX_CHUNK_SIZE) {
+        uint32_t length = min((uint32_t) CHUNKOTA_MAX_CHUNK_SIZE, this->mManifest.imageSize - offset);
+        if (esp_partition_read(gPartition, offset, gChunk, length) != ESP_OK) {
+            stopUpdate("500 flash");
+            return;
+        }
+        md5.add(gChunk, length);
+    }
+    md5.calculate();
+    if (!md5.toString().equals(this->mManifest.md5)) {
+        clearProgress();
+        stopUpdate("400 md5");
+        return;
+    }
+    if (esp_ota_set_boot_partition(gPartition) != ESP_OK) {
+        clearProgress();
+        stopUpdate("400 image");
+        return;
+    }
+    clearProgress();
+    stopUpdate("200");
+    Serial << "ota done" << endl;
+    Serial.flush();
+    /* give the MQTT client some time to send the status */
+    delay(500);
+    ESP.restart();
+}
+
+void ChunkedOta::loop(void) {
+    if (gManifestReady) {
+        if (!this->mActive) {
+            startUpdate();
+        }
+        gManifestReady = false;
+    }
+    if (!this->mActive) {
+        return;
+    }
+    if (gMessageReady) {
+        this->mLastActivity = millis();
+        processChunk();
+    } else if ((millis() - this->mLastActivity) > CHUNKOTA_TIMEOUT) {
+        this->mRetries++;
+        if (this->mRetries > CHUNKOTA_RETRIES) {
+            /* continue with the next wake */
+            storeProgress(true);
+            stopUpdate("408 timeout");
+        } else {
+            requestChunk();
+        }
+    }
+}
@@ -0,0 +1,124 @@
+/**
+ * @file ControlLogic.cpp
+ * @author your name (you@domain.com)
+ * @brief Decisions of a wake, without any hardware access
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ControlLogic.h"
+
+long controlExitThreshold(long sensorDry) {
+    if (sensorDry == DEACTIVATED_PLANT) {
+        return DEACTIVATED_PLANT;
+    }
+    long threshold = sensorDry + (sensorDry * CONTROL_HYSTERESIS) / 100;
+    /* a wet sensor must be able to end the cycle, before CONTROL_MAX_BURSTS */
+    return (threshold < CONTROL_ADC_MAX) ? threshold : CONTROL_ADC_MAX;
+}
+
+bool controlIsMode2Required(const ControlState_t& state, const int moisture[MAX_PLANTS], long now) {
+    /* not initialized yet; a trigger of 0 is a valid moistdry */
+    if ((state.deepSleepTime == 0) || !state.initialized) {
+        return true;
+    }
+
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        const PlantState_t& plant = state.plants[i];
+        bool timerOver = (now >= (long) plant.timer);
+        if (plant.phase == PLANT_NEEDS_WATER) {
+            return true;
+        } else if ((plant.phase == PLANT_WATERING) || (plant.phase == PLANT_SOAKING)) {
+            /* the moisture is only meaningful after the soak time; another run, if still below the exit threshold */
+            if (timerOver && (moisture[i] < controlExitThreshold(plant.trigger))) {
+                return true;
+            }
+        } else if ((plant.phase == PLANT_IDLE) || timerOver) {
+            /* idle, or the cooldown is over */
+            if ((plant.trigger != DEACTIVATED_PLANT) && (moisture[i] < plant.trigger)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Transitions of one plant, that do not start the pump
+ */
+static void controlAdvance(PlantState_t& plant, const PlantControl_t& settings, int moisture, long now) {
+    if (settings.sensorDry == DEACTIVATED_PLANT) {
+        plant.phase = PLANT_IDLE;
+        return;
+    }
+    if ((plant.phase == PLANT_WATERING) && (now >= (long) plant.lastActivation + settings.runtime)) {
+        plant.phase = PLANT_SOAKING;
+    }
+    if ((plant.phase == PLANT_SOAKING) && (now >= (long) plant.timer)) {
+        if ((moisture >= settings.sensorExit) || (plant.bursts >= CONTROL_MAX_BURSTS)) {
+            plant.phase = PLANT_COOLDOWN;
+            plant.timer = plant.lastActivation + settings.cooldown * 60;
+        } else {
+            plant.phase = PLANT_NEEDS_WATER;
+        }
+    }
+    if ((plant.phase == PLANT_COOLDOWN) && (now >= (long) plant.timer)) {
+        plant.phase = PLANT_IDLE;
+    }
+    if ((plant.phase == PLANT_IDLE) && (moisture < settings.sensorDry)) {
+        plant.phase = PLANT_NEEDS_WATER;
+        plant.bursts = 0;
+    } else if ((plant.phase == PLANT_NEEDS_WATER) && (plant.bursts == 0) && (moisture >= settings.sensorExit)) {
+        /* wet again without watering */
+        plant.phase = PLANT_IDLE;
+    }
+}
+
+uint32_t controlSelectPumps(ControlState_t& state, const PlantControl_t plants[MAX_PLANTS],
+                           const int moisture[MAX_PLANTS], long solar, long now, int limit) {
+    bool isLowLight = (ADC_5V_TO_3V3(solar) > SOLAR_CHARGE_MIN_VOLTAGE || ADC_5V_TO_3V3(solar) < SOLAR_CHARGE_MAX_VOLTAGE);
+    uint32_t pumps = 0;
+    int selected = 0;
+
+    //FIXME instead of for, use sorted by last activation index to ensure equal runtime?
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        PlantState_t& plant = state.plants[i];
+        /* mode1 wakes up, when this plant gets dry */
+        plant.trigger = plants[i].sensorDry;
+        controlAdvance(plant, plants[i], moisture[i], now);
+
+        if ((selected >= limit) || (plant.phase != PLANT_NEEDS_WATER)) {
+            continue;
+        }
+        /* skip as it is not low light */
+        if (!isLowLight && plants[i].onlyWhenLowLight) {
+            continue;
+        }
+        pumps |= (1UL << i);
+        selected++;
+        plant.phase = PLANT_WATERING;
+        plant.bursts++;
+        plant.lastActivation = now;
+        plant.timer = now + plants[i].runtime + plants[i].soakTime;
+    }
+    state.initialized = true;
+    return pumps;
+}
+
+int controlPumpLimit(long currentBudget) {
+    return (currentBudget > 0) ? MAX_PLANTS : 1;
+}
+
+int controlSelectPump(ControlState_t& state, const PlantControl_t plants[MAX_PLANTS],
+                      const int moisture[MAX_PLANTS], long solar, long now) {
+    uint32_t pumps = controlSelectPumps(state, plants, moisture, solar, now, 1);
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        if (pumps & (1UL << i)) {
+            return i;
+        }
+    }
+    return NO_PUMP;
+}
@@ -0,0 +1,107 @@
+/**
+ * @file ControlTrace.cpp
+ * @author your name (you@domain.com)
+ * @brief Raw sensor inputs of one wake, as a CSV line
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "ControlTrace.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TRACE_COLUMNS   (2 + MAX_PLANTS + 5)
+
+/* same order as TRACE_HEADER */
+static void traceColumns(TraceRecord_t& record, int32_t* columns[TRACE_COLUMNS]) {
+    int column = 0;
+    columns[column++] = &record.time;
+    columns[column++] = &record.boot;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        columns[column++] = &record.moisture[i];
+    }
+    columns[column++] = &record.lipo;
+    columns[column++] = &record.solar;
+    columns[column++] = &record.temperature[0];
+    columns[column++] = &record.temperature[1];
+    columns[column++] = &record.echo;
+}
+
+void traceClear(TraceRecord_t& record) {
+    int32_t* columns[TRACE_COLUMNS];
+    traceColumns(record, columns);
+    for (int i = 0; i < TRACE_COLUMNS; i++) {
+        *columns[i] = TRACE_UNKNOWN;
+    }
+}
+
+void traceToChannels(const TraceRecord_t& record, int32_t values[TRACE_CHANNELS]) {
+    int32_t* columns[TRACE_COLUMNS];
+    TraceRecord_t copy = record;
+    traceColumns(copy, columns);
+    for (int i = 1; i < TRACE_COLUMNS; i++) {
+        values[i - 1] = *columns[i];
+    }
+}
+
+void traceFromChannels(TraceRecord_t& record, uint32_t time, const int32_t values[TRACE_CHANNELS]) {
+    int32_t* columns[TRACE_COLUMNS];
+    traceColumns(record, columns);
+    *columns[0] = (int32_t) time;
+    for (int i = 1; i < TRACE_COLUMNS; i++) {
+        *columns[i] = values[i - 1];
+    }
+}
+
+size_t traceFormat(char* buffer, size_t size, const TraceRecord_t& record) {
+    int32_t* columns[TRACE_COLUMNS];
+    TraceRecord_t copy = record;
+    traceColumns(copy, columns);
+
+    size_t length = 0;
+    for (int i = 0; i < TRACE_COLUMNS; i++) {
+        int written;
+        const char* separator = (i == 0) ? "" : ",";
+        if (*columns[i] == TRACE_UNKNOWN) {
+            written = snprintf(buffer + length, size - length, "%s", separator);
+        } else {
+            written = snprintf(buffer + length, size - length, "%s%ld", separator, (long) *columns[i]);
+        }
+        if ((written < 0) || ((size_t) written >= size - length)) {
+            if (size > 0) {
+                buffer[0] = '\0';
+            }
+            return 0;
+        }
+        length += written;
+    }
+    return length;
+}
+
+bool traceParse(const char* line, TraceRecord_t& record) {
+    int32_t* columns[TRACE_COLUMNS];
+    traceColumns(record, columns);
+
+    if ((line[0] == '#') || (line[0] == '\0') || (line[0] == '\n') || (line[0] == '\r')) {
+        return false;
+    }
+
+    const char* position = line;
+    for (int i = 0; i < TRACE_COLUMNS; i++) {
+        char* end;
+        long value = strtol(position, &end, 10);
+        *columns[i] = (end == position) ? TRACE_UNKNOWN : (int32_t) value;
+        position = end;
+        if (i < TRACE_COLUMNS - 1) {
+            if (*position != ',') {
+                return false;
+            }
+            position++;
+        }
+    }
+    /* time and boot counter are always written */
+    return (record.time != TRACE_UNKNOWN) && (record.boot != TRACE_UNKNOWN);
+}
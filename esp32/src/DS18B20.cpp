@@ -13,6 +13,9 @@
 
 #define STARTCONV       0x44
 #define READSCRATCH     0xBE  // Read EEPROM
+#define WRITESCRATCH    0x4E
+#define ALARM_HIGH      0x4B  /**< Power on defaults, the alarms are not used */
+#define ALARM_LOW       0x46
 #define TEMP_LSB        0
 #define TEMP_MSB        1
 #define SCRATCHPADSIZE  9
@@ -33,73 +36,83 @@ int Ds18B20::readDevices() {
 }
 
 int Ds18B20::readAllTemperatures(float* pTemperatures, int maxTemperatures) {
+    this->startConversion();
+    /* at most the datasheet time, parasite powered sensors cannot signal the end */
+    unsigned long start = millis();
+    while (!this->isConversionDone() && ((millis() - start) < (unsigned long) DS18B20_CONVERSION_TIME(this->mResolution))) {
+        delay(1);
+    }
+    return this->readScratchpads(pTemperatures, maxTemperatures);
+}
+
+void Ds18B20::setResolution(uint8_t bits) {
+    if ((bits < 9) || (bits > DS18B20_RESOLUTION_MAX)) {
+        return;
+    }
+    this->mDs->reset();
+    this->mDs->skip();
+    this->mDs->write(WRITESCRATCH);
+    this->mDs->write(ALARM_HIGH);
+    this->mDs->write(ALARM_LOW);
+    /* configuration register: R1 R0 in bit 6 and 5, the other bits are 1 */
+    this->mDs->write((uint8_t) (((bits - 9) << 5) | 0x1F));
+    this->mResolution = bits;
+}
+
+void Ds18B20::startConversion() {
+    this->mDs->reset();
+    /* all devices at once */
+    this->mDs->skip();
+    this->mDs->write(STARTCONV);
+}
+
+bool Ds18B20::isConversionDone() {
+    return (this->mDs->read_bit() != 0);
+}
+
+int Ds18B20::readTemperatures(float* pTemperatures, int maxTemperatures) {
+    return this->readScratchpads(pTemperatures, maxTemperatures);
+}
+
+int Ds18B20::readScratchpads(float* pTemperatures, int maxTemperatures) {
     byte addr[8];
     uint8_t scratchPad[SCRATCHPADSIZE];
     int currentTemp = 0;
 
     while (this->mDs->search(addr)) {
-#ifdef DS_DEBUG
-        Serial.print(" ROM =");
-        for (i = 0; i < 8; i++) {
-            Serial.write(' ');
-            Serial.print(addr[i], HEX);
-        }
-#endif
-        this->mDs->reset();
-        this->mDs->select(addr);
-        this->mDs->write(STARTCONV);
         this->mDs->reset();
         this->mDs->select(addr);
         this->mDs->write(READSCRATCH);
-
-        // Read all registers in a simple loop
         // byte 0: temperature LSB
         // byte 1: temperature MSB
         // byte 2: high alarm temp
         // byte 3: low alarm temp
-        // byte 4: DS18S20: store for crc
-        //         DS18B20 & DS1822: configuration register
-        // byte 5: internal use & crc
-        // byte 6: DS18S20: COUNT_REMAIN
-        //         DS18B20 & DS1822: store for crc
-        // byte 7: DS18S20: COUNT_PER_C
-        //         DS18B20 & DS1822: store for crc
+        // byte 4: configuration register
+        // byte 5..7: internal use
         // byte 8: SCRATCHPAD_CRC
-#ifdef DS_DEBUG
-        Serial.write("\r\nDATA:");
-        for (uint8_t i = 0; i < 9; i++) {
-            Serial.print(scratchPad[i], HEX);
-        }
-#else
-        delay(50);
-#endif
-        for (uint8_t i = 0; i < 9; i++) {
+        for (uint8_t i = 0; i < SCRATCHPADSIZE; i++) {
             scratchPad[i] = this->mDs->read();
         }
-        uint8_t crc8 = this->mDs->crc8(scratchPad, 8);
 
         /* Only work an valid data */
-        if (crc8 == scratchPad[OFFSET_CRC8]) {
+        if (this->mDs->crc8(scratchPad, 8) == scratchPad[OFFSET_CRC8]) {
+            /* the bits below the resolution are undefined */
+            scratchPad[TEMP_LSB] &= (uint8_t) ~((1 << (DS18B20_RESOLUTION_MAX - this->mResolution)) - 1);
             int16_t fpTemperature = (((int16_t) scratchPad[TEMP_MSB]) << 11)
                 | (((int16_t) scratchPad[TEMP_LSB]) << 3);
-            float celsius =  (float) fpTemperature * 0.0078125;
+            float celsius = (float) fpTemperature * 0.0078125;
 #ifdef DS_DEBUG
-            Serial.printf("\r\nTemp%d %f °C (Raw: %d, %x =? %x)\r\n", (currentTemp+1), celsius, fpTemperature, crc8, scratchPad[8]);
+            Serial.printf("Temp%d %f °C (Raw: %d)\r\n", (currentTemp + 1), celsius, fpTemperature);
 #endif
-            /* check, if the buffer as some space for our data */
             if (currentTemp < maxTemperatures) {
                 pTemperatures[currentTemp] = celsius;
             } else {
+                this->mDs->reset_search();
                 return -1;
             }
         }
         currentTemp++;
-    } 
+    }
     this->mDs->reset();
-#ifdef DS_DEBUG
-    Serial.println(" No more addresses.");
-    Serial.println();
-#endif
-
     return currentTemp;
-}
\ No newline at end of file
+}
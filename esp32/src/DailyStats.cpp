@@ -0,0 +1,224 @@
+/**
+ * @file DailyStats.cpp
+ * @author your name (you@domain.com)
+ * @brief Daily minimum, maximum, mean and deviation of each plant and sensor
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "DailyStats.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char* SENSOR_NAMES[STATS_SENSORS] = { "tempair", "tempcontrol", "water", "lipo", "solar" };
+static const int SENSOR_DECIMALS[STATS_SENSORS] = { 2, 2, 0, 3, 3 };
+
+void DailyStats::clear(StatsAccumulator_t& accumulator) {
+    accumulator.sumSquares = 0;
+    accumulator.sum = 0;
+    accumulator.count = 0;
+    accumulator.min = INT16_MAX;
+    accumulator.max = INT16_MIN;
+}
+
+void DailyStats::add(StatsAccumulator_t& accumulator, int32_t value) {
+    if ((value < INT16_MIN) || (value > INT16_MAX) || (accumulator.count == UINT16_MAX)) {
+        return;
+    }
+    accumulator.sumSquares += (int64_t) value * value;
+    accumulator.sum += value;
+    accumulator.count++;
+    if (value < accumulator.min) {
+        accumulator.min = value;
+    }
+    if (value > accumulator.max) {
+        accumulator.max = value;
+    }
+}
+
+void DailyStats::reduce(StatsValue_t& value, const StatsAccumulator_t& accumulator) {
+    memset(&value, 0, sizeof(value));
+    if (accumulator.count == 0) {
+        return;
+    }
+    int64_t count = accumulator.count;
+    /* population variance: (n * sum(x^2) - sum(x)^2) / n^2 */
+    int64_t spread = (count * accumulator.sumSquares) - ((int64_t) accumulator.sum * accumulator.sum);
+    value.min = accumulator.min;
+    value.max = accumulator.max;
+    value.mean = (accumulator.sum >= 0) ? ((accumulator.sum + (count / 2)) / count) : ((accumulator.sum - (count / 2)) / count);
+    value.deviation = (spread > 0) ? (uint16_t) lround(sqrt((double) spread) / count) : 0;
+    value.count = accumulator.count;
+}
+
+void DailyStats::reset(int32_t day) {
+    this->mState->day = day;
+    this->mState->wakes = 0;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        clear(this->mState->plants[i].moisture);
+        this->mState->plants[i].drySeconds = 0;
+        this->mState->plants[i].pumpMilliseconds = 0;
+        this->mState->plants[i].water = 0;
+    }
+    for (int i = 0; i < STATS_SENSORS; i++) {
+        clear(this->mState->sensors[i]);
+    }
+}
+
+void DailyStats::begin(DailyStatsState_t* state) {
+    this->mState = state;
+}
+
+bool DailyStats::rollover(int32_t day) {
+    if (this->mState->day == day) {
+        return false;
+    }
+    if ((this->mState->day != 0) && (this->mState->wakes > 0)) {
+        DailySummary_t& summary = this->mState->summary;
+        summary.day = this->mState->day;
+        summary.wakes = this->mState->wakes;
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            const StatsPlant_t& plant = this->mState->plants[i];
+            reduce(summary.plants[i].moisture, plant.moisture);
+            summary.plants[i].dryMinutes = plant.drySeconds / 60;
+            summary.plants[i].pumpSeconds = plant.pumpMilliseconds / 1000;
+            summary.plants[i].water = plant.water;
+        }
+        for (int i = 0; i < STATS_SENSORS; i++) {
+            reduce(summary.sensors[i], this->mState->sensors[i]);
+        }
+    }
+    reset(day);
+    return true;
+}
+
+void DailyStats::addWake(uint32_t now, uint8_t dryMask) {
+    uint32_t interval = now - this->mState->lastWake;
+    if ((this->mState->lastWake != 0) && (now > this->mState->lastWake) && (interval <= STATS_MAX_INTERVAL)) {
+        /* the plant stayed dry until this wake */
+        for (int i = 0; i < MAX_PLANTS; i++) {
+            if (this->mState->dryMask & (1 << i)) {
+                this->mState->plants[i].drySeconds += interval;
+            }
+        }
+    }
+    this->mState->lastWake = now;
+    this->mState->dryMask = dryMask;
+    if (this->mState->wakes < UINT16_MAX) {
+        this->mState->wakes++;
+    }
+}
+
+void DailyStats::addMoisture(int plant, int32_t percent) {
+    if ((plant >= 0) && (plant < MAX_PLANTS)) {
+        add(this->mState->plants[plant].moisture, percent);
+    }
+}
+
+void DailyStats::addSensor(StatsSensor_t sensor, int32_t value) {
+    if (sensor < STATS_SENSORS) {
+        add(this->mState->sensors[sensor], value);
+    }
+}
+
+void DailyStats::addPump(int plant, uint32_t milliseconds, uint32_t millilitre) {
+    if ((plant >= 0) && (plant < MAX_PLANTS)) {
+        this->mState->plants[plant].pumpMilliseconds += milliseconds;
+        this->mState->plants[plant].water += millilitre;
+    }
+}
+
+void DailyStats::clearSummary(void) {
+    memset(&this->mState->summary, 0, sizeof(this->mState->summary));
+}
+
+/**
+ * @brief Append a fixed point value (value / 10^decimals)
+ */
+static int appendFixed(char* buffer, size_t size, long value, int decimals) {
+    if (decimals == 0) {
+        return snprintf(buffer, size, "%ld", value);
+    }
+    long scale = (decimals == 2) ? 100 : 1000;
+    unsigned long absolute = (value < 0) ? -value : value;
+    return snprintf(buffer, size, "%s%lu.%0*lu", (value < 0) ? "-" : "", absolute / scale, decimals, absolute % scale);
+}
+
+/**
+ * @brief Append ,"name":[min,max,mean,sd or ,"name":null
+ * The closing bracket is left to the caller.
+ */
+static bool appendValue(char* buffer, size_t size, size_t& used, const char* name, int index,
+                        const StatsValue_t& value, int decimals) {
+    int length;
+    if (index >= 0) {
+        length = snprintf(buffer + used, size - used, ",\"%s%d\":", name, index);
+    } else {
+        length = snprintf(buffer + used, size - used, ",\"%s\":", name);
+    }
+    if ((length < 0) || ((used + length) >= size)) {
+        return false;
+    }
+    used += length;
+    if (value.count == 0) {
+        length = snprintf(buffer + used, size - used, "null");
+        used += length;
+        return (length > 0) && (used < size);
+    }
+    const long fields[4] = { value.min, value.max, value.mean, value.deviation };
+    for (int i = 0; i < 4; i++) {
+        if ((used + 1) >= size) {
+            return false;
+        }
+        buffer[used++] = (i == 0) ? '[' : ',';
+        length = appendFixed(buffer + used, size - used, fields[i], decimals);
+        if ((length < 0) || ((used + length) >= size)) {
+            return false;
+        }
+        used += length;
+    }
+    return true;
+}
+
+size_t DailyStats::format(char* buffer, size_t size, const DailySummary_t& summary) {
+    int length = snprintf(buffer, size, "{\"day\":%ld,\"wakes\":%u", (long) summary.day, summary.wakes);
+    if ((length < 0) || ((size_t) length >= size)) {
+        return 0;
+    }
+    size_t used = length;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        const StatsSummaryPlant_t& plant = summary.plants[i];
+        if (!appendValue(buffer, size, used, "plant", i, plant.moisture, 0)) {
+            return 0;
+        }
+        if (plant.moisture.count > 0) {
+            length = snprintf(buffer + used, size - used, ",%u,%u,%lu]",
+                              plant.dryMinutes, plant.pumpSeconds, (unsigned long) plant.water);
+            if ((length < 0) || ((used + length) >= size)) {
+                return 0;
+            }
+            used += length;
+        }
+    }
+    for (int i = 0; i < STATS_SENSORS; i++) {
+        if (!appendValue(buffer, size, used, SENSOR_NAMES[i], -1, summary.sensors[i], SENSOR_DECIMALS[i])) {
+            return 0;
+        }
+        if (summary.sensors[i].count > 0) {
+            if ((used + 1) >= size) {
+                return 0;
+            }
+            buffer[used++] = ']';
+        }
+    }
+    if ((used + 2) > size) {
+        return 0;
+    }
+    buffer[used++] = '}';
+    buffer[used] = '\0';
+    return used;
+}
@@ -0,0 +1,121 @@
+/**
+ * @file DeltaCodec.cpp
+ * @author your name (you@domain.com)
+ * @brief Compact stream of sensor records: delta-of-delta time, varint deltas per channel
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "DeltaCodec.h"
+#include <string.h>
+
+static inline uint32_t zigzag(uint32_t value) {
+    return (value << 1) ^ (uint32_t) (-(int32_t) (value >> 31));
+}
+
+static inline uint32_t unzigzag(uint32_t value) {
+    return (value >> 1) ^ (uint32_t) (-(int32_t) (value & 1));
+}
+
+void deltaReset(DeltaState_t& state) {
+    memset(&state, 0, sizeof(state));
+}
+
+size_t deltaPutVarint(uint8_t* buffer, size_t size, uint32_t value) {
+    size_t used = 0;
+    do {
+        if (used >= size) {
+            return 0;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        buffer[used++] = (value != 0) ? (byte | 0x80) : byte;
+    } while (value != 0);
+    return used;
+}
+
+size_t deltaGetVarint(const uint8_t* buffer, size_t length, uint32_t& value) {
+    value = 0;
+    for (size_t used = 0; (used < length) && (used < DELTA_VARINT_SIZE); used++) {
+        value |= (uint32_t) (buffer[used] & 0x7F) << (7 * used);
+        if ((buffer[used] & 0x80) == 0) {
+            return used + 1;
+        }
+    }
+    return 0;
+}
+
+size_t deltaEncode(DeltaState_t& state, uint8_t channels, uint32_t time, const int32_t* values,
+                   uint8_t* buffer, size_t size) {
+    if (channels > DELTA_MAX_CHANNELS) {
+        return 0;
+    }
+    /* the differences are calculated unsigned, so they wrap around instead of overflowing */
+    uint32_t interval = time - state.time;
+    uint32_t bitmap = 0;
+    for (uint8_t i = 0; i < channels; i++) {
+        if (values[i] != state.values[i]) {
+            bitmap |= (1UL << i);
+        }
+    }
+
+    size_t used = deltaPutVarint(buffer, size, zigzag(interval - state.interval));
+    size_t written = (used > 0) ? deltaPutVarint(buffer + used, size - used, bitmap) : 0;
+    if (written == 0) {
+        return 0;
+    }
+    used += written;
+    for (uint8_t i = 0; i < channels; i++) {
+        if (bitmap & (1UL << i)) {
+            written = deltaPutVarint(buffer + used, size - used, zigzag((uint32_t) values[i] - (uint32_t) state.values[i]));
+            if (written == 0) {
+                return 0;
+            }
+            used += written;
+        }
+    }
+
+    state.time = time;
+    state.interval = interval;
+    memcpy(state.values, values, channels * sizeof(int32_t));
+    return used;
+}
+
+size_t deltaDecode(DeltaState_t& state, uint8_t channels, const uint8_t* buffer, size_t length,
+                   uint32_t& time, int32_t* values) {
+    if (channels > DELTA_MAX_CHANNELS) {
+        return 0;
+    }
+    uint32_t deltaInterval;
+    uint32_t bitmap;
+    size_t used = deltaGetVarint(buffer, length, deltaInterval);
+    size_t read = (used > 0) ? deltaGetVarint(buffer + used, length - used, bitmap) : 0;
+    if ((read == 0) || ((bitmap >> channels) != 0)) {
+        return 0;
+    }
+    used += read;
+
+    int32_t decoded[DELTA_MAX_CHANNELS];
+    for (uint8_t i = 0; i < channels; i++) {
+        decoded[i] = state.values[i];
+        if (bitmap & (1UL << i)) {
+            uint32_t delta;
+            read = deltaGetVarint(buffer + used, length - used, delta);
+            if (read == 0) {
+                return 0;
+            }
+            used += read;
+            decoded[i] = (int32_t) ((uint32_t) state.values[i] + unzigzag(delta));
+        }
+    }
+
+    state.interval += unzigzag(deltaInterval);
+    state.time += state.interval;
+    memcpy(state.values, decoded, channels * sizeof(int32_t));
+    time = state.time;
+    memcpy(values, decoded, channels * sizeof(int32_t));
+    return used;
+}
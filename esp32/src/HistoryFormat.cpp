@@ -0,0 +1,171 @@
+/**
+ * @file HistoryFormat.cpp
+ * @author your name (you@domain.com)
+ * @brief Binary format of the history log in the flash
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "HistoryFormat.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char* const WAKE_NAMES[] = { "nop", "fastpath", "homie", "button", "cold" };
+
+uint8_t historyCrc8(const uint8_t* data, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? ((crc << 1) ^ 0x07) : (crc << 1);
+        }
+    }
+    return crc;
+}
+
+void historyClear(HistoryRecord_t& record) {
+    memset(&record, 0, sizeof(record));
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        record.moisture[i] = HISTORY_UNKNOWN;
+    }
+    record.temperature[0] = HISTORY_TEMP_UNKNOWN;
+    record.temperature[1] = HISTORY_TEMP_UNKNOWN;
+    record.water = HISTORY_UNKNOWN;
+    record.lipo = HISTORY_UNKNOWN;
+    record.solar = HISTORY_UNKNOWN;
+}
+
+void historySeal(HistoryRecord_t& record) {
+    record.crc = historyCrc8((const uint8_t*) &record, sizeof(record) - 1);
+}
+
+bool historyIsValid(const HistoryRecord_t& record) {
+    /* an erased record would have a valid CRC by chance in 1/256 */
+    if (record.time == 0xFFFFFFFFUL) {
+        return false;
+    }
+    return record.crc == historyCrc8((const uint8_t*) &record, sizeof(record) - 1);
+}
+
+void historyPageHeader(HistoryPageHeader_t& header, uint32_t sequence, uint8_t count) {
+    memset(&header, 0, sizeof(header));
+    header.magic = HISTORY_MAGIC;
+    header.sequence = sequence;
+    header.version = HISTORY_VERSION;
+    header.count = count;
+    header.recordSize = HISTORY_RECORD_SIZE;
+    header.crc = historyCrc8((const uint8_t*) &header, sizeof(header) - 1);
+}
+
+bool historyPageIsValid(const HistoryPageHeader_t& header) {
+    return (header.magic == HISTORY_MAGIC) && (header.version == HISTORY_VERSION) &&
+           (header.count <= HISTORY_PAGE_RECORDS) && (header.recordSize == HISTORY_RECORD_SIZE) &&
+           (header.crc == historyCrc8((const uint8_t*) &header, sizeof(header) - 1));
+}
+
+void historyPageBuild(uint8_t* page, uint32_t sequence, const HistoryRecord_t* records, uint8_t count) {
+    if (count > HISTORY_PAGE_RECORDS) {
+        count = HISTORY_PAGE_RECORDS;
+    }
+    HistoryPageHeader_t header;
+    historyPageHeader(header, sequence, count);
+    memset(page, 0xFF, HISTORY_PAGE_SIZE);
+    memcpy(page, &header, sizeof(header));
+    memcpy(page + sizeof(header), records, count * sizeof(HistoryRecord_t));
+}
+
+void historyToChannels(const HistoryRecord_t& record, int32_t values[HISTORY_CHANNELS]) {
+    int channel = 0;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        values[channel++] = record.moisture[i];
+    }
+    values[channel++] = record.temperature[0];
+    values[channel++] = record.temperature[1];
+    values[channel++] = record.water;
+    values[channel++] = record.lipo;
+    values[channel++] = record.solar;
+    values[channel++] = record.pumps;
+    values[channel++] = record.wake;
+    values[channel++] = record.awake;
+}
+
+void historyFromChannels(HistoryRecord_t& record, uint32_t time, const int32_t values[HISTORY_CHANNELS]) {
+    int channel = 0;
+    record.time = time;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        record.moisture[i] = values[channel++];
+    }
+    record.temperature[0] = values[channel++];
+    record.temperature[1] = values[channel++];
+    record.water = values[channel++];
+    record.lipo = values[channel++];
+    record.solar = values[channel++];
+    record.pumps = values[channel++];
+    record.wake = values[channel++];
+    record.awake = values[channel++];
+    historySeal(record);
+}
+
+size_t historyFormatHeader(char* buffer, size_t size, int plant) {
+    int length;
+    if ((plant >= 0) && (plant < MAX_PLANTS)) {
+        length = snprintf(buffer, size, "time,moist%d,pump%d,tempair,tempcontrol,water,lipo,solar,wake,awake", plant, plant);
+    } else {
+        length = snprintf(buffer, size, "time,moist0,moist1,moist2,moist3,moist4,moist5,moist6,"
+                                        "tempair,tempcontrol,water,lipo,solar,pumps,wake,awake");
+    }
+    return ((length < 0) || ((size_t) length >= size)) ? 0 : (size_t) length;
+}
+
+/**
+ * @brief Append ",value" or "," for unknown values
+ * @return false, if the buffer is too small
+ */
+static bool appendValue(char* buffer, size_t size, size_t& used, long value, bool unknown) {
+    int length = unknown ? snprintf(buffer + used, size - used, ",")
+                         : snprintf(buffer + used, size - used, ",%ld", value);
+    if ((length < 0) || ((used + length) >= size)) {
+        return false;
+    }
+    used += length;
+    return true;
+}
+
+size_t historyFormat(char* buffer, size_t size, const HistoryRecord_t& record, int plant) {
+    int length = snprintf(buffer, size, "%lu", (unsigned long) record.time);
+    if ((length < 0) || ((size_t) length >= size)) {
+        return 0;
+    }
+    size_t used = length;
+    bool single = (plant >= 0) && (plant < MAX_PLANTS);
+    bool fits = true;
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        if (!single || (i == plant)) {
+            fits &= appendValue(buffer, size, used, record.moisture[i], record.moisture[i] == HISTORY_UNKNOWN);
+        }
+    }
+    if (single) {
+        fits &= appendValue(buffer, size, used, (record.pumps >> plant) & 1, false);
+    }
+    for (int i = 0; i < 2; i++) {
+        fits &= appendValue(buffer, size, used, record.temperature[i], record.temperature[i] == HISTORY_TEMP_UNKNOWN);
+    }
+    fits &= appendValue(buffer, size, used, record.water, record.water == HISTORY_UNKNOWN);
+    fits &= appendValue(buffer, size, used, record.lipo, record.lipo == HISTORY_UNKNOWN);
+    fits &= appendValue(buffer, size, used, record.solar, record.solar == HISTORY_UNKNOWN);
+    if (!single) {
+        fits &= appendValue(buffer, size, used, record.pumps, false);
+    }
+    if (!fits) {
+        return 0;
+    }
+    length = snprintf(buffer + used, size - used, ",%s,%d",
+                      (record.wake <= HISTORY_WAKE_COLD) ? WAKE_NAMES[record.wake] : "?", record.awake * 100);
+    if ((length < 0) || ((used + length) >= size)) {
+        return 0;
+    }
+    return used + length;
+}
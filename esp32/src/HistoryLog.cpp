@@ -0,0 +1,164 @@
+/**
+ * @file HistoryLog.cpp
+ * @author your name (you@domain.com)
+ * @brief Append-only history of all wakes in a dedicated flash partition
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "HistoryLog.h"
+#include <Homie.h>
+
+bool HistoryLog::begin(HistoryStaging_t* staging) {
+    this->mStaging = staging;
+    this->mPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                                (esp_partition_subtype_t) HISTORY_PARTITION_SUBTYPE,
+                                                HISTORY_PARTITION_LABEL);
+    if (this->mPartition == NULL) {
+        Serial << "no history partition" << endl;
+        return false;
+    }
+    this->mSize = this->mPartition->size - (this->mPartition->size % HISTORY_SECTOR_SIZE);
+    return true;
+}
+
+bool HistoryLog::findHead(void) {
+    /* only the headers are read, once after power on */
+    HistoryPageHeader_t header;
+    bool found = false;
+    uint32_t newest = 0;
+    uint32_t head = 0;
+    for (uint32_t offset = 0; offset < this->mSize; offset += HISTORY_PAGE_SIZE) {
+        if (esp_partition_read(this->mPartition, offset, &header, sizeof(header)) != ESP_OK) {
+            return false;
+        }
+        if (historyPageIsValid(header) && (!found || (header.sequence > newest))) {
+            found = true;
+            newest = header.sequence;
+            head = offset + HISTORY_PAGE_SIZE;
+        }
+    }
+    this->mStaging->head = (head < this->mSize) ? head : 0;
+    this->mStaging->sequence = found ? (newest + 1) : 0;
+    Serial << "history page " << this->mStaging->sequence << endl;
+    return true;
+}
+
+uint32_t HistoryLog::getHead(void) {
+    if ((this->mStaging == NULL) || (this->mPartition == NULL)) {
+        return 0;
+    }
+    if ((this->mStaging->head == HISTORY_HEAD_UNKNOWN) && !findHead()) {
+        return 0;
+    }
+    return this->mStaging->head;
+}
+
+bool HistoryLog::read(uint32_t offset, void* data, size_t length) {
+    if ((this->mPartition == NULL) || ((offset + length) > this->mSize)) {
+        return false;
+    }
+    return esp_partition_read(this->mPartition, offset, data, length) == ESP_OK;
+}
+
+bool HistoryLog::stage(const HistoryRecord_t& record) {
+    int32_t values[HISTORY_CHANNELS];
+    historyToChannels(record, values);
+    size_t length = deltaEncode(this->mStaging->encoder, HISTORY_CHANNELS, record.time, values,
+                                this->mStaging->data + this->mStaging->used,
+                                HISTORY_STAGING_SIZE - this->mStaging->used);
+    if (length == 0) {
+        return false;
+    }
+    this->mStaging->used += length;
+    this->mStaging->count++;
+    return true;
+}
+
+bool HistoryLog::append(const HistoryRecord_t& record) {
+    if ((this->mStaging == NULL) || (this->mPartition == NULL)) {
+        return false;
+    }
+    bool written = true;
+    if ((this->mStaging->count >= HISTORY_STAGED_RECORDS) || !stage(record)) {
+        /* the last write failed or the buffer is full: make room with the staged pages */
+        written = writeStaged(this->mStaging->count < HISTORY_PAGE_RECORDS);
+        if (!stage(record)) {
+            return false;
+        }
+    }
+    if (this->mStaging->count >= HISTORY_STAGED_RECORDS) {
+        written &= writeStaged(false);
+    }
+    return written;
+}
+
+bool HistoryLog::flush(void) {
+    if ((this->mStaging == NULL) || (this->mPartition == NULL) || (this->mStaging->count == 0)) {
+        return false;
+    }
+    return writeStaged(true);
+}
+
+bool HistoryLog::writeStaged(bool partial) {
+    if ((this->mStaging->head == HISTORY_HEAD_UNKNOWN) && !findHead()) {
+        return false;
+    }
+
+    HistoryRecord_t records[HISTORY_STAGED_RECORDS];
+    DeltaState_t decoder;
+    deltaReset(decoder);
+    int count = 0;
+    size_t position = 0;
+    while ((count < HISTORY_STAGED_RECORDS) && (position < this->mStaging->used)) {
+        uint32_t time;
+        int32_t values[HISTORY_CHANNELS];
+        size_t length = deltaDecode(decoder, HISTORY_CHANNELS, this->mStaging->data + position,
+                                    this->mStaging->used - position, time, values);
+        if (length == 0) {
+            break;
+        }
+        historyFromChannels(records[count++], time, values);
+        position += length;
+    }
+
+    int pages = partial ? ((count + HISTORY_PAGE_RECORDS - 1) / HISTORY_PAGE_RECORDS) : (count / HISTORY_PAGE_RECORDS);
+    bool written = true;
+    int kept = pages * HISTORY_PAGE_RECORDS;
+    for (int i = 0; i < pages; i++) {
+        uint32_t offset = this->mStaging->head;
+        if ((offset % HISTORY_SECTOR_SIZE) == 0) {
+            /* entering a new sector: drop the oldest pages */
+            if (esp_partition_erase_range(this->mPartition, offset, HISTORY_SECTOR_SIZE) != ESP_OK) {
+                /* the staged records are dropped */
+                written = false;
+                kept = count;
+                break;
+            }
+        }
+        int first = i * HISTORY_PAGE_RECORDS;
+        int amount = ((count - first) < HISTORY_PAGE_RECORDS) ? (count - first) : HISTORY_PAGE_RECORDS;
+        uint8_t page[HISTORY_PAGE_SIZE];
+        historyPageBuild(page, this->mStaging->sequence, records + first, amount);
+
+        /* the page is used in any case, a failed write must not be repeated on the same cells */
+        this->mStaging->sequence++;
+        this->mStaging->head = offset + HISTORY_PAGE_SIZE;
+        if (this->mStaging->head >= this->mSize) {
+            this->mStaging->head = 0;
+        }
+        written &= (esp_partition_write(this->mPartition, offset, page, sizeof(page)) == ESP_OK);
+    }
+
+    /* the records of the last, not full page start a new stream */
+    this->mStaging->count = 0;
+    this->mStaging->used = 0;
+    deltaReset(this->mStaging->encoder);
+    for (int i = kept; i < count; i++) {
+        stage(records[i]);
+    }
+    return written;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file HistoryServer.cpp
+ * @author your name (you@domain.com)
+ * @brief HTTP download of the history, while the controller stays alive (mode3)
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "HistoryServer.h"
+#include <Homie.h>
+
+bool HistoryServer::readLog(void* context, uint32_t offset, void* data, size_t length) {
+    return ((HistoryLog*) context)->read(offset, data, length);
+}
+
+void HistoryServer::begin(HistoryLog* log) {
+    if (this->mServer != NULL) {
+        return;
+    }
+    this->mLog = log;
+    this->mServer = new AsyncWebServer(HISTORY_HTTP_PORT);
+    this->mServer->on(HISTORY_HTTP_PATH, HTTP_GET, [this](AsyncWebServerRequest* request) {
+        this->handle(request);
+    });
+    this->mServer->begin();
+    Serial << "history on port " << HISTORY_HTTP_PORT << endl;
+}
+
+void HistoryServer::handle(AsyncWebServerRequest* request) {
+    if (this->mStreaming) {
+        request->send(503, "text/plain", "download running");
+        return;
+    }
+    HistoryFilter_t filter;
+    historyFilterClear(filter);
+    if (request->hasParam("from")) {
+        filter.from = request->getParam("from")->value().toInt();
+    }
+    if (request->hasParam("to")) {
+        filter.to = request->getParam("to")->value().toInt();
+    }
+    if (request->hasParam("plant")) {
+        filter.plant = request->getParam("plant")->value().toInt();
+        if ((filter.plant < 0) || (filter.plant >= MAX_PLANTS)) {
+            request->send(400, "text/plain", "plant 0..6");
+            return;
+        }
+    }
+
+    size_t stagedLength;
+    const uint8_t* staged = this->mLog->getStaged(stagedLength);
+    this->mStream.begin(&HistoryServer::readLog, this->mLog, this->mLog->getSize(), this->mLog->getHead(),
+                        staged, stagedLength, filter);
+    this->mStreaming = true;
+    /* the filler is called by the TCP task, until it returns 0 */
+    AsyncWebServerResponse* response = request->beginChunkedResponse("text/csv",
+        [this](uint8_t* buffer, size_t maxLength, size_t index) -> size_t {
+            size_t length = this->mStream.fill(buffer, maxLength);
+            if (length == 0) {
+                this->mStreaming = false;
+            }
+            return length;
+        });
+    request->onDisconnect([this]() {
+        this->mStreaming = false;
+    });
+    request->send(response);
+}
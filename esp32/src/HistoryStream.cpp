@@ -0,0 +1,132 @@
+/**
+ * @file HistoryStream.cpp
+ * @author your name (you@domain.com)
+ * @brief History records as CSV, in pieces of any size
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "HistoryStream.h"
+#include <string.h>
+
+void historyFilterClear(HistoryFilter_t& filter) {
+    filter.from = 0;
+    filter.to = 0;
+    filter.plant = HISTORY_ALL_PLANTS;
+}
+
+void HistoryStream::begin(HistoryRead_t read, void* context, uint32_t size, uint32_t head,
+                          const uint8_t* staged, size_t stagedLength, const HistoryFilter_t& filter) {
+    this->mRead = read;
+    this->mContext = context;
+    this->mSize = size - (size % HISTORY_PAGE_SIZE);
+    this->mHead = (head < this->mSize) ? head : 0;
+    this->mStaged = staged;
+    this->mStagedLength = (staged != 0) ? stagedLength : 0;
+    this->mFilter = filter;
+    this->mPage = 0;
+    this->mSlot = 0;
+    this->mCount = 0;
+    this->mStagedPosition = 0;
+    deltaReset(this->mDecoder);
+    this->mHeaderSent = false;
+    this->mLineLength = 0;
+    this->mLinePosition = 0;
+}
+
+bool HistoryStream::nextStored(HistoryRecord_t& record) {
+    uint32_t pages = this->mSize / HISTORY_PAGE_SIZE;
+    while (this->mPage < pages) {
+        uint32_t offset = (this->mHead + (this->mPage * HISTORY_PAGE_SIZE)) % this->mSize;
+        if (this->mSlot == 0) {
+            /* erased and broken pages are skipped */
+            HistoryPageHeader_t header;
+            this->mCount = 0;
+            if (this->mRead(this->mContext, offset, &header, sizeof(header)) && historyPageIsValid(header)) {
+                this->mCount = header.count;
+            }
+        }
+        if (this->mSlot >= this->mCount) {
+            this->mPage++;
+            this->mSlot = 0;
+            continue;
+        }
+        uint32_t recordOffset = offset + sizeof(HistoryPageHeader_t) + (this->mSlot * sizeof(HistoryRecord_t));
+        this->mSlot++;
+        if (this->mRead(this->mContext, recordOffset, &record, sizeof(record)) && historyIsValid(record)) {
+            return true;
+        }
+    }
+    if (this->mStagedPosition < this->mStagedLength) {
+        uint32_t time;
+        int32_t values[HISTORY_CHANNELS];
+        size_t used = deltaDecode(this->mDecoder, HISTORY_CHANNELS, this->mStaged + this->mStagedPosition,
+                                  this->mStagedLength - this->mStagedPosition, time, values);
+        if (used > 0) {
+            this->mStagedPosition += used;
+            historyFromChannels(record, time, values);
+            return true;
+        }
+        this->mStagedPosition = this->mStagedLength;
+    }
+    return false;
+}
+
+bool HistoryStream::matches(const HistoryRecord_t& record) const {
+    if ((record.time < this->mFilter.from) || ((this->mFilter.to != 0) && (record.time > this->mFilter.to))) {
+        return false;
+    }
+    if ((this->mFilter.plant >= 0) && (this->mFilter.plant < MAX_PLANTS)) {
+        /* wakes without a value of the plant */
+        return (record.moisture[this->mFilter.plant] != HISTORY_UNKNOWN) ||
+               (record.pumps & (1 << this->mFilter.plant));
+    }
+    return true;
+}
+
+bool HistoryStream::next(HistoryRecord_t& record) {
+    while (nextStored(record)) {
+        if (matches(record)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool HistoryStream::nextLine(void) {
+    size_t length;
+    if (!this->mHeaderSent) {
+        this->mHeaderSent = true;
+        length = historyFormatHeader(this->mLine, HISTORY_LINE_SIZE, this->mFilter.plant);
+    } else {
+        HistoryRecord_t record;
+        if (!next(record)) {
+            return false;
+        }
+        length = historyFormat(this->mLine, HISTORY_LINE_SIZE, record, this->mFilter.plant);
+    }
+    this->mLine[length++] = '\n';
+    this->mLineLength = length;
+    this->mLinePosition = 0;
+    return true;
+}
+
+size_t HistoryStream::fill(uint8_t* buffer, size_t size) {
+    size_t used = 0;
+    while (used < size) {
+        if ((this->mLinePosition >= this->mLineLength) && !nextLine()) {
+            break;
+        }
+        size_t length = this->mLineLength - this->mLinePosition;
+        if (length > (size - used)) {
+            length = size - used;
+        }
+        memcpy(buffer + used, this->mLine + this->mLinePosition, length);
+        this->mLinePosition += length;
+        used += length;
+    }
+    return used;
+}
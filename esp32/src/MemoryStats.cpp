@@ -0,0 +1,62 @@
+/**
+ * @file MemoryStats.cpp
+ * @author your name (you@domain.com)
+ * @brief Heap, stack and RTC memory usage of one wake
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MemoryStats.h"
+#include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+/* Provided by the linker script of the IDF (esp32.common.ld) */
+extern "C" {
+    extern int _rtc_data_start;
+    extern int _rtc_data_end;
+    extern int _rtc_bss_start;
+    extern int _rtc_bss_end;
+    extern int _rtc_noinit_start;
+    extern int _rtc_noinit_end;
+}
+
+long MemoryStats::stackHighWaterMark(const char* taskName) {
+#if INCLUDE_xTaskGetHandle
+    TaskHandle_t handle = xTaskGetHandle(taskName);
+    if (handle == NULL) {
+        return STACK_UNKNOWN;
+    }
+    /* the IDF measures the stack in bytes */
+    return uxTaskGetStackHighWaterMark(handle);
+#else
+    if (strcmp(taskName, TASK_NAME_LOOP) == 0) {
+        return uxTaskGetStackHighWaterMark(NULL);
+    }
+    return STACK_UNKNOWN;
+#endif
+}
+
+void MemoryStats::sample(void) {
+    uint32_t largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (largestBlock < this->mLargestFreeBlock) {
+        this->mLargestFreeBlock = largestBlock;
+    }
+    /* the high water mark is already the minimum since the task was started */
+    this->mStackLoop = stackHighWaterMark(TASK_NAME_LOOP);
+    this->mStackWifi = stackHighWaterMark(TASK_NAME_WIFI);
+    this->mStackMqtt = stackHighWaterMark(TASK_NAME_MQTT);
+}
+
+uint32_t MemoryStats::getMinFreeHeap(void) {
+    return heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+size_t MemoryStats::getRtcUsage(void) {
+    return ((size_t) &_rtc_data_end - (size_t) &_rtc_data_start) +
+           ((size_t) &_rtc_bss_end - (size_t) &_rtc_bss_start) +
+           ((size_t) &_rtc_noinit_end - (size_t) &_rtc_noinit_start);
+}
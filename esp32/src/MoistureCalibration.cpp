@@ -0,0 +1,88 @@
+/**
+ * @file MoistureCalibration.cpp
+ * @author your name (you@domain.com)
+ * @brief Two point calibration of the moisture sensors
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MoistureCalibration.h"
+
+#define PERCENT_MAX     (100L << CALIBRATION_FRACTION)
+
+void calibrationClear(CalibrationPoints_t& points) {
+    points.dry = CALIBRATION_UNSET;
+    points.wet = CALIBRATION_UNSET;
+}
+
+bool calibrationIsValid(const CalibrationPoints_t& points) {
+    if ((points.dry > CALIBRATION_ADC_MAX) || (points.wet > CALIBRATION_ADC_MAX)) {
+        return false;
+    }
+    long span = (long) points.wet - (long) points.dry;
+    return (span >= CALIBRATION_MIN_SPAN) || (span <= -CALIBRATION_MIN_SPAN);
+}
+
+MoistureCalibration::MoistureCalibration() {
+    CalibrationPoints_t points;
+    calibrationClear(points);
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        this->setPoints(i, points);
+    }
+}
+
+void MoistureCalibration::setPoints(int plant, const CalibrationPoints_t& points) {
+    if ((plant < 0) || (plant >= MAX_PLANTS)) {
+        return;
+    }
+    long dry = 0;
+    long wet = CALIBRATION_ADC_MAX;
+    this->mCalibrated[plant] = calibrationIsValid(points);
+    if (this->mCalibrated[plant]) {
+        dry = points.dry;
+        wet = points.wet;
+    }
+    /* the sensor may read lower or higher values, when it is wet */
+    for (long i = 0; i < CALIBRATION_TABLE_SIZE; i++) {
+        long adc = i << CALIBRATION_TABLE_SHIFT;
+        long percent = ((adc - dry) * PERCENT_MAX) / (wet - dry);
+        if (percent < 0) {
+            percent = 0;
+        } else if (percent > PERCENT_MAX) {
+            percent = PERCENT_MAX;
+        }
+        this->mTables[plant][i] = (uint16_t) percent;
+    }
+}
+
+bool MoistureCalibration::isCalibrated(int plant) const {
+    return (plant >= 0) && (plant < MAX_PLANTS) && this->mCalibrated[plant];
+}
+
+int MoistureCalibration::getPercent(int plant, int adc) const {
+    if ((plant < 0) || (plant >= MAX_PLANTS)) {
+        return 0;
+    }
+    if (adc < 0) {
+        adc = 0;
+    } else if (adc > CALIBRATION_ADC_MAX) {
+        adc = CALIBRATION_ADC_MAX;
+    }
+    const uint16_t* table = this->mTables[plant];
+    int index = adc >> CALIBRATION_TABLE_SHIFT;
+    long value = table[index];
+    /* interpolate inside the ADC step; the last step continues the line towards its end */
+    long step = (index + 1 < CALIBRATION_TABLE_SIZE) ? ((long) table[index + 1] - value)
+                                                     : (value - (long) table[index - 1]);
+    value += (step * (adc & ((1 << CALIBRATION_TABLE_SHIFT) - 1))) >> CALIBRATION_TABLE_SHIFT;
+    if (value < 0) {
+        value = 0;
+    } else if (value > PERCENT_MAX) {
+        value = PERCENT_MAX;
+    }
+    /* rounded */
+    return (int) ((value + (1L << (CALIBRATION_FRACTION - 1))) >> CALIBRATION_FRACTION);
+}
@@ -0,0 +1,157 @@
+/**
+ * @file MqttFastPath.cpp
+ * @author your name (you@domain.com)
+ * @brief Publish the sensor values without the Homie bootstrap
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "MqttFastPath.h"
+
+#define FASTPATH_MAGIC      0x46503031  /**< "FP01", changes with the layout of the snapshot */
+#define BSSID_SIZE          6
+
+/**
+ * @brief Snapshot of the Homie configuration, needed to publish
+ */
+typedef struct FastPathSettings_t {
+    uint32_t magic;
+    char ssid[FASTPATH_SSID_SIZE];
+    char wifiPassword[FASTPATH_PASSWORD_SIZE];
+    uint8_t bssid[BSSID_SIZE];
+    bool useBssid;
+    uint16_t channel;
+    char host[FASTPATH_HOST_SIZE];
+    uint16_t port;
+    char baseTopic[FASTPATH_TOPIC_SIZE];
+    char deviceId[FASTPATH_ID_SIZE];
+    bool auth;
+    char username[FASTPATH_CREDS_SIZE];
+    char mqttPassword[FASTPATH_CREDS_SIZE];
+    uint16_t homieWakes;
+    uint16_t wakesSinceHomie;
+} FastPathSettings_t;
+
+RTC_DATA_ATTR FastPathSettings_t rtcFastPath;
+
+static AsyncMqttClient gClient;
+static volatile bool gConnected = false;
+static volatile uint16_t gAcknowledged = 0;
+
+static bool copyString(char* destination, size_t size, const char* source) {
+    size_t length = strlen(source);
+    if (length >= size) {
+        return false;
+    }
+    memcpy(destination, source, length + 1);
+    return true;
+}
+
+/**
+ * @brief Parse a MAC address like "AA:BB:CC:DD:EE:FF"
+ */
+static bool parseBssid(uint8_t* bssid, const char* text) {
+    for (int i = 0; i < BSSID_SIZE; i++) {
+        char* end = NULL;
+        unsigned long value = strtoul(text, &end, 16);
+        if ((end == text) || (value > 0xFF) || ((i < (BSSID_SIZE - 1)) && (*end != ':'))) {
+            return false;
+        }
+        bssid[i] = value;
+        text = end + 1;
+    }
+    return true;
+}
+
+void MqttFastPath::store(const HomieInternals::ConfigStruct& config, long homieWakes) {
+    rtcFastPath.magic = 0;
+    rtcFastPath.homieWakes = constrain(homieWakes, 0, UINT16_MAX);
+    rtcFastPath.wakesSinceHomie = 0;
+    if (!copyString(rtcFastPath.ssid, sizeof(rtcFastPath.ssid), config.wifi.ssid) ||
+        !copyString(rtcFastPath.wifiPassword, sizeof(rtcFastPath.wifiPassword), config.wifi.password) ||
+        !copyString(rtcFastPath.host, sizeof(rtcFastPath.host), config.mqtt.server.host) ||
+        !copyString(rtcFastPath.baseTopic, sizeof(rtcFastPath.baseTopic), config.mqtt.baseTopic) ||
+        !copyString(rtcFastPath.deviceId, sizeof(rtcFastPath.deviceId), config.deviceId) ||
+        !copyString(rtcFastPath.username, sizeof(rtcFastPath.username), config.mqtt.username) ||
+        !copyString(rtcFastPath.mqttPassword, sizeof(rtcFastPath.mqttPassword), config.mqtt.password)) {
+        /* Something does not fit, always use Homie */
+        return;
+    }
+    rtcFastPath.useBssid = parseBssid(rtcFastPath.bssid, config.wifi.bssid);
+    rtcFastPath.channel = config.wifi.channel;
+    rtcFastPath.port = config.mqtt.server.port;
+    rtcFastPath.auth = config.mqtt.auth;
+    rtcFastPath.magic = FASTPATH_MAGIC;
+}
+
+bool MqttFastPath::isEnabled(void) {
+    return (rtcFastPath.magic == FASTPATH_MAGIC) && (rtcFastPath.homieWakes > 0);
+}
+
+bool MqttFastPath::isFullSetupDue(void) {
+    if (!isEnabled()) {
+        return false;
+    }
+    if (rtcFastPath.wakesSinceHomie < UINT16_MAX) {
+        rtcFastPath.wakesSinceHomie++;
+    }
+    return rtcFastPath.wakesSinceHomie >= rtcFastPath.homieWakes;
+}
+
+bool MqttFastPath::run(TelemetryPublisher* publisher, void (*publishValues)(void), AwakeBudget* budget) {
+    if (!isEnabled()) {
+        return false;
+    }
+
+    budget->enter(BUDGET_WIFI, millis());
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(rtcFastPath.ssid, rtcFastPath.wifiPassword, rtcFastPath.channel,
+               rtcFastPath.useBssid ? rtcFastPath.bssid : NULL);
+    while (WiFi.status() != WL_CONNECTED) {
+        if (budget->isOverrun(millis())) {
+            Serial << "fp wifi timeout" << endl;
+            WiFi.mode(WIFI_OFF);
+            return false;
+        }
+        delay(10);
+    }
+
+    gConnected = false;
+    gAcknowledged = 0;
+    gClient.onConnect([](bool sessionPresent) { gConnected = true; });
+    gClient.onPublish([](uint16_t packetId) { gAcknowledged++; });
+    gClient.setServer(rtcFastPath.host, rtcFastPath.port);
+    gClient.setClientId(rtcFastPath.deviceId);
+    if (rtcFastPath.auth) {
+        gClient.setCredentials(rtcFastPath.username, rtcFastPath.mqttPassword);
+    }
+    gClient.connect();
+
+    budget->enter(BUDGET_MQTT, millis());
+    while (!gConnected && !budget->isOverrun(millis())) {
+        delay(5);
+    }
+
+    bool published = false;
+    if (gConnected) {
+        budget->enter(BUDGET_PUBLISH, millis());
+        publisher->begin(&gClient, rtcFastPath.baseTopic, rtcFastPath.deviceId);
+        publishValues();
+        uint16_t expected = publisher->getPublishCount();
+        while ((gAcknowledged < expected) && !budget->isOverrun(millis())) {
+            delay(5);
+        }
+        published = (gAcknowledged >= expected);
+        gClient.disconnect();
+    } else {
+        Serial << "fp mqtt timeout" << endl;
+    }
+
+    WiFi.disconnect(true);
+    budget->enter(BUDGET_DONE, millis());
+    return published;
+}
@@ -24,6 +24,10 @@ void Plant::init(void) {
     this->mSetting->pSensorDry->setValidator([] (long candidate) {
         return (((candidate >= 0) && (candidate <= 4095) ) || candidate == DEACTIVATED_PLANT);
     });
+    this->mSetting->pSensorDryPercent->setDefaultValue(MOIST_PERCENT_UNUSED);
+    this->mSetting->pSensorDryPercent->setValidator([] (long candidate) {
+        return (((candidate >= 0) && (candidate <= 100) ) || candidate == MOIST_PERCENT_UNUSED);
+    });
     this->mSetting->pPumpAllowedHourRangeStart->setDefaultValue(8); // start at 8:00
     this->mSetting->pPumpAllowedHourRangeStart->setValidator([] (long candidate) {
         return ((candidate >= 0) && (candidate <= 23) );
@@ -37,7 +41,10 @@ void Plant::init(void) {
     this->mSetting->pPumpCooldownInHours->setValidator([] (long candidate) {
         return ((candidate >= 0) && (candidate <= 1024) );
     });
-    
+    this->mSetting->pPumpMaxRuntime->setDefaultValue(30); // seconds
+    this->mSetting->pPumpMaxRuntime->setValidator([] (long candidate) {
+        return ((candidate >= 1) && (candidate <= 600) );
+    });
 }
 
 void Plant::addSenseValue(int analog) {
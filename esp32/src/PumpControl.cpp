@@ -0,0 +1,303 @@
+/**
+ * @file PumpControl.cpp
+ * @author your name (you@domain.com)
+ * @brief Pump task with a hard deadline for every running pump
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "PumpControl.h"
+#include "ControllerConfiguration.h"
+#include <esp_timer.h>
+
+static PumpControl* gPumpControl = NULL;
+
+void IRAM_ATTR PumpControl::onTimer(void) {
+    BaseType_t woken = pdFALSE;
+    if ((gPumpControl != NULL) && (gPumpControl->mTask != NULL)) {
+        vTaskNotifyGiveFromISR(gPumpControl->mTask, &woken);
+    }
+    if (woken) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+void PumpControl::taskMain(void* parameter) {
+    PumpControl* control = (PumpControl*) parameter;
+    for (;;) {
+        /* the timeout is only a fallback, the hardware timer wakes the task at the deadline */
+        TickType_t timeout = portMAX_DELAY;
+        if ((control->mRunningMask | control->mPendingMask) != 0) {
+            /* also the step of the soft-start ramps */
+            timeout = pdMS_TO_TICKS(PUMP_SOFTSTART_STEP);
+        }
+        ulTaskNotifyTake(pdTRUE, timeout);
+        control->process();
+    }
+}
+
+void PumpControl::begin(const int* pins, int count, int enablePin, int supplyPin) {
+    if (count > PUMP_MAX_PUMPS) {
+        count = PUMP_MAX_PUMPS;
+    }
+    this->mPumps = count;
+    this->mEnablePin = enablePin;
+    this->mSupplyPin = supplyPin;
+    for (int i = 0; i < count; i++) {
+        this->mPins[i] = pins[i];
+        this->mMailbox[i] = PUMP_CMD_NONE;
+        this->mMaxRuntime[i] = PUMP_DEFAULT_MAX_RUNTIME;
+        this->mDeadline[i] = 0;
+        this->mRampStart[i] = 0;
+        this->mRunTime[i] = 0;
+        ledcSetup(PUMP_LEDC_CHANNEL + i, PUMP_LEDC_FREQUENCY, PUMP_LEDC_RESOLUTION);
+        ledcAttachPin(pins[i], PUMP_LEDC_CHANNEL + i);
+        ledcWrite(PUMP_LEDC_CHANNEL + i, 0);
+    }
+    if (enablePin >= 0) {
+        pinMode(enablePin, OUTPUT);
+        digitalWrite(enablePin, LOW);
+    }
+
+    gPumpControl = this;
+    this->mTimer = timerBegin(PUMP_TIMER, PUMP_TIMER_DIVIDER, true);
+    timerAttachInterrupt(this->mTimer, &PumpControl::onTimer, true);
+
+    if (xTaskCreatePinnedToCore(&PumpControl::taskMain, "pump", PUMP_TASK_STACK, this,
+                                configMAX_PRIORITIES - 1, &this->mTask, PUMP_TASK_CORE) != pdPASS) {
+        this->mTask = NULL;
+        Serial << "pump task failed" << endl;
+    }
+}
+
+void PumpControl::setMaxRuntime(int pump, uint32_t milliseconds) {
+    if ((pump < 0) || (pump >= this->mPumps)) {
+        return;
+    }
+    if ((milliseconds == 0) || (milliseconds >= PUMP_CMD_START)) {
+        milliseconds = PUMP_DEFAULT_MAX_RUNTIME;
+    }
+    this->mMaxRuntime[pump] = milliseconds;
+}
+
+void PumpControl::setCurrentBudget(uint16_t milliAmpere, uint16_t* currents) {
+    this->mCurrentBudget = milliAmpere;
+    this->mCurrent = currents;
+}
+
+void PumpControl::post(int pump, uint32_t command) {
+    if ((pump < 0) || (pump >= this->mPumps)) {
+        return;
+    }
+    __atomic_store_n(&this->mMailbox[pump], command, __ATOMIC_RELEASE);
+    if (this->mTask != NULL) {
+        xTaskNotifyGive(this->mTask);
+    } else if (command == PUMP_CMD_STOP) {
+        /* without the task at least stopping must work */
+        ledcWrite(PUMP_LEDC_CHANNEL + pump, 0);
+    }
+}
+
+void PumpControl::start(int pump, uint32_t milliseconds) {
+    post(pump, PUMP_CMD_START | (milliseconds & ~PUMP_CMD_START));
+}
+
+void PumpControl::stop(int pump) {
+    post(pump, PUMP_CMD_STOP);
+}
+
+void PumpControl::stopAll(void) {
+    for (int i = 0; i < this->mPumps; i++) {
+        stop(i);
+    }
+}
+
+uint32_t PumpControl::getRunTime(int pump) {
+    if ((pump < 0) || (pump >= this->mPumps)) {
+        return 0;
+    }
+    return this->mRunTime[pump];
+}
+
+bool PumpControl::isActive(void) {
+    if ((this->mRunningMask | this->mPendingMask) != 0) {
+        return true;
+    }
+    for (int i = 0; i < this->mPumps; i++) {
+        if (__atomic_load_n(&this->mMailbox[i], __ATOMIC_ACQUIRE) & PUMP_CMD_START) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool PumpControl::isRunning(int pump) {
+    if ((pump < 0) || (pump >= this->mPumps)) {
+        return false;
+    }
+    if (((this->mRunningMask | this->mPendingMask) & (1 << pump)) != 0) {
+        return true;
+    }
+    return (__atomic_load_n(&this->mMailbox[pump], __ATOMIC_ACQUIRE) & PUMP_CMD_START) != 0;
+}
+
+uint16_t PumpControl::getCurrent(int pump) {
+    if ((this->mCurrent == NULL) || (this->mCurrent[pump] == 0)) {
+        return PUMP_DEFAULT_CURRENT;
+    }
+    return this->mCurrent[pump];
+}
+
+bool PumpControl::fitsBudget(int pump) {
+    if (this->mRunningMask == 0) {
+        /* a single pump always runs, even above the budget */
+        return true;
+    }
+    if (this->mCurrentBudget == 0) {
+        return false;
+    }
+    uint32_t current = getCurrent(pump);
+    for (int i = 0; i < this->mPumps; i++) {
+        if (this->mRunningMask & (1UL << i)) {
+            current += getCurrent(i);
+        }
+    }
+    return current <= this->mCurrentBudget;
+}
+
+void PumpControl::switchPump(int pump, bool on) {
+    uint32_t mask = (1UL << pump);
+    if (on) {
+        if (this->mEnablePin >= 0) {
+            digitalWrite(this->mEnablePin, HIGH);
+        }
+        if (!(this->mRunningMask & mask)) {
+            /* the ramp starts from zero duty */
+            this->mSupplyBefore[pump] = (this->mSupplyPin >= 0) ? analogRead(this->mSupplyPin) : 0;
+            this->mRampStart[pump] = esp_timer_get_time();
+            this->mRunStart[pump] = this->mRampStart[pump];
+            ledcWrite(PUMP_LEDC_CHANNEL + pump, 0);
+        }
+        this->mRunningMask |= mask;
+    } else {
+        ledcWrite(PUMP_LEDC_CHANNEL + pump, 0);
+        if (this->mRunningMask & mask) {
+            this->mRunTime[pump] += (uint32_t) ((esp_timer_get_time() - this->mRunStart[pump]) / 1000);
+        }
+        this->mRunningMask &= ~mask;
+        this->mDeadline[pump] = 0;
+        this->mRampStart[pump] = 0;
+        if (((this->mRunningMask | this->mPendingMask) == 0) && (this->mEnablePin >= 0)) {
+            digitalWrite(this->mEnablePin, LOW);
+        }
+    }
+}
+
+bool PumpControl::ramp(int64_t now) {
+    bool ramping = false;
+    for (int i = 0; i < this->mPumps; i++) {
+        if (this->mRampStart[i] == 0) {
+            continue;
+        }
+        int64_t elapsed = (now - this->mRampStart[i]) / 1000;
+        if (elapsed < PUMP_SOFTSTART_TIME) {
+            ledcWrite(PUMP_LEDC_CHANNEL + i, (uint32_t) ((PUMP_LEDC_MAX_DUTY * elapsed) / PUMP_SOFTSTART_TIME));
+            ramping = true;
+            continue;
+        }
+        ledcWrite(PUMP_LEDC_CHANNEL + i, PUMP_LEDC_MAX_DUTY);
+        if (elapsed < (PUMP_SOFTSTART_TIME + PUMP_SAG_DELAY)) {
+            ramping = true;
+            continue;
+        }
+
+        /* the sag of the supply at full duty is caused by this pump */
+        this->mRampStart[i] = 0;
+        if ((this->mSupplyPin < 0) || (this->mCurrent == NULL) ||
+            (ADC_5V_TO_3V3(this->mSupplyBefore[i]) <= NO_LIPO_VOLT)) {
+            continue;
+        }
+        double sag = ADC_5V_TO_3V3(this->mSupplyBefore[i]) - ADC_5V_TO_3V3(analogRead(this->mSupplyPin));
+        long measured = (long) (sag * 1000000 / PUMP_SUPPLY_RESISTANCE);
+        if (measured < PUMP_MIN_CURRENT) {
+            measured = PUMP_MIN_CURRENT;
+        } else if (measured > PUMP_MAX_CURRENT) {
+            measured = PUMP_MAX_CURRENT;
+        }
+        this->mCurrent[i] = (uint16_t) ((3 * (long) getCurrent(i) + measured) / 4);
+    }
+    return ramping;
+}
+
+void PumpControl::startPending(int64_t now) {
+    for (int i = 0; i < this->mPumps; i++) {
+        uint32_t mask = (1UL << i);
+        if (!(this->mPendingMask & mask) || !fitsBudget(i)) {
+            continue;
+        }
+        this->mPendingMask &= ~mask;
+        this->mDeadline[i] = now + ((int64_t) this->mPendingRuntime[i] * 1000);
+        switchPump(i, true);
+        /* one ramp at a time, the inrush currents must not add up */
+        return;
+    }
+}
+
+void PumpControl::process(void) {
+    int64_t now = esp_timer_get_time();
+
+    for (int i = 0; i < this->mPumps; i++) {
+        uint32_t command = __atomic_exchange_n(&this->mMailbox[i], PUMP_CMD_NONE, __ATOMIC_ACQUIRE);
+        if (command == PUMP_CMD_STOP) {
+            this->mPendingMask &= ~(1UL << i);
+            switchPump(i, false);
+        } else if (command & PUMP_CMD_START) {
+            uint32_t runtime = command & ~PUMP_CMD_START;
+            if ((runtime == 0) || (runtime > this->mMaxRuntime[i])) {
+                runtime = this->mMaxRuntime[i];
+            }
+            if (this->mRunningMask & (1UL << i)) {
+                /* a running pump only gets a new deadline */
+                this->mDeadline[i] = now + ((int64_t) runtime * 1000);
+            } else {
+                this->mPendingRuntime[i] = runtime;
+                this->mPendingMask |= (1UL << i);
+            }
+        }
+    }
+
+    /* switch off all pumps, that reached their deadline */
+    for (int i = 0; i < this->mPumps; i++) {
+        if ((this->mDeadline[i] != 0) && (now >= this->mDeadline[i])) {
+            switchPump(i, false);
+        }
+    }
+
+    if (!ramp(now)) {
+        startPending(now);
+    }
+    armTimer(now);
+}
+
+void PumpControl::armTimer(int64_t now) {
+    if (this->mTimer == NULL) {
+        return;
+    }
+    int64_t next = 0;
+    for (int i = 0; i < this->mPumps; i++) {
+        if ((this->mDeadline[i] != 0) && ((next == 0) || (this->mDeadline[i] < next))) {
+            next = this->mDeadline[i];
+        }
+    }
+
+    timerAlarmDisable(this->mTimer);
+    if (next == 0) {
+        return;
+    }
+    timerWrite(this->mTimer, 0);
+    timerAlarmWrite(this->mTimer, (next > now) ? (uint64_t) (next - now) : 1, false);
+    timerAlarmEnable(this->mTimer);
+}
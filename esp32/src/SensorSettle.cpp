@@ -0,0 +1,70 @@
+/**
+ * @file SensorSettle.cpp
+ * @author your name (you@domain.com)
+ * @brief Detects, when a freshly powered sensor delivers stable values
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "SensorSettle.h"
+
+void SensorSettle::begin(uint32_t now, uint16_t learned, uint32_t maximum, float tolerance) {
+    mStart = now;
+    mMaximum = maximum;
+    /* half of the learned time: the sensor may settle faster, but not much */
+    mMinimum = (learned < maximum) ? (learned / 2) : (maximum / 2);
+    mTolerance = tolerance;
+    mHasLast = false;
+    mStable = 0;
+    mSettleTime = 0;
+    mDone = false;
+    mTimedOut = false;
+}
+
+bool SensorSettle::add(uint32_t now, float value, bool valid) {
+    if (mDone) {
+        return true;
+    }
+    uint32_t elapsed = now - mStart;
+    if (!valid) {
+        mHasLast = false;
+        mStable = 0;
+    } else {
+        float difference = value - mLast;
+        if (mHasLast && (difference <= mTolerance) && (difference >= -mTolerance)) {
+            mStable++;
+        } else {
+            mStable = 0;
+        }
+        mLast = value;
+        mHasLast = true;
+    }
+
+    if ((mStable >= SETTLE_STABLE_READINGS) && (elapsed >= mMinimum)) {
+        mDone = true;
+    } else if (elapsed >= mMaximum) {
+        mDone = true;
+        mTimedOut = true;
+    }
+    if (mDone) {
+        mSettleTime = elapsed;
+    }
+    return mDone;
+}
+
+uint16_t SensorSettle::learn(uint16_t learned) const {
+    if (!mDone) {
+        return learned;
+    }
+    if (mTimedOut) {
+        return (uint16_t) mMaximum;
+    }
+    if (learned == 0) {
+        return (uint16_t) mSettleTime;
+    }
+    /* moving average, a single slow or fast wake does not reset the history */
+    return (uint16_t) ((3UL * learned + mSettleTime) / 4);
+}
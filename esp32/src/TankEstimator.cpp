@@ -0,0 +1,131 @@
+/**
+ * @file TankEstimator.cpp
+ * @author your name (you@domain.com)
+ * @brief Water level of the tank, estimated from the pump runs and the ultrasonic sensor
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TankEstimator.h"
+
+#define TANK_ONE    (1L << TANK_FRACTION_BITS)
+
+void TankEstimator::begin(TankState_t* state) {
+    this->mState = state;
+}
+
+void TankEstimator::addPumped(long millilitre, long minLevel, long maxLevel, long volume) {
+    if ((this->mState == 0) || (millilitre <= 0) || (volume <= 0)) {
+        return;
+    }
+    /* the level moves from the maximum towards the minimum */
+    int64_t change = ((int64_t) (minLevel - maxLevel) * millilitre * TANK_ONE) / volume;
+    this->mState->pending += (int32_t) change;
+}
+
+void TankEstimator::predict(void) {
+    TankState_t* state = this->mState;
+    int64_t pending = state->pending;
+    state->level += (int32_t) pending;
+    state->pending = 0;
+
+    /* the pump model is as uncertain as the flow of the pumps */
+    int64_t deviation = pending / TANK_PUMP_UNCERTAINTY;
+    uint64_t variance = (uint64_t) state->variance + (TANK_PROCESS_VARIANCE * TANK_ONE) +
+                        (uint64_t) ((deviation * deviation) >> TANK_FRACTION_BITS);
+    if (variance > ((uint64_t) TANK_MAX_VARIANCE * TANK_ONE)) {
+        variance = (uint64_t) TANK_MAX_VARIANCE * TANK_ONE;
+    }
+    state->variance = (uint32_t) variance;
+}
+
+void TankEstimator::restart(int32_t measured) {
+    this->mState->level = measured;
+    this->mState->variance = TANK_MEASUREMENT_VARIANCE * TANK_ONE;
+    this->mState->rejected = 0;
+    this->mState->valid = 1;
+}
+
+bool TankEstimator::update(long measured) {
+    if (this->mState == 0) {
+        return false;
+    }
+    TankState_t* state = this->mState;
+    if (!state->valid) {
+        state->pending = 0;
+        if (measured <= 0) {
+            return false;
+        }
+        restart((int32_t) (measured * TANK_ONE));
+        return true;
+    }
+
+    predict();
+    if (measured <= 0) {
+        return false;
+    }
+
+    int64_t innovation = (int64_t) measured * TANK_ONE - state->level;
+    int64_t innovationVariance = (int64_t) state->variance + (TANK_MEASUREMENT_VARIANCE * TANK_ONE);
+    /* both sides in Q16 */
+    if ((innovation * innovation) > (TANK_GATE_SIGMA * TANK_GATE_SIGMA * innovationVariance * TANK_ONE)) {
+        state->rejected++;
+        if (state->rejected >= TANK_MAX_REJECTED) {
+            /* consistently somewhere else: refilled or moved */
+            restart((int32_t) (measured * TANK_ONE));
+            return true;
+        }
+        return false;
+    }
+    state->rejected = 0;
+
+    /* gain in Q16 */
+    int64_t gain = ((int64_t) state->variance << 16) / innovationVariance;
+    state->level += (int32_t) ((gain * innovation) >> 16);
+    state->variance -= (uint32_t) ((gain * state->variance) >> 16);
+    return true;
+}
+
+long TankEstimator::getLevel(void) const {
+    if (this->mState == 0) {
+        return 0;
+    }
+    return (this->mState->level + (TANK_ONE / 2)) >> TANK_FRACTION_BITS;
+}
+
+long TankEstimator::getDeviation(void) const {
+    if (this->mState == 0) {
+        return 0;
+    }
+    /* integer square root of the variance in mm^2 */
+    uint32_t variance = this->mState->variance >> TANK_FRACTION_BITS;
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+    while (bit > variance) {
+        bit >>= 2;
+    }
+    while (bit != 0) {
+        if (variance >= root + bit) {
+            variance -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+long TankEstimator::getFill(long level, long minLevel, long maxLevel) {
+    if (minLevel == maxLevel) {
+        return 0;
+    }
+    long fill = ((long long) (level - minLevel) * TANK_FILL_SCALE) / (maxLevel - minLevel);
+    if (fill < 0) {
+        return 0;
+    }
+    return (fill > TANK_FILL_SCALE) ? TANK_FILL_SCALE : fill;
+}
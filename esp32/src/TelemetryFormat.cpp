@@ -0,0 +1,104 @@
+/**
+ * @file TelemetryFormat.cpp
+ * @author your name (you@domain.com)
+ * @brief Format the telemetry values into fixed buffers
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TelemetryFormat.h"
+#include <math.h>
+#include <string.h>
+
+#define MAX_DECIMALS    6
+
+static const long POW10[MAX_DECIMALS + 1] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+
+/**
+ * @brief Write the digits of an unsigned value
+ * The digits are generated backwards into a scratch area and copied afterwards.
+ */
+static size_t formatUnsigned(char* buffer, size_t size, unsigned long value, uint8_t minDigits) {
+    char digits[TELEMETRY_VALUE_SIZE];
+    size_t amount = 0;
+    do {
+        digits[amount++] = '0' + (value % 10);
+        value /= 10;
+    } while (((value > 0) || (amount < minDigits)) && (amount < sizeof(digits)));
+
+    if (amount >= size) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    for (size_t i = 0; i < amount; i++) {
+        buffer[i] = digits[amount - 1 - i];
+    }
+    buffer[amount] = '\0';
+    return amount;
+}
+
+size_t formatLong(char* buffer, size_t size, long value) {
+    return formatFixed(buffer, size, value, 0);
+}
+
+size_t formatFixed(char* buffer, size_t size, long value, uint8_t decimals) {
+    if ((buffer == NULL) || (size < 2)) {
+        return 0;
+    }
+    if (decimals > MAX_DECIMALS) {
+        decimals = MAX_DECIMALS;
+    }
+
+    size_t pos = 0;
+    /* work unsigned, so LONG_MIN does not overflow */
+    unsigned long absolute = (unsigned long) value;
+    if (value < 0) {
+        buffer[pos++] = '-';
+        absolute = 0UL - absolute;
+    }
+
+    unsigned long integral = absolute / POW10[decimals];
+    size_t written = formatUnsigned(buffer + pos, size - pos, integral, 1);
+    if (written == 0) {
+        buffer[0] = '\0';
+        return 0;
+    }
+    pos += written;
+
+    if (decimals > 0) {
+        if ((pos + 1 + decimals) >= size) {
+            buffer[0] = '\0';
+            return 0;
+        }
+        buffer[pos++] = '.';
+        pos += formatUnsigned(buffer + pos, size - pos, absolute % POW10[decimals], decimals);
+    }
+    return pos;
+}
+
+size_t formatFloat(char* buffer, size_t size, float value, uint8_t decimals) {
+    if ((buffer == NULL) || (size < 4)) {
+        return 0;
+    }
+    if (decimals > MAX_DECIMALS) {
+        decimals = MAX_DECIMALS;
+    }
+    /* Same special values, the Arduino Print class is using */
+    if (isnan(value)) {
+        strcpy(buffer, "nan");
+        return 3;
+    }
+    if (isinf(value)) {
+        strcpy(buffer, "inf");
+        return 3;
+    }
+    float scaled = value * POW10[decimals];
+    if ((scaled > 2147483647.0f) || (scaled < -2147483647.0f)) {
+        strcpy(buffer, "ovf");
+        return 3;
+    }
+    return formatFixed(buffer, size, lroundf(scaled), decimals);
+}
@@ -0,0 +1,93 @@
+/**
+ * @file TelemetryMemory.cpp
+ * @author your name (you@domain.com)
+ * @brief Deadbands and last published values of the telemetry
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TelemetryMemory.h"
+#include <stdlib.h>
+#include <string.h>
+
+static const uint16_t DEADBAND_DEFAULTS[TELEMETRY_DEADBANDS] = {
+    DEADBAND_MOIST_DEFAULT, DEADBAND_TEMP_DEFAULT, DEADBAND_WATER_DEFAULT,
+    DEADBAND_VOLUME_DEFAULT, DEADBAND_VOLT_DEFAULT, DEADBAND_PERCENT_DEFAULT
+};
+
+/**
+ * @brief Deadband of each property
+ */
+static TelemetryDeadband_t getDeadband(TelemetryProperty_t property) {
+    if (property < TELEMETRY_SWITCH) {
+        return DEADBAND_MOIST;
+    }
+    switch (property) {
+        case TELEMETRY_TEMP:
+        case TELEMETRY_TEMP_CONTROL:
+            return DEADBAND_TEMP;
+        case TELEMETRY_WATER_REMAINING:
+            return DEADBAND_WATER;
+        case TELEMETRY_WATER_VOLUME:
+            return DEADBAND_VOLUME;
+        case TELEMETRY_LIPO_VOLT:
+        case TELEMETRY_SOLAR_VOLT:
+            return DEADBAND_VOLT;
+        case TELEMETRY_LIPO_PERCENT:
+        case TELEMETRY_SOLAR_PERCENT:
+            return DEADBAND_PERCENT;
+        default:
+            return DEADBAND_STATE;
+    }
+}
+
+bool telemetryParseDeadbands(const char* text, uint16_t deadband[TELEMETRY_DEADBANDS]) {
+    uint16_t parsed[TELEMETRY_DEADBANDS];
+    memcpy(parsed, DEADBAND_DEFAULTS, sizeof(parsed));
+    int kind = 0;
+    const char* position = text;
+    while ((position != NULL) && (*position != '\0')) {
+        if (kind >= TELEMETRY_DEADBANDS) {
+            return false;
+        }
+        char* end;
+        long value = strtol(position, &end, 10);
+        if ((value < 0) || (value > UINT16_MAX) || ((*end != ',') && (*end != '\0'))) {
+            return false;
+        }
+        if (end != position) {
+            parsed[kind] = (uint16_t) value;
+        }
+        kind++;
+        position = (*end == ',') ? (end + 1) : end;
+    }
+    memcpy(deadband, parsed, sizeof(parsed));
+    return true;
+}
+
+bool telemetryIsDue(const TelemetryMemory_t& memory, TelemetryProperty_t property, long value, uint32_t now) {
+    if (property >= TELEMETRY_PROPERTIES) {
+        return true;
+    }
+    const TelemetryLast_t& last = memory.last[property];
+    if (last.time == 0) {
+        return true;
+    }
+    TelemetryDeadband_t kind = getDeadband(property);
+    if (kind == DEADBAND_STATE) {
+        /* retained on the broker, so it is not repeated */
+        return (last.value != value);
+    }
+    long difference = (value > last.value) ? (value - last.value) : (last.value - value);
+    return (difference > memory.deadband[kind]) || ((now - last.time) >= memory.maxSilence);
+}
+
+void telemetryRemember(TelemetryMemory_t& memory, TelemetryProperty_t property, long value, uint32_t now) {
+    if (property < TELEMETRY_PROPERTIES) {
+        memory.last[property].value = value;
+        memory.last[property].time = now;
+    }
+}
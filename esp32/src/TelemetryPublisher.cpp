@@ -0,0 +1,190 @@
+/**
+ * @file TelemetryPublisher.cpp
+ * @author your name (you@domain.com)
+ * @brief Publish sensor values without heap allocation
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+#include "TelemetryPublisher.h"
+
+void TelemetryPublisher::begin(AsyncMqttClient* client, const char* baseTopic, const char* deviceId) {
+    this->mClient = client;
+    this->mPrefixLength = 0;
+    this->mPublished = 0;
+    size_t baseLength = strlen(baseTopic);
+    size_t idLength = strlen(deviceId);
+    /* prefix with slash and at least one character for node and property */
+    if ((baseLength + idLength + 4) >= sizeof(this->mTopic)) {
+        return;
+    }
+    memcpy(this->mTopic, baseTopic, baseLength);
+    memcpy(this->mTopic + baseLength, deviceId, idLength);
+    this->mPrefixLength = baseLength + idLength;
+    this->mTopic[this->mPrefixLength++] = '/';
+    this->mTopic[this->mPrefixLength] = '\0';
+}
+
+bool TelemetryPublisher::buildTopic(const char* node, const char* property) {
+    size_t nodeLength = strlen(node);
+    size_t propertyLength = strlen(property);
+    if ((this->mPrefixLength + nodeLength + 1 + propertyLength) >= sizeof(this->mTopic)) {
+        return false;
+    }
+    char* pos = this->mTopic + this->mPrefixLength;
+    memcpy(pos, node, nodeLength);
+    pos += nodeLength;
+    *pos++ = '/';
+    memcpy(pos, property, propertyLength + 1);
+    return true;
+}
+
+uint16_t TelemetryPublisher::publish(const char* node, const char* property, const char* payload, size_t length, bool retained) {
+    if (this->mProbe || !this->isReady() || !this->mClient->connected()) {
+        return 0;
+    }
+    if (!buildTopic(node, property)) {
+        return 0;
+    }
+    uint16_t packetId = this->mClient->publish(this->mTopic, TELEMETRY_QOS, retained, payload, length);
+    if (packetId != 0) {
+        this->mPublished++;
+    }
+    return packetId;
+}
+
+void TelemetryPublisher::setMemory(TelemetryMemory_t* memory, uint32_t now) {
+    this->mMemory = memory;
+    /* 0 marks a value, that was never published */
+    this->mNow = (now > 0) ? now : 1;
+    this->mSuppressed = 0;
+}
+
+bool TelemetryPublisher::isDue(TelemetryProperty_t property, long value) {
+    if ((this->mMemory == NULL) || telemetryIsDue(*this->mMemory, property, value, this->mNow)) {
+        return true;
+    }
+    if (!this->mProbe) {
+        this->mSuppressed++;
+    }
+    return false;
+}
+
+void TelemetryPublisher::remember(TelemetryProperty_t property, long value) {
+    if (this->mMemory != NULL) {
+        telemetryRemember(*this->mMemory, property, value, this->mNow);
+    }
+}
+
+uint16_t TelemetryPublisher::publishLong(const char* node, const char* property, long value, bool retained) {
+    char payload[TELEMETRY_VALUE_SIZE];
+    size_t length = formatLong(payload, sizeof(payload), value);
+    return publish(node, property, payload, length, retained);
+}
+
+uint16_t TelemetryPublisher::publishFixed(const char* node, const char* property, long value, uint8_t decimals, bool retained) {
+    char payload[TELEMETRY_VALUE_SIZE];
+    size_t length = formatFixed(payload, sizeof(payload), value, decimals);
+    return publish(node, property, payload, length, retained);
+}
+
+uint16_t TelemetryPublisher::publishFloat(const char* node, const char* property, float value, uint8_t decimals, bool retained) {
+    char payload[TELEMETRY_VALUE_SIZE];
+    size_t length = formatFloat(payload, sizeof(payload), value, decimals);
+    return publish(node, property, payload, length, retained);
+}
+
+uint16_t TelemetryPublisher::publishChanged(TelemetryProperty_t slot, const char* node, const char* property, long value, uint8_t decimals) {
+    if (!isDue(slot, value)) {
+        return 0;
+    }
+    if (this->mProbe) {
+        this->mProbeDue = true;
+        return 0;
+    }
+    uint16_t packetId = publishFixed(node, property, value, decimals);
+    if (packetId != 0) {
+        remember(slot, value);
+    }
+    return packetId;
+}
+
+uint16_t TelemetryPublisher::publishStateChanged(TelemetryProperty_t slot, const char* node, const char* property, bool state,
+                                                 const char* onText, const char* offText) {
+    if (!isDue(slot, state)) {
+        return 0;
+    }
+    if (this->mProbe) {
+        this->mProbeDue = true;
+        return 0;
+    }
+    const char* payload = state ? onText : offText;
+    uint16_t packetId = publish(node, property, payload, strlen(payload));
+    if (packetId != 0) {
+        remember(slot, state);
+    }
+    return packetId;
+}
+
+#ifdef TELEMETRY_BENCHMARK
+
+#include <esp_heap_caps.h>
+
+#define BENCHMARK_ROUNDS    1000
+
+static volatile uint32_t gAllocations = 0;
+
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_realloc(void* ptr, size_t size);
+
+    void* __wrap_malloc(size_t size) {
+        gAllocations++;
+        return __real_malloc(size);
+    }
+
+    void* __wrap_realloc(void* ptr, size_t size) {
+        gAllocations++;
+        return __real_realloc(ptr, size);
+    }
+}
+
+static void benchmarkReport(const char* name, uint32_t allocations, unsigned long duration, size_t freeBefore, size_t blockBefore) {
+    Serial << name << ": " << allocations << " allocs, " << duration << " us, free "
+           << freeBefore << " -> " << heap_caps_get_free_size(MALLOC_CAP_8BIT)
+           << ", largest block " << blockBefore << " -> " << heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) << endl;
+}
+
+void telemetryBenchmark(void) {
+    char payload[TELEMETRY_VALUE_SIZE];
+    size_t checksum = 0;
+
+    /* Values in the same range as the sensors deliver */
+    size_t freeBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t blockBefore = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    uint32_t allocations = gAllocations;
+    unsigned long start = micros();
+    for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+        String percent = String(100 * (i % 4096) / 4095);
+        String volt = String(ADC_5V_TO_3V3(i % 4096));
+        String temp = String(-10.0f + (i % 500) * 0.0625f);
+        checksum += percent.length() + volt.length() + temp.length();
+    }
+    benchmarkReport("String", gAllocations - allocations, micros() - start, freeBefore, blockBefore);
+
+    freeBefore = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    blockBefore = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    allocations = gAllocations;
+    start = micros();
+    for (int i = 0; i < BENCHMARK_ROUNDS; i++) {
+        checksum += formatLong(payload, sizeof(payload), 100 * (i % 4096) / 4095);
+        checksum += formatFloat(payload, sizeof(payload), ADC_5V_TO_3V3(i % 4096), 2);
+        checksum += formatFloat(payload, sizeof(payload), -10.0f + (i % 500) * 0.0625f, 2);
+    }
+    benchmarkReport("Buffer", gAllocations - allocations, micros() - start, freeBefore, blockBefore);
+    Serial << "checksum " << checksum << endl;
+}
+#endif
@@ -15,7 +15,25 @@
 #include <Homie.h>
 #include "time.h"
 #include "esp_sleep.h"
+#include "freertos/event_groups.h"
 #include "RunningMedian.h"
+#include "TelemetryPublisher.h"
+#include "MemoryStats.h"
+#include "MqttFastPath.h"
+#include "ChunkedOta.h"
+#include "PumpControl.h"
+#include "SampleRing.h"
+#include "ControlLogic.h"
+#include "ControlTrace.h"
+#include "SensorSettle.h"
+#include "MoistureCalibration.h"
+#include "AwakeBudget.h"
+#include "TankEstimator.h"
+#include "HistoryLog.h"
+#include "HistoryServer.h"
+#include "DailyStats.h"
+#include "DeltaCodec.h"
+#include <Preferences.h>
 #include <arduino-timer.h>
 
 const unsigned long TEMPREADCYCLE = 30000; /**< Check temperature all half minutes */
@@ -25,34 +43,79 @@ const unsigned long TEMPREADCYCLE = 30000; /**< Check temperature all half minut
 #define SOLAR4SENSORS         6.0f
 #define TEMP_INIT_VALUE       -999.0f
 #define TEMP_MAX_VALUE        85.0f
+#define AMOUNT_SYSTEM_QUERYS  5       /**< Lipo and solar readings for the median */
+#define ACQUISITION_STACK     4096
+#define ACQUISITION_CORE      1       /**< WiFi runs on core 0 */
+#define SENSORS_READY         BIT0
+#define ACQUISITION_DONE      BIT1    /**< The task ended, with all or (stopped) some stages */
+#define ACQUISITION_STOP_TIMEOUT 50   /**< ms, the running stage finishes, the others are dropped */
+#define SAMPLE_RING_SIZE      32      /**< Samples of one wake: 7 plants, 2 temperatures, water, echo, lipo, solar and 8 settle times */
+#define TRACE_RTC_SIZE        256     /**< Bytes of traced wakes without connection (compressed, about 12 bytes per wake) */
+#define SETTLE_CHANNEL_TEMP   MAX_PLANTS  /**< All DS18B20 share one settle channel */
+#define SETTLE_CHANNELS       (MAX_PLANTS + 1)
+#define SETTLE_MOISTURE_MAX   100     /**< Upper bound (ms), the former fixed delay */
+#define SETTLE_MOISTURE_INTERVAL 5    /**< ms between two readings */
+#define SETTLE_MOISTURE_TOLERANCE 32  /**< ADC steps */
+#define SETTLE_TEMP_MAX       800     /**< Upper bound (ms), four conversions at TEMP_RESOLUTION */
+#define SETTLE_TEMP_INTERVAL  20      /**< ms between two polls of the running conversion */
+#define TEMP_RESOLUTION       10      /**< bit, 0.25 degree like the tolerance, 188 ms per conversion */
+#define SETTLE_TEMP_TOLERANCE 0.25f   /**< °C */
+#define ACQUISITION_STAGES    3       /**< Temperature, water level and system sensors */
+#define STAGE_TEMPERATURE     BIT0
+#define STAGE_ECHO            BIT1
+#define STAGE_SYSTEM          BIT2
+#define STAGES_POWERED        (STAGE_TEMPERATURE | STAGE_ECHO)  /**< Stages, that need OUTPUT_SENSOR */
+#define ECHO_POLL_INTERVAL    2       /**< ms */
+#define ECHO_TIMEOUT          40      /**< ms, the HC-SR04 gives up after 38ms without an echo */
+#define CALIBRATION_NAMESPACE "calibration" /**< NVS namespace of the moisture calibration */
+#define CALIBRATION_KEY       "points"
+#define DEFAULT_SLEEP_TIME    300000  /**< ms, until the settings are known */
+#define AWAKE_WATCHDOG        30000   /**< ms, last resort, if no phase ends the wake (not while watering) */
+#define PUMP_STOP_TIMEOUT     100     /**< ms, the pump task needs to switch off before sleeping */
+#define SWITCH_SEND_TIME      100     /**< ms, the MQTT client needs to send the last switch states before sleeping */
+#define HOMIE_OTA_TIMEOUT     60000   /**< ms without progress, until a Homie OTA is given up */
+#define TIMEZONE_SIZE         48      /**< POSIX TZ string, e.g. CET-1CEST,M3.5.0,M10.5.0/3 */
+
+typedef enum WakeRoute_t {
+  WAKE_ROUTE_COLD = 0,  /**< Power on or reset: full initialization with Homie */
+  WAKE_ROUTE_TIMER,     /**< Cyclic measurement: cheapest path, decided by mode1 */
+  WAKE_ROUTE_BUTTON     /**< Technician pressed the button: stay alive with Homie */
+} WakeRoute_t;
 
 /********************* non volatile enable after deepsleep *******************************/
 
-RTC_DATA_ATTR long rtcDeepSleepTime = 0;      /**< Time, when the microcontroller shall be up again */
-RTC_DATA_ATTR long rtcLastActive0 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger0 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive1 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger1 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive2 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger2 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive3 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger3 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive4 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger4 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive5 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger5 = 0;   /**<Level for the moisture sensor */
-RTC_DATA_ATTR long rtcLastActive6 = 0;
-RTC_DATA_ATTR long rtcMoistureTrigger6 = 0;   /**<Level for the moisture sensor */
+RTC_DATA_ATTR ControlState_t rtcControl = {};   /**< Watering state machine of each plant, @see ControlLogic.h */
 RTC_DATA_ATTR int lastPumpRunning = 0;
 RTC_DATA_ATTR long lastWaterValue = 0;
+RTC_DATA_ATTR long rtcWaterLevelMax = 0;      /**< Copy of the setting, for the fast path */
+RTC_DATA_ATTR long rtcWaterLevelMin = 0;      /**< Copy of the setting, for the fast path */
+RTC_DATA_ATTR long rtcWaterLevelWarn = 0;     /**< Copy of the setting, for the fast path */
+RTC_DATA_ATTR long rtcWaterVolume = 0;        /**< Copy of the setting, for the fast path */
+RTC_DATA_ATTR TankState_t rtcTank = { 0 };    /**< Estimated water level */
+RTC_DATA_ATTR HistoryStaging_t rtcHistory = { HISTORY_HEAD_UNKNOWN, 0, 0 };  /**< Wakes, not written to the flash yet */
+RTC_DATA_ATTR long rtcNightSleepTime = 0;     /**< Copy of the setting, every wake configures its sleep */
+RTC_DATA_ATTR long rtcPumpSleepTime = 0;      /**< Copy of the setting */
+RTC_DATA_ATTR uint16_t rtcBudgetDeadline[BUDGET_PHASES] = { 0 };  /**< Copy of the setting, 0 uses the default */
+RTC_DATA_ATTR uint16_t rtcOverruns[BUDGET_PHASES] = { 0 };        /**< Overruns per phase, until published */
+RTC_DATA_ATTR uint16_t rtcPumpCurrent[MAX_PLANTS] = { 0 };        /**< mA per pump, estimated by the pump driver */
+RTC_DATA_ATTR uint16_t rtcSettleTime[SETTLE_CHANNELS] = { 0 };  /**< Learned settle time (ms) per sensor channel */
+RTC_DATA_ATTR TelemetryMemory_t rtcTelemetry = {};              /**< Last published values and the deadbands */
+RTC_DATA_ATTR DailyStatsState_t rtcStats = {};                  /**< Aggregates of the current day */
+RTC_DATA_ATTR char rtcTimeZone[TIMEZONE_SIZE] = "";             /**< Copy of the setting, the local midnight ends a day */
+RTC_DATA_ATTR CalibrationPoints_t rtcCalibration[MAX_PLANTS];     /**< Copy of the NVS, read once after power on */
+RTC_DATA_ATTR bool rtcCalibrationLoaded = false;
+RTC_DATA_ATTR uint8_t rtcPercentControl = 0;    /**< Plants, whose threshold is moistpercent (calibrated), the others use moistdry */
 
 
 bool warmBoot = true;
 bool mode3Active = false;   /**< Controller must not sleep */
+bool mFastPathActive = false; /**< Values are published without Homie */
+unsigned long mHomieOtaActivity = 0; /**< millis() of the last Homie OTA event, 0 if no update is running */
 
 
 bool mLoopInited = false;
-bool mDeepSleep = false;
+uint8_t mStartedPumps = 0;  /**< Bit mask of the pumps started in this wake */
+uint8_t mHistoryWake = HISTORY_WAKE_NOP;  /**< @see HistoryWake_t */
 
 int plantSensor1 = 0;
 
@@ -62,22 +125,57 @@ int solarSensor = -1;
 int solarSensorValues = 0;
 
 int mWaterGone = -1;  /**< Amount of centimeter, where no water is seen */
+float mTemperature[2] = { TEMP_INIT_VALUE, TEMP_INIT_VALUE }; /**< @see TEMP_CHANNEL_AIR and TEMP_CHANNEL_CONTROL */
+long mEchoDuration = -1; /**< Raw value of the ultrasonic sensor (us) */
+EventGroupHandle_t mSensorEvents = NULL;  /**< Signals the end of the acquisition task */
+TaskHandle_t mAcquisitionTask = NULL;
+volatile bool mStopAcquisition = false;       /**< The task must end after the running stage */
+Timer<ACQUISITION_STAGES> acquisitionStages;  /**< Cooperative stages of the acquisition task */
+uint32_t mPendingStages = 0;                  /**< STAGE_* bits of the running stages */
+SensorSettle mTempSettle;
+uint32_t mTempConversionStart = 0;            /**< ms, start of the running DS18B20 conversion */
+volatile uint32_t mEchoRise = 0;              /**< us */
+volatile uint32_t mEchoFall = 0;              /**< us */
+volatile bool mEchoReceived = false;
+unsigned long mEchoTriggered = 0;             /**< ms */
 int readCounter = 0;
-int mButtonClicks = 0;
 bool mConfigured = false;
 
 
-auto wait4sleep = timer_create_default(); // create a timer with default settings
+TelemetryPublisher telemetry;             /**< Publish the values without heap usage */
+MemoryStats memoryStats;                  /**< Memory headroom of this wake */
+MqttFastPath mqttFastPath;                /**< Publish without the Homie bootstrap */
+ChunkedOta chunkedOta;                    /**< Resumable firmware update */
+PumpControl pumpControl;                  /**< The only one, switching the pumps */
+MoistureCalibration calibration;          /**< Percent lookup tables of the moisture sensors */
+AwakeBudget budget;                       /**< Deadlines of the wake phases */
+TankEstimator tank;                       /**< Water level from the pump runs and one ping per wake */
+HistoryLog history;                       /**< Record of every wake in the flash */
+HistoryServer historyServer;              /**< Download of the history in mode3 */
+DailyStats stats;                         /**< Daily rollup of every wake */
 
 RTC_DATA_ATTR int gBootCount = 0;
+#ifdef CONTROL_TRACE
+RTC_DATA_ATTR uint8_t rtcTrace[TRACE_RTC_SIZE];   /**< DeltaCodec stream, published with the next connection */
+RTC_DATA_ATTR DeltaState_t rtcTraceEncoder = {};
+RTC_DATA_ATTR int rtcTraceUsed = 0;
+RTC_DATA_ATTR long rtcTraceLost = 0;  /**< Traced wakes, that did not fit into rtcTrace */
+TraceRecord_t mTrace;                 /**< Inputs of this wake */
+#endif
 RTC_DATA_ATTR int gCurrentPlant = 0; /**< Value Range: 1 ... 7 (0: no plant needs water) */
 
 RunningMedian lipoRawSensor = RunningMedian(5);
 RunningMedian solarRawSensor = RunningMedian(5);
-RunningMedian waterRawSensor = RunningMedian(5);
 RunningMedian temp1 = RunningMedian(5);
 RunningMedian temp2 = RunningMedian(5);
 
+const char* const BUDGET_PROPERTIES[BUDGET_PHASES] = { "overrunsense", "overrunwifi", "overrunmqtt", "overrunpublish", "overrunwater" };
+const char* const SETTLE_PROPERTIES[SETTLE_CHANNELS] = { "settle0", "settle1", "settle2", "settle3", "settle4", "settle5", "settle6", "settletemp" };
+
+/* acquisition is the producer of both rings, the consumers are the control logic and the telemetry */
+SampleRing<SensorSample_t, SAMPLE_RING_SIZE> controlSamples;
+SampleRing<SensorSample_t, SAMPLE_RING_SIZE> telemetrySamples;
+
 
 Ds18B20 dallas(SENSOR_DS18B20);
 
@@ -98,161 +196,472 @@ void readSystemSensors() {
   
 }
 
-int determineNextPump();
-void setLastActivationForPump(int pumpId, long time);
+uint32_t determineNextPumps();
+bool waitForSensors();
+void stopAcquisition();
+void updateControlValues();
+bool isPublishAllowed();
+bool publishSwitchStates();
 
 
-//FIXME real impl
+/**
+ * @brief Time in seconds
+ * The RTC keeps counting during deep sleep; without SNTP it starts at the first power on.
+ */
 long getCurrentTime(){
-  return 1337;
+  return time(NULL);
 }
 
-//wait till homie flushed mqtt ect.
-bool prepareSleep(void *) {
-  //FIXME wait till pending mqtt is done, then start sleep via event or whatever
-  //Homie.prepareToSleep();
-  return true; // repeat? true there is something in the queue to be done
+/**
+ * @brief Local date as YYYYMMDD, with the time zone of the setting
+ */
+long getLocalDay(){
+  time_t now = time(NULL);
+  struct tm local;
+  localtime_r(&now, &local);
+  return ((local.tm_year + 1900) * 10000L) + ((local.tm_mon + 1) * 100) + local.tm_mday;
 }
 
-void mode2MQTT(){
-   if (deepSleepTime.get()) {
-      Serial << "sleeping for " << deepSleepTime.get() << endl;
-    }
-    /* Publish default values */
+/**
+ * @brief Moisture in the unit of the plant's threshold
+ * @return percent, if the plant uses moistpercent and is calibrated, otherwise the raw ADC value
+ */
+int controlValue(int plant, int adc){
+  if ((rtcPercentControl & (1 << plant)) && calibration.isCalibrated(plant)) {
+    return calibration.getPercent(plant, adc);
+  }
+  return adc;
+}
 
-  if(lastPumpRunning != -1){
-    long waterDiff = mWaterGone-lastWaterValue;
-    //TODO attribute used water in ml to plantid
+/**
+ * @brief Add the values of this wake to the daily statistics
+ * Must be called after updateControlValues()
+ */
+void statsAppend() {
+  uint8_t dryMask = 0;
+  for(int i=0; i < MAX_PLANTS; i++) {
+    int moisture = mPlants[i].getSensorValue();
+    if (moisture <= 0) {
+      continue;
+    }
+    stats.addMoisture(i, calibration.getPercent(i, moisture));
+    long trigger = rtcControl.plants[i].trigger;
+    if (rtcControl.initialized && (trigger != DEACTIVATED_PLANT) && (controlValue(i, moisture) < trigger)) {
+      dryMask |= (1 << i);
+    }
   }
-  sensorWater.setProperty("remaining").send(String(waterLevelMax.get() - mWaterGone ));
-  Serial << "W : " << mWaterGone << " cm (" << String(waterLevelMax.get() - mWaterGone ) << "%)" << endl;
-  lastWaterValue = mWaterGone;
-  
-  if (mWaterGone <= waterLevelMin.get()) {
-      /* let the ESP sleep qickly, as nothing must be done */
-      if ((millis() >= (MIN_TIME_RUNNING * MS_TO_S)) && (deepSleepTime.get() > 0)) {
-        Serial << "No W" << endl;
-        /* in 500 microseconds */
-        wait4sleep.in(500, prepareSleep);
-        return;
-      }
+  stats.addWake(getCurrentTime(), dryMask);
+  if ((mTemperature[TEMP_CHANNEL_AIR] > TEMP_INIT_VALUE) && (mTemperature[TEMP_CHANNEL_AIR] < TEMP_MAX_VALUE)) {
+    stats.addSensor(STATS_TEMP_AIR, lroundf(mTemperature[TEMP_CHANNEL_AIR] * 100));
   }
+  if ((mTemperature[TEMP_CHANNEL_CONTROL] > TEMP_INIT_VALUE) && (mTemperature[TEMP_CHANNEL_CONTROL] < TEMP_MAX_VALUE)) {
+    stats.addSensor(STATS_TEMP_CONTROL, lroundf(mTemperature[TEMP_CHANNEL_CONTROL] * 100));
+  }
+  if (mWaterGone > 0) {
+    stats.addSensor(STATS_WATER, rtcWaterLevelMax - mWaterGone);
+  }
+  if (lipoSenor >= 0) {
+    stats.addSensor(STATS_LIPO, lroundf(ADC_5V_TO_3V3(lipoSenor) * 1000));
+  }
+  if (solarSensor >= 0) {
+    stats.addSensor(STATS_SOLAR, lroundf(SOLAR_VOLT(solarSensor) * 1000));
+  }
+}
 
-  sensorLipo.setProperty("percent").send( String(100 * lipoSenor / 4095) );
-  sensorLipo.setProperty("volt").send( String(ADC_5V_TO_3V3(lipoSenor)) );
-  sensorSolar.setProperty("percent").send(String((100 * solarSensor ) / 4095));
-  sensorSolar.setProperty("volt").send( String(SOLAR_VOLT(solarSensor)) );
-
-  float temp[2] = { TEMP_INIT_VALUE, TEMP_INIT_VALUE };
-  float* pFloat = temp;
-  int devices = dallas.readAllTemperatures(pFloat, 2);
-  if (devices < 2) {
-    if ((pFloat[0] > TEMP_INIT_VALUE) && (pFloat[0] < TEMP_MAX_VALUE) ) {
-      sensorTemp.setProperty("control").send( String(pFloat[0]));
+/**
+ * @brief Publish the summary of the previous day (retained), once
+ */
+void statsPublish() {
+  if (!stats.isSummaryPending() || !isPublishAllowed()) {
+    return;
+  }
+  char line[STATS_LINE_SIZE];
+  size_t length = DailyStats::format(line, sizeof(line), stats.getSummary());
+  if ((length > 0) && (telemetry.publish(systemStats.getId(), "daily", line, length) != 0)) {
+    stats.clearSummary();
   }
-  } else if (devices >= 2) {      
-    if ((pFloat[0] > TEMP_INIT_VALUE) && (pFloat[0] < TEMP_MAX_VALUE) ) {
-      sensorTemp.setProperty("temp").send( String(pFloat[0]));
+}
+
+/**
+ * @brief Stage the record of this wake in the history log
+ * Values, that were not measured in this wake, are marked as unknown.
+ */
+void historyAppend() {
+  updateControlValues();
+  HistoryRecord_t record;
+  historyClear(record);
+  record.time = getCurrentTime() - (millis() / MS_TO_S);
+  for(int i=0; i < MAX_PLANTS; i++) {
+    int moisture = mPlants[i].getSensorValue();
+    if (moisture > 0) {
+      record.moisture[i] = moisture;
     }
-    if ((pFloat[1] > TEMP_INIT_VALUE) && (pFloat[1] < TEMP_MAX_VALUE) ) {
-      sensorTemp.setProperty("control").send( String(pFloat[1]));
+  }
+  for (int i=0; i < 2; i++) {
+    if ((mTemperature[i] > TEMP_INIT_VALUE) && (mTemperature[i] < TEMP_MAX_VALUE)) {
+      record.temperature[i] = mTemperature[i] * 100;
     }
   }
+  if (mWaterGone > 0) {
+    record.water = mWaterGone;
+  }
+  if (lipoSenor >= 0) {
+    record.lipo = lipoSenor;
+  }
+  if (solarSensor >= 0) {
+    record.solar = solarSensor;
+  }
+  record.pumps = mStartedPumps;
+  record.wake = mHistoryWake;
+  unsigned long awake = millis() / 100;
+  record.awake = (awake < 255) ? awake : 255;
+  if (!history.append(record)) {
+    Serial << "history failed" << endl;
+  }
+}
 
-  bool lipoTempWarning = abs(temp[0] - temp[1]) > 5;
-  if(lipoTempWarning){
-    wait4sleep.in(500, prepareSleep);
-    return;
+/**
+ * @brief Configure the timer wake and sleep
+ * Uses the copies of the settings in the RTC memory, as most wakes do not start Homie.
+ * A running pump is switched off first.
+ */
+void enterDeepSleep() {
+  pumpControl.stopAll();
+  unsigned long stopRequested = millis();
+  while (pumpControl.isActive() && ((millis() - stopRequested) < PUMP_STOP_TIMEOUT)) {
+    delay(1);
+  }
+  /* the acquisition task must not touch the estimator, while the pumped water is added */
+  stopAcquisition();
+  if (publishSwitchStates()) {
+    /* no retained ON must stay on the broker, until the next Homie wake */
+    delay(SWITCH_SEND_TIME);
+  }
+  if (mConfigured) {
+    /* the estimator predicts the level of the next wake with the pumped water */
+    long pumped = 0;
+    for(int i=0; i < MAX_PLANTS; i++) {
+      long water = ((long) pumpControl.getRunTime(i) * pumpFlow.get()) / 60000;
+      stats.addPump(i, pumpControl.getRunTime(i), water);
+      pumped += water;
+    }
+    tank.addPumped(pumped, waterLevelMin.get(), waterLevelMax.get(), waterLevelVol.get());
   }
+  historyAppend();
+  statsAppend();
+
+  long sleepTime = (rtcControl.deepSleepTime > 0) ? rtcControl.deepSleepTime : DEFAULT_SLEEP_TIME;
+  if ((mStartedPumps != 0) && (rtcPumpSleepTime > 0)) {
+    /* measure again, when the water reached the sensor */
+    sleepTime = rtcPumpSleepTime;
+  } else if ((rtcNightSleepTime > 0) && (solarSensor >= 0) && (SOLAR_VOLT(solarSensor) < MINIMUM_SOLAR_VOLT)) {
+    sleepTime = rtcNightSleepTime;
+  }
+  if ((lipoSenor >= 0) && (ADC_5V_TO_3V3(lipoSenor) < MINIMUM_LIPO_VOLT) && (ADC_5V_TO_3V3(lipoSenor) > NO_LIPO_VOLT)) {
+    sleepTime *= EMPTY_LIPO_MULTIPL;
+  }
+  Serial << sleepTime << " ms ds" << endl;
+  Serial.flush();
+  esp_sleep_enable_timer_wakeup(sleepTime * 1000ULL);
+  esp_deep_sleep_start();
+}
 
-  digitalWrite(OUTPUT_PUMP, LOW);
+/**
+ * @brief Publish the switch of each pump, whose state changed since it was published
+ * The pump task stops the pumps on its own (runtime, deadline), so this is polled.
+ * Retained, so only a change is sent.
+ * @return true, if a state was sent
+ */
+bool publishSwitchStates() {
+  bool sent = false;
+  if (!telemetry.isReady()) {
+    return false;
+  }
   for(int i=0; i < MAX_PLANTS; i++) {
-    digitalWrite(mPlants[i].mPinPump, LOW); 
+    if (telemetry.publishStateChanged((TelemetryProperty_t) (TELEMETRY_SWITCH + i), mPlants[i].getNodeId(), "switch",
+                                      pumpControl.isRunning(i), "ON", "OFF") != 0) {
+      sent = true;
+    }
   }
+  return sent;
+}
 
-  lastPumpRunning = determineNextPump();
-  if(lastPumpRunning != -1){
-    setLastActivationForPump(lastPumpRunning, getCurrentTime());
-    digitalWrite(mPlants[lastPumpRunning].mPinPump, HIGH);  
+/**
+ * @brief The publish phase has time left
+ * Values after the deadline are dropped, the pump decision does not depend on them.
+ */
+bool isPublishAllowed() {
+  return !((budget.getPhase() == BUDGET_PUBLISH) && budget.isOverrun(millis()));
+}
+
+/**
+ * @brief Add a sample for the control logic and the telemetry
+ * Must only be called by one task at a time (the rings have a single producer).
+ */
+void pushSample(SampleType_t type, uint8_t channel, float value) {
+  SensorSample_t sample = { (uint32_t) millis(), (uint8_t) type, channel, value };
+  controlSamples.push(sample);
+  telemetrySamples.push(sample);
+}
+
+/**
+ * @brief Take over all samples, the control logic needs
+ */
+void updateControlValues() {
+  SensorSample_t sample;
+  while (controlSamples.pop(sample)) {
+    switch (sample.type) {
+      case SAMPLE_TEMPERATURE:
+        if (sample.channel < 2) {
+          mTemperature[sample.channel] = sample.value;
+        }
+        break;
+      case SAMPLE_WATER:
+        mWaterGone = sample.value;
+        break;
+      case SAMPLE_LIPO:
+        lipoSenor = sample.value;
+        break;
+      case SAMPLE_SOLAR:
+        solarSensor = sample.value;
+        break;
+      case SAMPLE_ECHO:
+        mEchoDuration = sample.value;
+        break;
+      default:
+        /* moisture is already stored in the plants */
+        break;
+    }
   }
 }
 
-void setMoistureTrigger(int plantId, long value){
-  if(plantId == 0){
-    rtcMoistureTrigger0 = value;
+/**
+ * @brief Publish the values of one sample
+ * Used by Homie, by the fast path and by its probe, so only the telemetry publisher must be used here.
+ */
+void publishSample(const SensorSample_t& sample) {
+  long raw = sample.value;
+  switch (sample.type) {
+    case SAMPLE_MOISTURE:
+      if (sample.channel < MAX_PLANTS) {
+        telemetry.publishChanged((TelemetryProperty_t) (TELEMETRY_MOIST + sample.channel), mPlants[sample.channel].getNodeId(),
+                                 "moist", calibration.getPercent(sample.channel, raw));
+      }
+      break;
+    case SAMPLE_TEMPERATURE:
+      if ((sample.value > TEMP_INIT_VALUE) && (sample.value < TEMP_MAX_VALUE) ) {
+        bool control = (sample.channel == TEMP_CHANNEL_CONTROL);
+        telemetry.publishChanged(control ? TELEMETRY_TEMP_CONTROL : TELEMETRY_TEMP, sensorTemp.getId(),
+                                 control ? "control" : "temp", lroundf(sample.value * 100), 2);
+      }
+      break;
+    case SAMPLE_WATER:
+      telemetry.publishChanged(TELEMETRY_WATER_REMAINING, sensorWater.getId(), "remaining", rtcWaterLevelMax - raw);
+      if (tank.isValid() && (rtcWaterVolume > 0)) {
+        long fill = TankEstimator::getFill(raw, rtcWaterLevelMin, rtcWaterLevelMax);
+        bool warning = (fill <= TankEstimator::getFill(rtcWaterLevelWarn, rtcWaterLevelMin, rtcWaterLevelMax));
+        telemetry.publishChanged(TELEMETRY_WATER_VOLUME, sensorWater.getId(), "volume", (fill * rtcWaterVolume) / TANK_FILL_SCALE);
+        telemetry.publishStateChanged(TELEMETRY_WATER_WARNING, sensorWater.getId(), "warning", warning, "true", "false");
+      }
+      Serial << "W : " << raw << " mm (" << (rtcWaterLevelMax - raw) << ") +-" << tank.getDeviation() << endl;
+      break;
+    case SAMPLE_LIPO:
+      telemetry.publishChanged(TELEMETRY_LIPO_PERCENT, sensorLipo.getId(), "percent", 100 * raw / 4095);
+      telemetry.publishChanged(TELEMETRY_LIPO_VOLT, sensorLipo.getId(), "volt", lroundf(ADC_5V_TO_3V3(raw) * 100), 2);
+      break;
+    case SAMPLE_SOLAR:
+      telemetry.publishChanged(TELEMETRY_SOLAR_PERCENT, sensorSolar.getId(), "percent", (100 * raw) / 4095);
+      telemetry.publishChanged(TELEMETRY_SOLAR_VOLT, sensorSolar.getId(), "volt", lroundf(SOLAR_VOLT(raw) * 100), 2);
+      break;
+    case SAMPLE_SETTLE:
+      if (sample.channel < SETTLE_CHANNELS) {
+        telemetry.publishLong(systemStats.getId(), SETTLE_PROPERTIES[sample.channel], raw);
+      }
+      break;
+    default:
+      break;
   }
-  if(plantId == 1){
-    rtcMoistureTrigger1 = value;
+}
+
+/**
+ * @brief Publish all sensor values
+ */
+void publishSensorValues() {
+  /* wake to publish latency, to compare the fast path with Homie */
+  telemetry.publishLong(systemStats.getId(), mFastPathActive ? "latencyfast" : "latencyhomie", millis());
+
+  if (!waitForSensors()) {
+    Serial << "sensor timeout" << endl;
   }
-    if(plantId == 2){
-    rtcMoistureTrigger2 = value;
+
+  SensorSample_t sample;
+  while (telemetrySamples.pop(sample)) {
+    /* the remaining samples are dropped after the deadline */
+    if (isPublishAllowed()) {
+      publishSample(sample);
+    }
   }
-    if(plantId == 3){
-    rtcMoistureTrigger3 = value;
+  if (telemetrySamples.getDropped() > 0) {
+    Serial << "dropped samples " << telemetrySamples.getDropped() << endl;
   }
-    if(plantId == 4){
-    rtcMoistureTrigger4 = value;
+  Serial << "unchanged " << telemetry.getSuppressedCount() << endl;
+  statsPublish();
+}
+
+/**
+ * @brief Start the trace record of this wake (build flag CONTROL_TRACE)
+ */
+void traceWake(const int moisture[MAX_PLANTS]) {
+#ifdef CONTROL_TRACE
+  traceClear(mTrace);
+  mTrace.time = getCurrentTime();
+  mTrace.boot = gBootCount;
+  for(int i=0; i < MAX_PLANTS; i++) {
+    mTrace.moisture[i] = moisture[i];
   }
-    if(plantId == 5){
-    rtcMoistureTrigger5 = value;
+#endif
+}
+
+/**
+ * @brief Keep the trace record of this wake, until the next publish
+ */
+void traceStage() {
+#ifdef CONTROL_TRACE
+  int32_t values[TRACE_CHANNELS];
+  traceToChannels(mTrace, values);
+  size_t length = deltaEncode(rtcTraceEncoder, TRACE_CHANNELS, mTrace.time, values,
+                              rtcTrace + rtcTraceUsed, TRACE_RTC_SIZE - rtcTraceUsed);
+  if (length > 0) {
+    rtcTraceUsed += length;
+  } else {
+    rtcTraceLost++;
   }
-  if(plantId == 6){
-    rtcMoistureTrigger6 = value;
-  } 
+#endif
 }
 
-void setLastActivationForPump(int plantId, long value){
-  if(plantId == 0){
-    rtcLastActive0 = value;
+/**
+ * @brief Publish all staged trace records and the one of this wake
+ * Must be called after updateControlValues()
+ */
+void tracePublish() {
+#ifdef CONTROL_TRACE
+  if (lipoSenor >= 0) {
+    mTrace.lipo = lipoSenor;
   }
-  if(plantId == 1){
-    rtcLastActive1 = value;
+  if (solarSensor >= 0) {
+    mTrace.solar = solarSensor;
   }
-    if(plantId == 2){
-    rtcLastActive2 = value;
+  for (int i=0; i < 2; i++) {
+    if ((mTemperature[i] > TEMP_INIT_VALUE) && (mTemperature[i] < TEMP_MAX_VALUE)) {
+      mTrace.temperature[i] = mTemperature[i] * 100;
+    }
   }
-    if(plantId == 3){
-    rtcLastActive3 = value;
+  if (mEchoDuration >= 0) {
+    mTrace.echo = mEchoDuration;
   }
-    if(plantId == 4){
-    rtcLastActive4 = value;
+  traceStage();
+
+  /* all staged wakes in one message */
+  uint8_t batch[1 + DELTA_VARINT_SIZE + TRACE_RTC_SIZE];
+  size_t length = 0;
+  batch[length++] = TRACE_BATCH_MAGIC;
+  length += deltaPutVarint(batch + length, sizeof(batch) - length, rtcTraceUsed);
+  memcpy(batch + length, rtcTrace, rtcTraceUsed);
+  length += rtcTraceUsed;
+  if (telemetry.publish(systemStats.getId(), "tracebatch", (const char*) batch, length, false) != 0) {
+    rtcTraceUsed = 0;
+    deltaReset(rtcTraceEncoder);
   }
-    if(plantId == 5){
-    rtcLastActive5 = value;
+  if (rtcTraceLost > 0) {
+    telemetry.publishLong(systemStats.getId(), "tracelost", rtcTraceLost, false);
+    rtcTraceLost = 0;
   }
-  if(plantId == 6){
-    rtcLastActive6 = value;
-  } 
+#endif
 }
 
-long getLastActivationForPump(int plantId){
-  if(plantId == 0){
-    return rtcLastActive0;
-  }
-  if(plantId == 1){
-    return rtcLastActive1;
+void mode2MQTT(){
+   if (deepSleepTime.get()) {
+      Serial << "sleeping for " << deepSleepTime.get() << endl;
+    }
+    /* Publish default values */
+
+  if(lastPumpRunning != -1){
+    long waterDiff = mWaterGone-lastWaterValue;
+    //TODO attribute used water in ml to plantid
   }
-  if(plantId == 2){
-    return rtcLastActive2;
+  publishSensorValues();
+  updateControlValues();
+  tracePublish();
+  lastWaterValue = mWaterGone;
+  
+  if (TankEstimator::getFill(mWaterGone, waterLevelMin.get(), waterLevelMax.get()) == 0) {
+      /* nothing must be done, the budget lets the ESP sleep */
+      Serial << "No W" << endl;
+      return;
   }
-  if(plantId == 3){
-    return rtcLastActive3;
+
+  bool lipoTempWarning = (mTemperature[TEMP_CHANNEL_AIR] > TEMP_INIT_VALUE) &&
+                         (mTemperature[TEMP_CHANNEL_CONTROL] > TEMP_INIT_VALUE) &&
+                         (abs(mTemperature[TEMP_CHANNEL_AIR] - mTemperature[TEMP_CHANNEL_CONTROL]) > 5);
+  if(lipoTempWarning){
+    return;
   }
-  if(plantId == 4){
-    return rtcLastActive4;
+
+  pumpControl.stopAll();
+
+  uint32_t pumps = determineNextPumps();
+  lastPumpRunning = -1;
+  long waterTime = BUDGET_WATER_MARGIN;
+  for(int i=0; i < MAX_PLANTS; i++) {
+    if (pumps & (1UL << i)) {
+      /* the pump task runs as many as the current budget allows, the others wait */
+      pumpControl.start(i);
+      mStartedPumps |= (1 << i);
+      telemetry.publishStateChanged((TelemetryProperty_t) (TELEMETRY_SWITCH + i), mPlants[i].getNodeId(), "switch",
+                                    true, "ON", "OFF");
+      waterTime += mPlants[i].getSettingMaxRuntime();
+      if (lastPumpRunning == -1) {
+        lastPumpRunning = i;
+      }
+    }
   }
-  if(plantId == 5){
-    return rtcLastActive5;
+  if (pumps != 0) {
+    if (budget.getDeadline(BUDGET_WATER) == 0) {
+      /* in the worst case all pumps run one after the other */
+      budget.setDeadline(BUDGET_WATER, waterTime);
+    }
   }
-  if(plantId == 6){
-    return rtcLastActive6;
+}
+
+/**
+ * @brief Publish the memory headroom of this wake
+ */
+void publishMemoryStats() {
+  memoryStats.sample();
+  telemetry.publishLong(systemStats.getId(), "minheap", memoryStats.getMinFreeHeap());
+  telemetry.publishLong(systemStats.getId(), "maxblock", memoryStats.getLargestFreeBlock());
+  telemetry.publishLong(systemStats.getId(), "stackloop", memoryStats.getStackLoop());
+  telemetry.publishLong(systemStats.getId(), "stackwifi", memoryStats.getStackWifi());
+  telemetry.publishLong(systemStats.getId(), "stackmqtt", memoryStats.getStackMqtt());
+  telemetry.publishLong(systemStats.getId(), "rtcused", MemoryStats::getRtcUsage());
+}
+
+/**
+ * @brief Publish the overruns of the phases since the last publish
+ */
+void publishBudgetStats() {
+  for (int i = 0; i < BUDGET_PHASES; i++) {
+    if ((rtcOverruns[i] > 0) && isPublishAllowed()) {
+      telemetry.publishLong(systemStats.getId(), BUDGET_PROPERTIES[i], rtcOverruns[i], false);
+      rtcOverruns[i] = 0;
+    }
   }
-  return -1;
 }
 
 /**
  * @brief Sensors, that are connected to GPIOs, mandatory for WIFI.
  * These sensors (ADC2) can only be read when no Wifi is used.
+ * The sensors stay powered for the readings in the acquisition task.
  */
 void readSensors() {
   Serial << "rs" << endl;
@@ -261,109 +670,354 @@ void readSensors() {
   pinMode(OUTPUT_SENSOR, OUTPUT);
   digitalWrite(OUTPUT_SENSOR, HIGH);
 
-  delay(100);
-  /* wait before reading something */
+  /* wait, until every channel delivers stable values */
+  SensorSettle settle[MAX_PLANTS];
+  uint32_t powerOn = millis();
+  for(int i=0; i < MAX_PLANTS; i++) {
+    settle[i].begin(powerOn, rtcSettleTime[i], SETTLE_MOISTURE_MAX, SETTLE_MOISTURE_TOLERANCE);
+  }
+  bool settled = false;
+  while (!settled) {
+    delay(SETTLE_MOISTURE_INTERVAL);
+    settled = true;
+    uint32_t now = millis();
+    for(int i=0; i < MAX_PLANTS; i++) {
+      if (!settle[i].isDone()) {
+        settled &= settle[i].add(now, analogRead(mPlants[i].getSensorPin()));
+      }
+    }
+  }
+  for(int i=0; i < MAX_PLANTS; i++) {
+    rtcSettleTime[i] = settle[i].learn(rtcSettleTime[i]);
+    pushSample(SAMPLE_SETTLE, i, settle[i].getSettleTime());
+  }
+
   for (int readCnt=0;readCnt < AMOUNT_SENOR_QUERYS; readCnt++) {
     for(int i=0; i < MAX_PLANTS; i++) {
       mPlants[i].addSenseValue(analogRead(mPlants[i].getSensorPin()));
     }
   }
+  /* mode1 needs the values to decide about the next mode */
+  for(int i=0; i < MAX_PLANTS; i++) {
+    mPlants[i].calculateSensorValue(AMOUNT_SENOR_QUERYS);
+    pushSample(SAMPLE_MOISTURE, i, mPlants[i].getSensorValue());
+  }
+}
 
-  Serial << "DS18B20" << endl;
-  /* Read the temperature sensors once, as first time 85 degree is returned */
-  Serial << "DS18B20" << String(dallas.readDevices()) << endl;
-  delay(200);
+/**
+ * @brief A stage of the acquisition task is finished
+ * The sensors are switched off, as soon as no stage needs them any more.
+ */
+void finishStage(uint32_t stage) {
+  mPendingStages &= ~stage;
+  if ((mPendingStages & STAGES_POWERED) == 0) {
+    digitalWrite(OUTPUT_SENSOR, LOW);
+  }
+}
 
+/**
+ * @brief Start the DS18B20 conversion, the result is polled by temperatureStage()
+ */
+void startTemperature() {
+  Serial << "DS18B20" << dallas.readDevices() << endl;
+  mTempSettle.begin(millis(), rtcSettleTime[SETTLE_CHANNEL_TEMP], SETTLE_TEMP_MAX, SETTLE_TEMP_TOLERANCE);
+  /* the sensors start with 12 bit (750 ms) after each power on */
+  dallas.setResolution(TEMP_RESOLUTION);
+  dallas.startConversion();
+  mTempConversionStart = millis();
+}
 
-  /* Required to read the temperature once */
-  float temp[2] = {0, 0};
-  float* pFloat = temp;
-  // first read returns crap, ignore result and read twice
-  if (dallas.readAllTemperatures(pFloat, 2) > 0) {
-      Serial << "t1: " << String(temp[0]) << endl;
-      Serial << "t2: " << String(temp[1]) << endl;
+/**
+ * @brief Stage: read the DS18B20, until the values are stable
+ * @return true, if the stage must be called again
+ */
+bool temperatureStage(void *) {
+  /* the scratchpad holds the previous result, until the conversion is finished */
+  if (!dallas.isConversionDone() && ((millis() - mTempConversionStart) < DS18B20_CONVERSION_TIME(TEMP_RESOLUTION))) {
+    return true;
   }
-  delay(200);
-  if (dallas.readAllTemperatures(pFloat, 2) > 0) {
-      Serial << "t1: " << String(temp[0]) << endl;
-      Serial << "t2: " << String(temp[1]) << endl;
+  float temp[2] = {0, 0};
+  int devices = dallas.readTemperatures(temp, 2);
+  /* A reading before the first conversion returns the power on value (85 degree); the sum is only stable, if both sensors are */
+  if ((devices > 0) &&
+      !mTempSettle.add(millis(), temp[0] + temp[1], (temp[0] < TEMP_MAX_VALUE) && (temp[1] < TEMP_MAX_VALUE))) {
+    dallas.startConversion();
+    mTempConversionStart = millis();
+    return true;
   }
 
+  if (devices > 0) {
+      Serial << "t1: " << temp[0] << endl;
+      Serial << "t2: " << temp[1] << endl;
+      rtcSettleTime[SETTLE_CHANNEL_TEMP] = mTempSettle.learn(rtcSettleTime[SETTLE_CHANNEL_TEMP]);
+      pushSample(SAMPLE_SETTLE, SETTLE_CHANNEL_TEMP, mTempSettle.getSettleTime());
+  }
   temp1.add(temp[0]);
   temp2.add(temp[1]);
+  if (devices >= 2) {
+    pushSample(SAMPLE_TEMPERATURE, TEMP_CHANNEL_AIR, temp1.getMedian());
+    pushSample(SAMPLE_TEMPERATURE, TEMP_CHANNEL_CONTROL, temp2.getMedian());
+  } else if (devices == 1) {
+    /* a single sensor is next to the controller */
+    pushSample(SAMPLE_TEMPERATURE, TEMP_CHANNEL_CONTROL, temp1.getMedian());
+  }
+  finishStage(STAGE_TEMPERATURE);
+  return false;
+}
+
+/**
+ * @brief Both edges of the echo pulse, replaces the blocking pulseIn()
+ */
+void IRAM_ATTR echoInterrupt() {
+  if (digitalRead(SENSOR_SR04_ECHO) == HIGH) {
+    mEchoRise = micros();
+  } else if (mEchoRise != 0) {
+    mEchoFall = micros();
+    mEchoReceived = true;
+  }
+}
+
+/**
+ * @brief Trigger the ultrasonic sensor, the echo is polled by echoStage()
+ */
+void startEcho() {
+  pinMode(SENSOR_SR04_TRIG, OUTPUT);
+  pinMode(SENSOR_SR04_ECHO, INPUT);
+  mEchoRise = 0;
+  mEchoReceived = false;
+  attachInterrupt(digitalPinToInterrupt(SENSOR_SR04_ECHO), echoInterrupt, CHANGE);
 
-  /* Use the Ultrasonic sensor to measure waterLevel */
- 
   digitalWrite(SENSOR_SR04_TRIG, LOW);
   delayMicroseconds(2);
   digitalWrite(SENSOR_SR04_TRIG, HIGH);
   delayMicroseconds(10);
   digitalWrite(SENSOR_SR04_TRIG, LOW);
-  float duration = pulseIn(SENSOR_SR04_ECHO, HIGH);
-  waterRawSensor.add((duration*.343)/2);
-  /* deactivate the sensors */
-  digitalWrite(OUTPUT_SENSOR, LOW);
+  mEchoTriggered = millis();
+}
+
+/**
+ * @brief Stage: wait for the echo of the ultrasonic sensor, to measure the water level
+ * @return true, if the stage must be called again
+ */
+bool echoStage(void *) {
+  if (!mEchoReceived && ((millis() - mEchoTriggered) < ECHO_TIMEOUT)) {
+    return true;
+  }
+  detachInterrupt(digitalPinToInterrupt(SENSOR_SR04_ECHO));
+  /* no echo is handled like pulseIn() did: 0 */
+  float duration = mEchoReceived ? (float) (mEchoFall - mEchoRise) : 0;
+  /* one ping per wake, the estimator predicts the level between the pings */
+  tank.update((long) ((duration*.343)/2));
+  pushSample(SAMPLE_ECHO, 0, duration);
+  /* an unknown level is handled like a missing echo: no water */
+  pushSample(SAMPLE_WATER, 0, tank.isValid() ? tank.getLevel() : 0);
+  finishStage(STAGE_ECHO);
+  return false;
+}
+
+/**
+ * @brief Stage: lipo and solar (ADC1), nothing to wait for
+ */
+bool systemStage(void *) {
+  for (int i=0; i < AMOUNT_SYSTEM_QUERYS; i++) {
+    readSystemSensors();
+  }
+  pushSample(SAMPLE_LIPO, 0, lipoRawSensor.getMedian());
+  pushSample(SAMPLE_SOLAR, 0, solarRawSensor.getMedian());
+  finishStage(STAGE_SYSTEM);
+  return false;
 }
 
+/**
+ * @brief Sensors, that can be read while WiFi is used
+ * Temperature (OneWire), water level (ultrasonic), lipo and solar (ADC1)
+ * Every sensor is a stage, that is polled by the scheduler, instead of waiting for it;
+ * so the acquisition takes as long as the slowest sensor. Between the stages the task
+ * sleeps, until the next one is due.
+ */
+void acquisitionTask(void *) {
+  mPendingStages = STAGE_TEMPERATURE | STAGE_ECHO | STAGE_SYSTEM;
+  startTemperature();
+  startEcho();
+  acquisitionStages.every(SETTLE_TEMP_INTERVAL, temperatureStage);
+  acquisitionStages.every(ECHO_POLL_INTERVAL, echoStage);
+  acquisitionStages.in(0, systemStage);
+
+  while ((mPendingStages != 0) && !mStopAcquisition) {
+    unsigned long wait = acquisitionStages.tick();
+    if ((wait > 0) && !mStopAcquisition) {
+      delay(wait);
+    }
+  }
 
+  if (mPendingStages == 0) {
+    xEventGroupSetBits(mSensorEvents, SENSORS_READY);
+  }
+  xEventGroupSetBits(mSensorEvents, ACQUISITION_DONE);
+  if (xTaskGetCurrentTaskHandle() == mAcquisitionTask) {
+    vTaskDelete(NULL);
+  }
+}
+
+/**
+ * @brief Read the remaining sensors on the second core
+ * Meanwhile WiFi and MQTT connect on the first core.
+ */
+void startAcquisition() {
+  mSensorEvents = xEventGroupCreate();
+  if (xTaskCreatePinnedToCore(acquisitionTask, "acquisition", ACQUISITION_STACK, NULL, 1, &mAcquisitionTask, ACQUISITION_CORE) != pdPASS) {
+    mAcquisitionTask = NULL;
+    /* no parallel reading possible */
+    acquisitionTask(NULL);
+  }
+}
 
+/**
+ * @brief Wait, until the acquisition task has read all sensors
+ * @return true, if all values are available
+ */
+bool waitForSensors() {
+  if (mSensorEvents == NULL) {
+    return false;
+  }
+  /* the deadline of the sensing is counted from the wake */
+  uint32_t deadline = budget.getDeadline(BUDGET_SENSE);
+  uint32_t now = millis();
+  uint32_t timeout = (now < deadline) ? (deadline - now) : 0;
+  EventBits_t bits = xEventGroupWaitBits(mSensorEvents, SENSORS_READY, pdFALSE, pdTRUE, pdMS_TO_TICKS(timeout));
+  if ((bits & SENSORS_READY) == 0) {
+    budget.countOverrun(BUDGET_SENSE);
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief End the acquisition task before sleeping
+ * The running stage is finished, the remaining stages deliver no sample.
+ * A task, that does not end in time, is deleted.
+ */
+void stopAcquisition() {
+  if (mSensorEvents == NULL) {
+    return;
+  }
+  mStopAcquisition = true;
+  EventBits_t bits = xEventGroupWaitBits(mSensorEvents, ACQUISITION_DONE, pdFALSE, pdTRUE, pdMS_TO_TICKS(ACQUISITION_STOP_TIMEOUT));
+  if (((bits & ACQUISITION_DONE) == 0) && (mAcquisitionTask != NULL)) {
+    vTaskDelete(mAcquisitionTask);
+  }
+  mAcquisitionTask = NULL;
+  if ((mPendingStages & STAGE_ECHO) != 0) {
+    detachInterrupt(digitalPinToInterrupt(SENSOR_SR04_ECHO));
+  }
+  if (mPendingStages != 0) {
+    Serial << "stages dropped " << mPendingStages << endl;
+    mPendingStages = 0;
+    digitalWrite(OUTPUT_SENSOR, LOW);
+  }
+}
 
 //Homie.getMqttClient().disconnect();
 
 void onHomieEvent(const HomieEvent& event) {
-  const String OFF = String("OFF");
   switch(event.type) {
+    case HomieEventType::WIFI_CONNECTED:
+      budget.enter(BUDGET_MQTT, millis());
+      if (mode3Active && mConfigured) {
+        historyServer.begin(&history);
+      }
+      break;
     case HomieEventType::MQTT_READY:
-      plant0.setProperty("switch").send(OFF);            
-      plant1.setProperty("switch").send(OFF);            
-      plant2.setProperty("switch").send(OFF);
-      plant3.setProperty("switch").send(OFF);            
-      plant4.setProperty("switch").send(OFF);
-      plant5.setProperty("switch").send(OFF);
-      plant6.setProperty("switch").send(OFF);
+      budget.enter(BUDGET_PUBLISH, millis());
+      telemetry.begin(&Homie.getMqttClient(), Homie.getConfiguration().mqtt.baseTopic,
+                      Homie.getConfiguration().deviceId);
+      chunkedOta.begin(&Homie.getMqttClient(), Homie.getConfiguration().mqtt.baseTopic,
+                      Homie.getConfiguration().deviceId);
+      publishSwitchStates();
 
       //wait for rtc sync?
-      rtcDeepSleepTime = deepSleepTime.get();
+      rtcControl.deepSleepTime = deepSleepTime.get();
+      rtcWaterLevelMax = waterLevelMax.get();
+      rtcWaterLevelMin = waterLevelMin.get();
+      rtcWaterLevelWarn = waterLevelWarn.get();
+      rtcWaterVolume = waterLevelVol.get();
+      rtcNightSleepTime = deepSleepNightTime.get();
+      rtcPumpSleepTime = wateringDeepSleep.get();
+      AwakeBudget::parse(awakeBudget.get(), rtcBudgetDeadline);
+      telemetryParseDeadbands(telemetryDeadband.get(), rtcTelemetry.deadband);
+      rtcTelemetry.maxSilence = telemetrySilence.get();
+      strncpy(rtcTimeZone, timeZone.get(), sizeof(rtcTimeZone) - 1);
+      if (strlen(ntpServer.get()) > 0) {
+        /* the RTC keeps the synchronized time during the deep sleep */
+        configTzTime(rtcTimeZone, ntpServer.get());
+      }
+      mqttFastPath.store(Homie.getConfiguration(), homieWakes.get());
+      memoryStats.sample();
       if(!mode3Active){
         mode2MQTT();
       }
+      publishMemoryStats();
+      publishBudgetStats();
+      /* the pump run is finished in any case, the publishing may be cut */
+      budget.enter(pumpControl.isActive() ? BUDGET_WATER : BUDGET_DONE, millis());
       Homie.getLogger() << "MQTT 1" << endl;
       break;
     case HomieEventType::READY_TO_SLEEP:
       Homie.getLogger() << "rtsleep" << endl;
-      esp_deep_sleep_start();
+      enterDeepSleep();
+      break;
+    case HomieEventType::OTA_STARTED:
+    case HomieEventType::OTA_PROGRESS:
+      /* the image is received over MQTT, the controller must not sleep until it is written */
+      mHomieOtaActivity = max(millis(), 1UL);
+      break;
+    case HomieEventType::OTA_FAILED:
+      Homie.getLogger() << "ota failed" << endl;
+      mHomieOtaActivity = 0;
+      break;
+    case HomieEventType::OTA_SUCCESSFUL:
+      /* Homie restarts the controller */
+      break;
+    default:
       break;
   }
 }
 
-int determineNextPump(){
-  float solarValue = solarRawSensor.getMedian();
-  bool isLowLight =(ADC_5V_TO_3V3(solarValue) > SOLAR_CHARGE_MIN_VOLTAGE || ADC_5V_TO_3V3(solarValue)  < SOLAR_CHARGE_MAX_VOLTAGE);
-
-  
-
+/**
+ * @brief Check, if a Homie OTA is running
+ * An update without progress is given up, so the budget can send the controller to sleep.
+ */
+bool isHomieOtaActive() {
+  if ((mHomieOtaActivity != 0) && ((millis() - mHomieOtaActivity) > HOMIE_OTA_TIMEOUT)) {
+    Serial << "ota stalled" << endl;
+    mHomieOtaActivity = 0;
+  }
+  return (mHomieOtaActivity != 0);
+}
 
-  //FIXME instead of for, use sorted by last activation index to ensure equal runtime?
+uint32_t determineNextPumps(){
+  PlantControl_t plants[MAX_PLANTS];
+  int moisture[MAX_PLANTS];
   for(int i=0; i < MAX_PLANTS; i++) {
-    mPlants[i].calculateSensorValue(AMOUNT_SENOR_QUERYS);
-    mPlants[i].setProperty("moist").send(String(100 * mPlants[i].getSensorValue() / 4095 ));
-    long lastActivation = getLastActivationForPump(i);
-    long sinceLastActivation = getCurrentTime()-lastActivation;
-    //this pump is in cooldown skip it and disable low power mode trigger for it
-    if(mPlants[i].mSetting->pPumpCooldownInHours->get() > sinceLastActivation / 3600 / 1000){
-      setMoistureTrigger(i, DEACTIVATED_PLANT);
-      continue;
-    }
-    //skip as it is not low light
-    if(!isLowLight && mPlants[i].mSetting->pPumpOnlyWhenLowLight->get()){
-      continue;
-    }
-
-    if(mPlants->isPumpRequired()){
-      return i;
+    /* the unit of the threshold never changes by capturing a calibration, only by setting moistpercent */
+    long percent = mPlants[i].getSettingSensorDryPercent();
+    if (calibration.isCalibrated(i) && (percent != MOIST_PERCENT_UNUSED)) {
+      rtcPercentControl |= (1 << i);
+      plants[i].sensorDry = percent;
+    } else {
+      rtcPercentControl &= ~(1 << i);
+      plants[i].sensorDry = mPlants[i].getSettingSensorDry();
     }
+    plants[i].sensorExit = controlExitThreshold(plants[i].sensorDry);
+    plants[i].cooldown = mPlants[i].mSetting->pPumpCooldownInHours->get();
+    plants[i].runtime = mPlants[i].getSettingMaxRuntime() / 1000;
+    /* pumpdeepsleep: after a pump run, the moisture is used again, when the water reached the sensor */
+    plants[i].soakTime = wateringDeepSleep.get() / 1000;
+    plants[i].onlyWhenLowLight = mPlants[i].mSetting->pPumpOnlyWhenLowLight->get();
+    moisture[i] = controlValue(i, mPlants[i].getSensorValue());
   }
-  return -1;
+  return controlSelectPumps(rtcControl, plants, moisture, solarSensor, getCurrentTime(),
+                            controlPumpLimit(pumpCurrentBudget.get()));
 }
 
 
@@ -377,9 +1031,9 @@ bool switchGeneralPumpHandler(const int pump, const HomieRange& range, const Str
 #if MAX_PLANTS >= 2
   case 1:
 #endif
-  #if MAX_PLANTS >= 3
-#endif
+#if MAX_PLANTS >= 3
   case 2:
+#endif
 #if MAX_PLANTS >= 4
   case 3:
 #endif
@@ -389,12 +1043,20 @@ bool switchGeneralPumpHandler(const int pump, const HomieRange& range, const Str
 #if MAX_PLANTS >= 6
   case 5:
 #endif
+#if MAX_PLANTS >= 7
+  case 6:
+#endif
 
+    /* the pump task switches off after the maximum runtime of the plant */
     if ((value.equals("ON")) || (value.equals("On")) || (value.equals("on")) || (value.equals("true"))) {
-      digitalWrite(mPlants[pump].getPumpPin(), HIGH);
+      pumpControl.start(pump);
+      telemetry.publishStateChanged((TelemetryProperty_t) (TELEMETRY_SWITCH + pump), mPlants[pump].getNodeId(), "switch",
+                                    true, "ON", "OFF");
       return true;
     } else if ((value.equals("OFF")) || (value.equals("Off")) || (value.equals("off")) || (value.equals("false")) ) {
-      digitalWrite(mPlants[pump].getPumpPin(), LOW);
+      pumpControl.stop(pump);
+      telemetry.publishStateChanged((TelemetryProperty_t) (TELEMETRY_SWITCH + pump), mPlants[pump].getNodeId(), "switch",
+                                    false, "ON", "OFF");
       return true;
     } else {
       return false;
@@ -405,6 +1067,75 @@ bool switchGeneralPumpHandler(const int pump, const HomieRange& range, const Str
   }
 }
 
+/**
+ * @brief Build the percent lookup tables
+ * The calibration points are read from the NVS only once after power on.
+ */
+void loadCalibration() {
+  if (!rtcCalibrationLoaded) {
+    for(int i=0; i < MAX_PLANTS; i++) {
+      calibrationClear(rtcCalibration[i]);
+    }
+    Preferences preferences;
+    if (preferences.begin(CALIBRATION_NAMESPACE, true)) {
+      if (preferences.getBytesLength(CALIBRATION_KEY) == sizeof(rtcCalibration)) {
+        preferences.getBytes(CALIBRATION_KEY, rtcCalibration, sizeof(rtcCalibration));
+      }
+      preferences.end();
+    }
+    rtcCalibrationLoaded = true;
+  }
+  for(int i=0; i < MAX_PLANTS; i++) {
+    calibration.setPoints(i, rtcCalibration[i]);
+  }
+}
+
+void saveCalibration() {
+  Preferences preferences;
+  if (preferences.begin(CALIBRATION_NAMESPACE, false)) {
+    preferences.putBytes(CALIBRATION_KEY, rtcCalibration, sizeof(rtcCalibration));
+    preferences.end();
+  }
+}
+
+/**
+ * @brief Handle Mqtt commands to capture the calibration points (stay alive mode only)
+ * Format: "<plant>:dry", "<plant>:wet" or "<plant>:clear"
+ * ADC2 can not be read with WiFi, so the reading of this wake is captured:
+ * put the sensor into dry soil (or water), then wake the controller and keep it alive.
+ * With both points, moistdry<plant> is given in percent (0 dry, 100 wet).
+ *
+ * @param range multiple transmitted values (not used for this function)
+ * @param value single value
+ * @return true when the command was parsed and executed succuessfully
+ * @return false on errors when parsing the request
+ */
+bool calibrateHandler(const HomieRange& range, const String& value) {
+  if (range.isRange || !mode3Active) return false;
+  int separator = value.indexOf(':');
+  if (separator < 1) return false;
+  int plant = value.substring(0, separator).toInt();
+  String point = value.substring(separator + 1);
+  if ((plant < 0) || (plant >= MAX_PLANTS)) return false;
+
+  uint16_t raw = mPlants[plant].getSensorValue();
+  if (point.equals("dry")) {
+    rtcCalibration[plant].dry = raw;
+  } else if (point.equals("wet")) {
+    rtcCalibration[plant].wet = raw;
+  } else if (point.equals("clear")) {
+    calibrationClear(rtcCalibration[plant]);
+  } else {
+    return false;
+  }
+  saveCalibration();
+  calibration.setPoints(plant, rtcCalibration[plant]);
+  Serial << "cal " << plant << " " << rtcCalibration[plant].dry << " " << rtcCalibration[plant].wet << endl;
+  stayAlive.setProperty("calibrate").setRetained(false).send(value + "=" + String(raw) +
+                                                             (calibration.isCalibrated(plant) ? " calibrated" : ""));
+  return true;
+}
+
 /**
  * @brief Handle Mqtt commands to keep controller alive
  * 
@@ -417,9 +1148,11 @@ bool aliveHandler(const HomieRange& range, const String& value) {
   if (range.isRange) return false;  // only one controller is present
   if (value.equals("ON") || value.equals("On") || value.equals("1")) {
       mode3Active=true;
+      /* the WiFi is already connected */
+      historyServer.begin(&history);
   } else {
       mode3Active=false;
-      esp_deep_sleep_start();
+      enterDeepSleep();
   }
   Serial << (mode3Active ? "stayalive" : "") << endl;
   return true;
@@ -463,7 +1196,7 @@ bool switch3Handler(const HomieRange& range, const String& value) {
 }
 
 void homieLoop(){
-
+  chunkedOta.loop();
 }
 
 void systemInit(){
@@ -471,6 +1204,11 @@ void systemInit(){
 
   Homie_setFirmware("PlantControl", FIRMWARE_VERSION);
 
+  /* Intialize the settings of each plant, only needed by Homie */
+  for(int i=0; i < MAX_PLANTS; i++) {
+    mPlants[i].init();
+  }
+
   // Set default values
   deepSleepTime.setDefaultValue(300000);    /* 5 minutes in milliseconds */
   deepSleepNightTime.setDefaultValue(0);
@@ -479,12 +1217,50 @@ void systemInit(){
   waterLevelMin.setDefaultValue(50);      /* 5cm in mm */
   waterLevelWarn.setDefaultValue(500);    /* 50cm in mm */
   waterLevelVol.setDefaultValue(5000);    /* 5l in ml */
+  homieWakes.setDefaultValue(12);         /* Homie once an hour, with 5 minutes deepsleep */
+  homieWakes.setValidator([] (long candidate) {
+    return ((candidate >= 0) && (candidate <= 1000) );
+  });
+  pumpFlow.setDefaultValue(480);          /* 8 ml/s */
+  pumpFlow.setValidator([] (long candidate) {
+    return ((candidate > 0) && (candidate <= 10000) );
+  });
+  pumpCurrentBudget.setDefaultValue(800);  /* two pumps with the default estimation */
+  pumpCurrentBudget.setValidator([] (long candidate) {
+    return ((candidate >= 0) && (candidate <= 5000) );
+  });
+  awakeBudget.setDefaultValue("");
+  awakeBudget.setValidator([] (const char* candidate) {
+    uint16_t deadlines[BUDGET_PHASES];
+    return AwakeBudget::parse(candidate, deadlines);
+  });
+  telemetryDeadband.setDefaultValue("");
+  telemetryDeadband.setValidator([] (const char* candidate) {
+    uint16_t deadband[TELEMETRY_DEADBANDS];
+    return telemetryParseDeadbands(candidate, deadband);
+  });
+  telemetrySilence.setDefaultValue(TELEMETRY_SILENCE_DEFAULT);
+  telemetrySilence.setValidator([] (long candidate) {
+    return ((candidate >= 0) && (candidate <= 86400) );
+  });
+  timeZone.setDefaultValue("UTC0");
+  timeZone.setValidator([] (const char* candidate) {
+    return (strlen(candidate) > 0) && (strlen(candidate) < TIMEZONE_SIZE);
+  });
+  ntpServer.setDefaultValue("pool.ntp.org");
 
   Homie.setLoopFunction(homieLoop);
+  Homie.onEvent(onHomieEvent);
   Homie.setup();
+  memoryStats.sample();
 
   mConfigured = Homie.isConfigured();
   if (mConfigured) {
+    for(int i=0; i < MAX_PLANTS; i++) {
+      pumpControl.setMaxRuntime(i, mPlants[i].getSettingMaxRuntime());
+    }
+    pumpControl.setCurrentBudget(pumpCurrentBudget.get(), rtcPumpCurrent);
+
     // Advertise topics
     plant1.advertise("switch").setName("Pump 1")
                               .setDatatype("boolean")
@@ -544,66 +1320,94 @@ void systemInit(){
                 .setDatatype("number")
                 .setUnit("V");
     sensorWater.advertise("remaining").setDatatype("number").setUnit("%");
+    sensorWater.advertise("volume").setName("Estimated water").setDatatype("integer").setUnit("ml");
+    sensorWater.advertise("warning").setName("Below waterlevelwarn").setDatatype("boolean");
+    systemStats.advertise("latencyhomie").setName("Wake to publish (Homie)").setDatatype("integer").setUnit("ms");
+    systemStats.advertise("latencyfast").setName("Wake to publish (fast path)").setDatatype("integer").setUnit("ms");
   }
   stayAlive.advertise("alive").setName("Alive").setDatatype("number").settable(aliveHandler);
+  stayAlive.advertise("calibrate").setName("Capture moisture calibration").setDatatype("string").settable(calibrateHandler);
+
+  systemStats.advertise("minheap").setName("Minimum free heap").setDatatype("integer").setUnit("B");
+  systemStats.advertise("maxblock").setName("Largest free block").setDatatype("integer").setUnit("B");
+  systemStats.advertise("stackloop").setName("Unused stack loopTask").setDatatype("integer").setUnit("B");
+  systemStats.advertise("stackwifi").setName("Unused stack WiFi").setDatatype("integer").setUnit("B");
+  systemStats.advertise("stackmqtt").setName("Unused stack MQTT").setDatatype("integer").setUnit("B");
+  systemStats.advertise("rtcused").setName("Used RTC memory").setDatatype("integer").setUnit("B");
+  for(int i=0; i < SETTLE_CHANNELS; i++) {
+    systemStats.advertise(SETTLE_PROPERTIES[i]).setName("Sensor settle time").setDatatype("integer").setUnit("ms");
+  }
+  for(int i=0; i < BUDGET_PHASES; i++) {
+    systemStats.advertise(BUDGET_PROPERTIES[i]).setName("Deadline overruns").setDatatype("integer");
+  }
 }
 
 
 bool mode1(){
   Serial.println("m1");
   readSensors();
-  //queue sensor values for 
-
-  if ((rtcDeepSleepTime == 0) ||
-      (rtcMoistureTrigger0 == 0) ||
-      (rtcMoistureTrigger1 == 0) ||
-      (rtcMoistureTrigger2 == 0) ||
-      (rtcMoistureTrigger3 == 0) ||
-      (rtcMoistureTrigger4 == 0) ||
-      (rtcMoistureTrigger5 == 0) ||
-      (rtcMoistureTrigger6 == 0)
-    ) 
-  {
-      Serial.println("RTCm2");
-      return true;
-  }
- 
-  if ((rtcMoistureTrigger0 != DEACTIVATED_PLANT) && (mPlants[0].getSensorValue() < rtcMoistureTrigger0) ) {
-    Serial.println("mt0");
-    return true;
-  }
-  if ((rtcMoistureTrigger1 != DEACTIVATED_PLANT) && (mPlants[1].getSensorValue() < rtcMoistureTrigger1) ) {
-    Serial.println("mt1");
-    return true;
-  }
-  if ((rtcMoistureTrigger2 != DEACTIVATED_PLANT) && (mPlants[2].getSensorValue() < rtcMoistureTrigger2) ) {
-    Serial.println("mt2");
-    return true;
-  }
-  if ((rtcMoistureTrigger3 != DEACTIVATED_PLANT) && (mPlants[3].getSensorValue() < rtcMoistureTrigger3) ) {
-    Serial.println("mt3");
-    return true;
+
+  int moisture[MAX_PLANTS];
+  for(int i=0; i < MAX_PLANTS; i++) {
+    moisture[i] = controlValue(i, mPlants[i].getSensorValue());
   }
-  if ((rtcMoistureTrigger4 != DEACTIVATED_PLANT) && (mPlants[4].getSensorValue() < rtcMoistureTrigger4) ) {
-    Serial.println("mt4");
+  traceWake(moisture);
+  return controlIsMode2Required(rtcControl, moisture, getCurrentTime());
+}
+
+/**
+ * @brief Check, if the fast path has something to publish
+ * The moisture is known from mode1; only if it did not change, the other sensors are awaited.
+ * @return true, if a value left its deadband or must be repeated
+ */
+bool isTelemetryDue() {
+  if (stats.isSummaryPending()) {
     return true;
   }
-  if ((rtcMoistureTrigger5 != DEACTIVATED_PLANT) && (mPlants[5].getSensorValue() < rtcMoistureTrigger5) ) {
-    Serial.println("mt5");
-    return true;
+  telemetry.startProbe();
+  for(int i=0; i < MAX_PLANTS; i++) {
+    SensorSample_t sample = { 0, SAMPLE_MOISTURE, (uint8_t) i, (float) mPlants[i].getSensorValue() };
+    publishSample(sample);
   }
-  if ((rtcMoistureTrigger6 != DEACTIVATED_PLANT) && (mPlants[6].getSensorValue() < rtcMoistureTrigger6) ) {
-    Serial.println("mt6");
-    return true;
+  if (!telemetry.isProbeDue()) {
+    waitForSensors();
+    updateControlValues();
+    for (int i=0; i < 2; i++) {
+      SensorSample_t sample = { 0, SAMPLE_TEMPERATURE, (uint8_t) i, mTemperature[i] };
+      publishSample(sample);
+    }
+    /* stages, that did not finish, have no value to compare */
+    if (mWaterGone >= 0) {
+      SensorSample_t sample = { 0, SAMPLE_WATER, 0, (float) mWaterGone };
+      publishSample(sample);
+    }
+    if (lipoSenor >= 0) {
+      SensorSample_t sample = { 0, SAMPLE_LIPO, 0, (float) lipoSenor };
+      publishSample(sample);
+    }
+    if (solarSensor >= 0) {
+      SensorSample_t sample = { 0, SAMPLE_SOLAR, 0, (float) solarSensor };
+      publishSample(sample);
+    }
   }
-  //check how long it was already in mode1 if to long goto mode2
+  telemetry.stopProbe();
+  return telemetry.isProbeDue();
+}
 
-  //TODO evaluate if something is to do
-  return false;
+/**
+ * @brief Values, published without Homie
+ */
+void publishFastPathValues(){
+  publishSensorValues();
+  updateControlValues();
+  tracePublish();
+  publishMemoryStats();
+  publishBudgetStats();
 }
 
 void mode2(){
   Serial.println("m2");
+  budget.enter(BUDGET_WIFI, millis());
   systemInit();
 
   /* Jump into Mode 3, if not configured */
@@ -613,6 +1417,63 @@ void mode2(){
   }
 }
 
+/**
+ * @brief Select the path of this wake by its cause
+ * A timer wake only does, what mode1 decides; the button and a reset (or power on) always start Homie.
+ */
+WakeRoute_t routeWake() {
+  switch (esp_sleep_get_wakeup_cause()) {
+    case ESP_SLEEP_WAKEUP_TIMER:
+      return WAKE_ROUTE_TIMER;
+    case ESP_SLEEP_WAKEUP_EXT0:
+    case ESP_SLEEP_WAKEUP_EXT1:
+      Serial.println("wb");
+      return WAKE_ROUTE_BUTTON;
+    default:
+      Serial.println("wc");
+      return WAKE_ROUTE_COLD;
+  }
+}
+
+/**
+ * @brief Enforce the deadline of the current phase
+ * WiFi and MQTT give up, a running pump is finished (or stopped at its deadline)
+ * and the publishing is cut by isPublishAllowed().
+ */
+void checkBudget() {
+  unsigned long now = millis();
+  switch (budget.getPhase()) {
+    case BUDGET_WIFI:
+    case BUDGET_MQTT:
+      if (budget.isOverrun(now)) {
+        Serial << budget.getName(budget.getPhase()) << " overrun" << endl;
+        enterDeepSleep();
+      }
+      break;
+    case BUDGET_WATER:
+      if (!pumpControl.isActive()) {
+        budget.enter(BUDGET_DONE, now);
+      } else if (budget.isOverrun(now)) {
+        pumpControl.stopAll();
+        budget.enter(BUDGET_DONE, now);
+      }
+      /* the pump keeps the controller awake */
+      return;
+    case BUDGET_DONE:
+      if (now >= (MIN_TIME_RUNNING * MS_TO_S)) {
+        enterDeepSleep();
+      }
+      break;
+    default:
+      break;
+  }
+
+  if (now > AWAKE_WATCHDOG) {
+    Serial << (now / 1000) << " ds watchdog" << endl;
+    enterDeepSleep();
+  }
+}
+
 /**
  * @brief Startup function
  * Is called once, the controller is started
@@ -621,27 +1482,45 @@ void setup() {
   Serial.begin(115200);
   Serial.setTimeout(1000); // Set timeout of 1 second
   Serial << endl << endl;
-  /* Intialize Plant */
-  for(int i=0; i < MAX_PLANTS; i++) {
-    mPlants[i].init();
+  gBootCount++;
+  budget.begin(rtcBudgetDeadline, rtcOverruns);
+  budget.enter(BUDGET_SENSE, 0);
+  tank.begin(&rtcTank);
+  history.begin(&rtcHistory);
+  telemetry.setMemory(&rtcTelemetry, getCurrentTime());
+  if (rtcTimeZone[0] != '\0') {
+    setenv("TZ", rtcTimeZone, 1);
+    tzset();
+  }
+  stats.begin(&rtcStats);
+  if (stats.rollover(getLocalDay())) {
+    Serial << "new day" << endl;
   }
+#ifdef TELEMETRY_BENCHMARK
+  telemetryBenchmark();
+#endif
+  loadCalibration();
 
   /* Intialize inputs and outputs */
   pinMode(SENSOR_LIPO, ANALOG);
   pinMode(SENSOR_SOLAR, ANALOG);
+  int pumpPins[MAX_PLANTS];
   for(int i=0; i < MAX_PLANTS; i++) {
-    pinMode(mPlants[i].getPumpPin(), OUTPUT);
+    pumpPins[i] = mPlants[i].getPumpPin();
     pinMode(mPlants[i].getSensorPin(), ANALOG);
-    digitalWrite(mPlants[i].getPumpPin(), LOW);
   }
-  /* read button */
+  /* all pumps are switched only by the pump task */
+  pumpControl.begin(pumpPins, MAX_PLANTS, OUTPUT_PUMP, SENSOR_LIPO);
+  pumpControl.setCurrentBudget(0, rtcPumpCurrent);
+  /* the button wakes the controller, @see routeWake() */
   pinMode(BUTTON, INPUT);
- 
+
   /* Disable Wifi and bluetooth */
   WiFi.mode(WIFI_OFF);
 
-  if (HomieInternals::MAX_CONFIG_SETTING_SIZE < MAX_CONFIG_SETTING_ITEMS) {
-    //increase the config settings to 50 and the json to 3000
+  if ((HomieInternals::MAX_CONFIG_SETTING_SIZE < MAX_CONFIG_SETTING_ITEMS)
+      || (HomieInternals::MAX_JSON_CONFIG_FILE_SIZE < MAX_CONFIG_FILE_SIZE)) {
+    //increase MAX_CONFIG_SETTING_SIZE to 64 and MAX_JSON_CONFIG_FILE_SIZE to 3000 in Limits.hpp of Homie
     Serial << "Limits.hpp" << endl;
   }
 
@@ -649,37 +1528,51 @@ void setup() {
   esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_SLOW_MEM, ESP_PD_OPTION_ON);
   esp_sleep_pd_config(ESP_PD_DOMAIN_RTC_FAST_MEM, ESP_PD_OPTION_OFF);
   esp_sleep_pd_config(ESP_PD_DOMAIN_XTAL,ESP_PD_OPTION_ON);
+  /* ext1 works with powered down RTC peripherals (ext0 would need them), the button is low active */
+  esp_sleep_enable_ext1_wakeup(1ULL << BUTTON, ESP_EXT1_WAKEUP_ALL_LOW);
 
-  // Big TODO use here the settings in RTC_Memory
+  /* the timer wake is configured by enterDeepSleep() with the copies of the settings in the RTC memory */
 
-  // Configure Deep Sleep:
-  if (mConfigured && (deepSleepNightTime.get() > 0) &&
-      ( SOLAR_VOLT(solarSensor) < MINIMUM_SOLAR_VOLT)) {
-    Serial << deepSleepNightTime.get() << "ms ds " << SOLAR_VOLT(solarSensor) << "V"  << endl;
-    uint64_t usSleepTime = deepSleepNightTime.get() * 1000U;
-    esp_sleep_enable_timer_wakeup(usSleepTime);
-  }else if (mConfigured && deepSleepTime.get()) {
-    Serial << deepSleepTime.get() << " ms ds" << endl;
-    uint64_t usSleepTime = deepSleepTime.get() * 1000U;
-    esp_sleep_enable_timer_wakeup(usSleepTime);
-  }
-
-  if (mConfigured && 
-    (ADC_5V_TO_3V3(lipoSenor) < MINIMUM_LIPO_VOLT) && 
-    (ADC_5V_TO_3V3(lipoSenor) > NO_LIPO_VOLT) &&
-    (deepSleepTime.get()) ) {
-    long sleepEmptyLipo = (deepSleepTime.get() * EMPTY_LIPO_MULTIPL);
-    Serial << sleepEmptyLipo << " ms lipo " << ADC_5V_TO_3V3(lipoSenor) << "V" << endl;
-    esp_sleep_enable_timer_wakeup(sleepEmptyLipo * 1000U);
-    mDeepSleep = true;
-  }
-
-  if(mode1()){
+  WakeRoute_t route = routeWake();
+  if (route == WAKE_ROUTE_BUTTON) {
+    /* the moisture of this wake is used for the calibration, ADC2 is not available later */
+    mHistoryWake = HISTORY_WAKE_BUTTON;
+    readSensors();
+    startAcquisition();
+    Serial.println("m3");
+    mode3Active = true;
     mode2();
+  } else if (route == WAKE_ROUTE_COLD) {
+    /* the settings are only available with Homie */
+    mHistoryWake = HISTORY_WAKE_COLD;
+    readSensors();
+    startAcquisition();
+    mode2();
+  } else if(mode1() || mqttFastPath.isFullSetupDue()){
+    mHistoryWake = HISTORY_WAKE_HOMIE;
+    startAcquisition();
+    mode2();
+  } else if (mqttFastPath.isEnabled()) {
+    startAcquisition();
+    if (!isTelemetryDue()) {
+      /* every value is within its deadband: the radio stays off */
+      Serial.println("nop");
+      traceStage();
+      enterDeepSleep();
+    }
+    mHistoryWake = HISTORY_WAKE_FASTPATH;
+    /* only publish the measured values, Homie is started every n-th wake */
+    Serial.println("fp");
+    mFastPathActive = true;
+    if (!mqttFastPath.run(&telemetry, publishFastPathValues, &budget)) {
+      Serial.println("fp failed");
+    }
+    enterDeepSleep();
   } else {
     Serial.println("nop");
-    Serial.flush();
-    esp_deep_sleep_start();
+    digitalWrite(OUTPUT_SENSOR, LOW);
+    traceStage();
+    enterDeepSleep();
   }
 }
 
@@ -690,10 +1583,10 @@ void setup() {
 
 void loop() {
   Homie.loop();
+  publishSwitchStates();
 
-  if(millis() > 30000 && !mode3Active){
-    Serial << (millis()/ 1000) << " ds watchdog" << endl;
-    Serial.flush();
-    esp_deep_sleep_start();
+  if (mode3Active || chunkedOta.isActive() || isHomieOtaActive()) {
+    return;
   }
+  checkBudget();
 }
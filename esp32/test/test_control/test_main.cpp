@@ -0,0 +1,266 @@
+/**
+ * @file test_main.cpp
+ * @author your name (you@domain.com)
+ * @brief Unit tests of the watering state machine and the mode1 wake decision
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Run on the host: pio test -e native -f test_control
+ */
+
+#include <string.h>
+#include <unity.h>
+#include "ControlLogic.h"
+
+#define DRY         2000    /**< moistdry of the tested plant */
+#define WET         3000
+#define RUNTIME     30      /**< s */
+#define SOAK        60      /**< s */
+#define COOLDOWN    20      /**< min */
+#define START       100000  /**< s */
+
+static ControlState_t state;
+static PlantControl_t plants[MAX_PLANTS];
+static int moisture[MAX_PLANTS];
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+    for (int i = 0; i < MAX_PLANTS; i++) {
+        plants[i].sensorDry = DEACTIVATED_PLANT;
+        plants[i].sensorExit = controlExitThreshold(DEACTIVATED_PLANT);
+        plants[i].cooldown = COOLDOWN;
+        plants[i].runtime = RUNTIME;
+        plants[i].soakTime = SOAK;
+        plants[i].onlyWhenLowLight = false;
+        moisture[i] = WET;
+    }
+    plants[0].sensorDry = DRY;
+    plants[0].sensorExit = controlExitThreshold(DRY);
+}
+
+void tearDown(void) {
+}
+
+static uint32_t selectPumps(long now, int limit = 1) {
+    /* mode2 copies the deep sleep setting, before the pumps are selected */
+    state.deepSleepTime = 300000;
+    return controlSelectPumps(state, plants, moisture, 0, now, limit);
+}
+
+static void test_exit_threshold(void) {
+    TEST_ASSERT_EQUAL(2200, controlExitThreshold(2000));
+    TEST_ASSERT_EQUAL(0, controlExitThreshold(0));
+    TEST_ASSERT_EQUAL(DEACTIVATED_PLANT, controlExitThreshold(DEACTIVATED_PLANT));
+    /* limited to the highest reading */
+    TEST_ASSERT_EQUAL(4094, controlExitThreshold(3722));
+    TEST_ASSERT_EQUAL(CONTROL_ADC_MAX, controlExitThreshold(3723));
+    TEST_ASSERT_EQUAL(CONTROL_ADC_MAX, controlExitThreshold(4000));
+}
+
+static void test_high_trigger_cools_down(void) {
+    plants[0].sensorDry = 4000;
+    plants[0].sensorExit = controlExitThreshold(4000);
+    moisture[0] = 3999;
+    TEST_ASSERT_EQUAL(1, selectPumps(START));
+    /* the wettest reading ends the cycle after the first burst */
+    moisture[0] = CONTROL_ADC_MAX;
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START + RUNTIME + SOAK));
+    TEST_ASSERT_EQUAL(0, selectPumps(START + RUNTIME + SOAK));
+    TEST_ASSERT_EQUAL(PLANT_COOLDOWN, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(1, state.plants[0].bursts);
+}
+
+static void test_idle_stays_idle_when_wet(void) {
+    TEST_ASSERT_EQUAL(0, selectPumps(START));
+    TEST_ASSERT_EQUAL(PLANT_IDLE, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(DRY, state.plants[0].trigger);
+}
+
+static void test_dry_starts_watering(void) {
+    moisture[0] = DRY - 1;
+    TEST_ASSERT_EQUAL(1, selectPumps(START));
+    TEST_ASSERT_EQUAL(PLANT_WATERING, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(1, state.plants[0].bursts);
+    TEST_ASSERT_EQUAL(START, state.plants[0].lastActivation);
+    TEST_ASSERT_EQUAL(START + RUNTIME + SOAK, state.plants[0].timer);
+}
+
+static void test_watering_to_soaking(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    /* the water did not reach the sensor yet */
+    TEST_ASSERT_EQUAL(0, selectPumps(START + RUNTIME));
+    TEST_ASSERT_EQUAL(PLANT_SOAKING, state.plants[0].phase);
+}
+
+static void test_soaked_below_exit_waters_again(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = controlExitThreshold(DRY) - 1;
+    TEST_ASSERT_EQUAL(1, selectPumps(START + RUNTIME + SOAK));
+    TEST_ASSERT_EQUAL(PLANT_WATERING, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(2, state.plants[0].bursts);
+}
+
+static void test_soaked_above_exit_cools_down(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = controlExitThreshold(DRY);
+    TEST_ASSERT_EQUAL(0, selectPumps(START + RUNTIME + SOAK));
+    TEST_ASSERT_EQUAL(PLANT_COOLDOWN, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(START + COOLDOWN * 60, state.plants[0].timer);
+}
+
+static void test_cooldown_blocks_until_over(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = WET;
+    selectPumps(START + RUNTIME + SOAK);
+    moisture[0] = DRY - 1;
+    TEST_ASSERT_EQUAL(0, selectPumps(START + COOLDOWN * 60 - 1));
+    TEST_ASSERT_EQUAL(PLANT_COOLDOWN, state.plants[0].phase);
+    /* a new cycle starts with the first burst */
+    TEST_ASSERT_EQUAL(1, selectPumps(START + COOLDOWN * 60));
+    TEST_ASSERT_EQUAL(PLANT_WATERING, state.plants[0].phase);
+    TEST_ASSERT_EQUAL(1, state.plants[0].bursts);
+}
+
+static void test_cooldown_over_wet_is_idle(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = WET;
+    selectPumps(START + RUNTIME + SOAK);
+    TEST_ASSERT_EQUAL(0, selectPumps(START + COOLDOWN * 60));
+    TEST_ASSERT_EQUAL(PLANT_IDLE, state.plants[0].phase);
+}
+
+static void test_bursts_cap(void) {
+    /* a broken sensor stays dry */
+    moisture[0] = 0;
+    long now = START;
+    for (int burst = 1; burst <= CONTROL_MAX_BURSTS; burst++) {
+        TEST_ASSERT_EQUAL(1, selectPumps(now));
+        TEST_ASSERT_EQUAL(burst, state.plants[0].bursts);
+        now += RUNTIME + SOAK;
+    }
+    TEST_ASSERT_EQUAL(0, selectPumps(now));
+    TEST_ASSERT_EQUAL(PLANT_COOLDOWN, state.plants[0].phase);
+}
+
+static void test_wet_again_without_watering(void) {
+    plants[1] = plants[0];
+    moisture[0] = DRY - 1;
+    moisture[1] = DRY - 1;
+    /* only one pump per wake: plant 1 waits */
+    TEST_ASSERT_EQUAL(1, selectPumps(START));
+    TEST_ASSERT_EQUAL(PLANT_NEEDS_WATER, state.plants[1].phase);
+    TEST_ASSERT_EQUAL(0, state.plants[1].bursts);
+    moisture[1] = controlExitThreshold(DRY);
+    selectPumps(START + 1);
+    TEST_ASSERT_EQUAL(PLANT_IDLE, state.plants[1].phase);
+}
+
+static void test_pump_limit(void) {
+    TEST_ASSERT_EQUAL(1, controlPumpLimit(0));
+    TEST_ASSERT_EQUAL(MAX_PLANTS, controlPumpLimit(800));
+    plants[1] = plants[0];
+    plants[2] = plants[0];
+    moisture[0] = DRY - 1;
+    moisture[1] = DRY - 1;
+    moisture[2] = DRY - 1;
+    TEST_ASSERT_EQUAL(0x3, selectPumps(START, 2));
+    TEST_ASSERT_EQUAL(PLANT_NEEDS_WATER, state.plants[2].phase);
+    TEST_ASSERT_EQUAL(0x4, selectPumps(START + 1, 2));
+}
+
+static void test_deactivated_plant_never_waters(void) {
+    moisture[1] = 0;
+    TEST_ASSERT_EQUAL(0, selectPumps(START));
+    TEST_ASSERT_EQUAL(PLANT_IDLE, state.plants[1].phase);
+}
+
+static void test_wake_uninitialized(void) {
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, START));
+    state.deepSleepTime = 300000;
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, START));
+    selectPumps(START);
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START));
+}
+
+static void test_wake_trigger_zero(void) {
+    /* moistdry 0 is a valid threshold and must not look uninitialized */
+    plants[0].sensorDry = 0;
+    plants[0].sensorExit = controlExitThreshold(0);
+    moisture[0] = 100;
+    selectPumps(START);
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START + 1));
+}
+
+static void test_wake_idle(void) {
+    selectPumps(START);
+    moisture[0] = DRY;
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START + 1));
+    moisture[0] = DRY - 1;
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, START + 1));
+    /* deactivated plants never wake */
+    moisture[0] = WET;
+    moisture[1] = 0;
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START + 1));
+}
+
+static void test_wake_needs_water(void) {
+    plants[1] = plants[0];
+    moisture[0] = DRY - 1;
+    moisture[1] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = WET;
+    moisture[1] = WET;
+    /* plant 1 still waits for its pump */
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, START + 1));
+}
+
+static void test_wake_soaking(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    long soaked = START + RUNTIME + SOAK;
+    /* the moisture is not used during the soak time */
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, soaked - 1));
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, soaked));
+    moisture[0] = controlExitThreshold(DRY);
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, soaked));
+}
+
+static void test_wake_cooldown(void) {
+    moisture[0] = DRY - 1;
+    selectPumps(START);
+    moisture[0] = WET;
+    selectPumps(START + RUNTIME + SOAK);
+    moisture[0] = DRY - 1;
+    TEST_ASSERT_FALSE(controlIsMode2Required(state, moisture, START + COOLDOWN * 60 - 1));
+    TEST_ASSERT_TRUE(controlIsMode2Required(state, moisture, START + COOLDOWN * 60));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_exit_threshold);
+    RUN_TEST(test_idle_stays_idle_when_wet);
+    RUN_TEST(test_dry_starts_watering);
+    RUN_TEST(test_watering_to_soaking);
+    RUN_TEST(test_soaked_below_exit_waters_again);
+    RUN_TEST(test_soaked_above_exit_cools_down);
+    RUN_TEST(test_cooldown_blocks_until_over);
+    RUN_TEST(test_cooldown_over_wet_is_idle);
+    RUN_TEST(test_bursts_cap);
+    RUN_TEST(test_high_trigger_cools_down);
+    RUN_TEST(test_wet_again_without_watering);
+    RUN_TEST(test_pump_limit);
+    RUN_TEST(test_deactivated_plant_never_waters);
+    RUN_TEST(test_wake_uninitialized);
+    RUN_TEST(test_wake_trigger_zero);
+    RUN_TEST(test_wake_idle);
+    RUN_TEST(test_wake_needs_water);
+    RUN_TEST(test_wake_soaking);
+    RUN_TEST(test_wake_cooldown);
+    return UNITY_END();
+}
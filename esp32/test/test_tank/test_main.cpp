@@ -0,0 +1,170 @@
+/**
+ * @file test_main.cpp
+ * @author your name (you@domain.com)
+ * @brief Unit tests of the fixed-point Kalman filter of the tank level
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ * Run on the host: pio test -e native -f test_tank
+ */
+
+#include <math.h>
+#include <string.h>
+#include <unity.h>
+#include "TankEstimator.h"
+
+#define LEVEL_FULL      200     /**< mm, distance at the maximum water level */
+#define LEVEL_EMPTY     800     /**< mm, distance at the minimum water level */
+#define VOLUME          6000    /**< ml between both levels, 0.1 mm per ml */
+#define Q8              (1L << TANK_FRACTION_BITS)
+
+static TankState_t state;
+static TankEstimator tank;
+static uint32_t noiseSeed;
+
+void setUp(void) {
+    memset(&state, 0, sizeof(state));
+    tank.begin(&state);
+    noiseSeed = 12345;
+}
+
+void tearDown(void) {
+}
+
+/**
+ * @brief Reproducible ping noise, roughly +-15 mm
+ */
+static long noise(void) {
+    noiseSeed = noiseSeed * 1103515245UL + 12345UL;
+    return (long) ((noiseSeed >> 16) % 31) - 15;
+}
+
+static void settle(long level, int pings) {
+    for (int i = 0; i < pings; i++) {
+        tank.update(level + noise());
+    }
+}
+
+static void test_first_ping_starts(void) {
+    TEST_ASSERT_FALSE(tank.isValid());
+    /* no echo: nothing known yet */
+    TEST_ASSERT_FALSE(tank.update(0));
+    TEST_ASSERT_FALSE(tank.isValid());
+    TEST_ASSERT_TRUE(tank.update(500));
+    TEST_ASSERT_TRUE(tank.isValid());
+    TEST_ASSERT_EQUAL(500, tank.getLevel());
+    TEST_ASSERT_EQUAL(10, tank.getDeviation());
+}
+
+static void test_noisy_pings_converge(void) {
+    settle(600, 50);
+    TEST_ASSERT_INT_WITHIN(5, 600, tank.getLevel());
+    TEST_ASSERT_LESS_THAN(10, tank.getDeviation());
+    TEST_ASSERT_GREATER_THAN(0, tank.getDeviation());
+    TEST_ASSERT_EQUAL(0, state.rejected);
+}
+
+static void test_pump_prediction(void) {
+    settle(300, 30);
+    long level = tank.getLevel();
+    long deviation = tank.getDeviation();
+    /* 600 ml lower the level by 60 mm, the distance grows */
+    tank.addPumped(600, LEVEL_EMPTY, LEVEL_FULL, VOLUME);
+    TEST_ASSERT_EQUAL(60 * Q8, state.pending);
+    TEST_ASSERT_FALSE(tank.update(0));
+    TEST_ASSERT_EQUAL(level + 60, tank.getLevel());
+    TEST_ASSERT_EQUAL(0, state.pending);
+    TEST_ASSERT_GREATER_THAN(deviation, tank.getDeviation());
+    /* the predicted level is within the gate */
+    TEST_ASSERT_TRUE(tank.update(level + 62));
+}
+
+static void test_gate_rejects_outlier(void) {
+    settle(600, 30);
+    long level = tank.getLevel();
+    /* echo of the wall */
+    TEST_ASSERT_FALSE(tank.update(400));
+    TEST_ASSERT_EQUAL(1, state.rejected);
+    TEST_ASSERT_EQUAL(level, tank.getLevel());
+    TEST_ASSERT_TRUE(tank.update(601));
+    TEST_ASSERT_EQUAL(0, state.rejected);
+}
+
+static void test_refill_restarts(void) {
+    settle(700, 30);
+    for (int i = 1; i < TANK_MAX_REJECTED; i++) {
+        TEST_ASSERT_FALSE(tank.update(250));
+        TEST_ASSERT_INT_WITHIN(10, 700, tank.getLevel());
+    }
+    TEST_ASSERT_TRUE(tank.update(250));
+    TEST_ASSERT_EQUAL(250, tank.getLevel());
+    TEST_ASSERT_EQUAL(TANK_MEASUREMENT_VARIANCE * Q8, state.variance);
+    TEST_ASSERT_EQUAL(0, state.rejected);
+    TEST_ASSERT_TRUE(tank.update(252));
+}
+
+static void test_overflow_margins(void) {
+    TEST_ASSERT_TRUE(tank.update(4000));
+    /* an implausible pump run: the variance is limited, nothing wraps around */
+    tank.addPumped(100000, 1000, 0, 1000);
+    TEST_ASSERT_EQUAL(100000 * Q8, state.pending);
+    tank.update(0);
+    TEST_ASSERT_EQUAL(104000, tank.getLevel());
+    TEST_ASSERT_EQUAL((uint32_t) TANK_MAX_VARIANCE * Q8, state.variance);
+    TEST_ASSERT_EQUAL(1000, tank.getDeviation());
+    /* 100 m away is outside of the gate even now, the pings restart the filter */
+    for (int i = 1; i < TANK_MAX_REJECTED; i++) {
+        TEST_ASSERT_FALSE(tank.update(4000));
+    }
+    TEST_ASSERT_TRUE(tank.update(4000));
+    TEST_ASSERT_EQUAL(4000, tank.getLevel());
+
+    /* with the largest variance a ping within the gate is taken almost as it is */
+    state.variance = (uint32_t) TANK_MAX_VARIANCE * Q8;
+    TEST_ASSERT_TRUE(tank.update(1500));
+    TEST_ASSERT_INT_WITHIN(1, 1500, tank.getLevel());
+    TEST_ASSERT_LESS_OR_EQUAL(10, tank.getDeviation());
+    /* without pings the variance grows until the limit, but not beyond */
+    for (int i = 0; i < 300000; i++) {
+        tank.update(0);
+    }
+    TEST_ASSERT_EQUAL((uint32_t) TANK_MAX_VARIANCE * Q8, state.variance);
+}
+
+static void test_deviation_square_root(void) {
+    const uint32_t variances[] = { 0, 1, 2, 3, 4, 15, 16, 17, 99, 100, 101, 4095, 65536, 999999, TANK_MAX_VARIANCE };
+    state.valid = 1;
+    for (unsigned int i = 0; i < sizeof(variances) / sizeof(variances[0]); i++) {
+        state.variance = variances[i] * Q8;
+        TEST_ASSERT_EQUAL((long) floor(sqrt((double) variances[i])), tank.getDeviation());
+    }
+    /* the fraction is cut off */
+    state.variance = 4 * Q8 - 1;
+    TEST_ASSERT_EQUAL(1, tank.getDeviation());
+}
+
+static void test_fill(void) {
+    TEST_ASSERT_EQUAL(0, TankEstimator::getFill(LEVEL_EMPTY, LEVEL_EMPTY, LEVEL_FULL));
+    TEST_ASSERT_EQUAL(TANK_FILL_SCALE, TankEstimator::getFill(LEVEL_FULL, LEVEL_EMPTY, LEVEL_FULL));
+    TEST_ASSERT_EQUAL(500, TankEstimator::getFill(500, LEVEL_EMPTY, LEVEL_FULL));
+    /* both orientations of the levels */
+    TEST_ASSERT_EQUAL(250, TankEstimator::getFill(350, 200, 800));
+    /* clamped outside of the levels */
+    TEST_ASSERT_EQUAL(0, TankEstimator::getFill(900, LEVEL_EMPTY, LEVEL_FULL));
+    TEST_ASSERT_EQUAL(TANK_FILL_SCALE, TankEstimator::getFill(100, LEVEL_EMPTY, LEVEL_FULL));
+    TEST_ASSERT_EQUAL(0, TankEstimator::getFill(100, 500, 500));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_first_ping_starts);
+    RUN_TEST(test_noisy_pings_converge);
+    RUN_TEST(test_pump_prediction);
+    RUN_TEST(test_gate_rejects_outlier);
+    RUN_TEST(test_refill_restarts);
+    RUN_TEST(test_overflow_margins);
+    RUN_TEST(test_deviation_square_root);
+    RUN_TEST(test_fill);
+    return UNITY_END();
+}